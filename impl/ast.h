@@ -19,23 +19,35 @@
 #pragma once
 
 #include "simple/ast.h"
+#include "impl/node_pool.h"
 
 namespace simple {
 namespace impl {
 
 using namespace simple;
 
-class SimpleProcAst : public ProcAst {
+class SimpleProcAst : public ProcAst, public PooledNode {
   public:
-    SimpleProcAst(std::string name) : _name(name) { }
+    SimpleProcAst(std::string name) : _name(SymbolTable::intern(name)) { }
 
     void set_first_statement(StatementAst* statement) {
         if(_statement) { throw InconsistentAstError(); }
         _statement.reset(statement);
     }
 
+    /*
+     * Detaches the body so that the procedure can be parsed again.
+     */
+    StatementAst* release_statement() {
+        return _statement.release();
+    }
+
     virtual std::string get_name() {
-        return _name;
+        return _name->get_name();
+    }
+
+    virtual int get_symbol() {
+        return _name->get_id();
     }
 
     virtual StatementAst* get_statement() {
@@ -43,7 +55,7 @@ class SimpleProcAst : public ProcAst {
     }
 
   private:
-    std::string _name;
+    const Symbol *_name;
 
     // ProcAst owns the first statement ast.
     std::unique_ptr<StatementAst> _statement;
@@ -66,7 +78,9 @@ class SimpleStatementAst {
  * Abstract Class
  */
 template <typename ParentType>
-class SimpleStatementBase : public ParentType, public SimpleStatementAst {
+class SimpleStatementBase : public ParentType, public SimpleStatementAst, 
+    public PooledNode 
+{
   public:
     SimpleStatementBase() :
         _line(0), _proc(0), _container(0),
@@ -289,7 +303,7 @@ class SimpleAssignmentAst : public SimpleStatementBase<AssignmentAst> {
     std::unique_ptr<ExprAst>  _expr;
 };
 
-class SimpleVariableAst : public VariableAst {
+class SimpleVariableAst : public VariableAst, public PooledNode {
   public:
     SimpleVariableAst() : _var() { }
     SimpleVariableAst(const SimpleVariable& var) : _var(var) { }
@@ -317,7 +331,7 @@ class SimpleVariableAst : public VariableAst {
     SimpleVariable  _var;
 };
 
-class SimpleConstAst : public ConstAst {
+class SimpleConstAst : public ConstAst, public PooledNode {
   public:
     SimpleConstAst() : _value(0) { }
     SimpleConstAst(int value) : _value(value) { }
@@ -344,7 +358,7 @@ class SimpleConstAst : public ConstAst {
     SimpleConstant  _value;
 };
 
-class SimpleBinaryOpAst : public BinaryOpAst {
+class SimpleBinaryOpAst : public BinaryOpAst, public PooledNode {
   public:
     SimpleBinaryOpAst() : 
         _lhs(), _rhs(), _op(' ')
@@ -0,0 +1,166 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "impl/attribute_index.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+namespace {
+
+class CalleeVisitor : public StatementVisitor {
+  public:
+    CalleeVisitor() : _callee(NULL) { }
+
+    void visit_assignment(AssignmentAst*) { }
+    void visit_conditional(ConditionalAst*) { }
+    void visit_while(WhileAst*) { }
+
+    void visit_call(CallAst *call) {
+        _callee = call->get_proc_called();
+    }
+
+    ProcAst* get_callee() {
+        return _callee;
+    }
+
+  private:
+    ProcAst *_callee;
+};
+
+} // anonymous namespace
+
+AttributeIndex::AttributeIndex(ConditionTablePtr table) :
+    _current(std::shared_ptr<SimpleCondition>())
+{
+    int size = table->get_size();
+
+    // conditions are visited in ID order, so every set is built in order
+    for(int id = 0; id < size; ++id) {
+        _current = table->get_condition(id);
+        _current.get()->accept_condition_visitor(this);
+    }
+}
+
+bool AttributeIndex::is_name(Attribute attr) {
+    return attr == ATTR_PROC_NAME || attr == ATTR_CALL_NAME || 
+        attr == ATTR_VAR_NAME;
+}
+
+bool AttributeIndex::get_key(Attribute attr, StatementAst *statement, int& key) const {
+    if(attr == ATTR_STMT_NUMBER) {
+        key = statement->get_line();
+        return true;
+    } else if(attr == ATTR_CALL_NAME) {
+        std::unordered_map<StatementAst*, int>::const_iterator it = 
+            _callees.find(statement);
+
+        if(it != _callees.end()) {
+            key = it->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AttributeIndex::get_key(Attribute attr, ProcAst *proc, int& key) const {
+    if(attr == ATTR_PROC_NAME) {
+        key = proc->get_symbol();
+        return true;
+    }
+    return false;
+}
+
+bool AttributeIndex::get_key(Attribute attr, SimpleVariable *var, int& key) const {
+    if(attr == ATTR_VAR_NAME) {
+        key = var->get_symbol();
+        return true;
+    }
+    return false;
+}
+
+bool AttributeIndex::get_key(Attribute attr, SimpleConstant *constant, int& key) const {
+    if(attr == ATTR_VALUE) {
+        key = constant->get_int();
+        return true;
+    }
+    return false;
+}
+
+const ConditionSet& AttributeIndex::find(Attribute attr, int key) const {
+    KeyTable::const_iterator it = _tables[attr].find(key);
+
+    if(it != _tables[attr].end()) {
+        return it->second;
+    } else {
+        return _empty;
+    }
+}
+
+size_t AttributeIndex::count_pairs(Attribute attr1, Attribute attr2) const {
+    const KeyTable *smaller = &_tables[attr1];
+    const KeyTable *larger = &_tables[attr2];
+    if(smaller->size() > larger->size()) {
+        std::swap(smaller, larger);
+    }
+
+    size_t pairs = 0;
+    for(KeyTable::const_iterator it = smaller->begin(); it != smaller->end(); ++it) {
+        KeyTable::const_iterator match = larger->find(it->first);
+
+        if(match != larger->end()) {
+            pairs += it->second.get_size() * match->second.get_size();
+        }
+    }
+    return pairs;
+}
+
+void AttributeIndex::visit_statement_condition(StatementCondition *condition) {
+    StatementAst *statement = condition->get_statement_ast();
+    _tables[ATTR_STMT_NUMBER][statement->get_line()].insert(_current);
+
+    CalleeVisitor visitor;
+    statement->accept_statement_visitor(&visitor);
+
+    if(visitor.get_callee() != NULL) {
+        int symbol = visitor.get_callee()->get_symbol();
+        _callees[statement] = symbol;
+        _tables[ATTR_CALL_NAME][symbol].insert(_current);
+    }
+}
+
+void AttributeIndex::visit_proc_condition(ProcCondition *condition) {
+    _tables[ATTR_PROC_NAME][condition->get_proc_ast()->get_symbol()].insert(_current);
+}
+
+void AttributeIndex::visit_variable_condition(VariableCondition *condition) {
+    _tables[ATTR_VAR_NAME][condition->get_variable()->get_symbol()].insert(_current);
+}
+
+void AttributeIndex::visit_constant_condition(ConstantCondition *condition) {
+    _tables[ATTR_VALUE][condition->get_constant()->get_int()].insert(_current);
+}
+
+void AttributeIndex::visit_pattern_condition(PatternCondition*) {
+    // patterns have no attributes
+}
+
+} // namespace impl
+} // namespace simple
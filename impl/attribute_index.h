@@ -0,0 +1,98 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include "simple/ast.h"
+#include "simple/condition.h"
+#include "simple/condition_set.h"
+#include "impl/condition_table.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+enum Attribute {
+    ATTR_PROC_NAME,     // p.procName
+    ATTR_CALL_NAME,     // c.procName of a call statement
+    ATTR_VAR_NAME,      // v.varName
+    ATTR_VALUE,         // c.value
+    ATTR_STMT_NUMBER,   // s.stmt#
+    ATTR_COUNT
+};
+
+/*
+ * AttributeIndex maps the value of each attribute to the conditions
+ * that have it, so that with clauses are answered by a single lookup.
+ *
+ * Names are keyed by their symbol and numbers by their value. Keys of
+ * a name attribute are therefore only comparable with keys of another
+ * name attribute.
+ */
+class AttributeIndex : public ConditionVisitor {
+  public:
+    AttributeIndex(ConditionTablePtr table);
+
+    static bool is_name(Attribute attr);
+
+    /*
+     * Returns false if the condition does not have the attribute.
+     */
+    bool get_key(Attribute attr, StatementAst *statement, int& key) const;
+    bool get_key(Attribute attr, ProcAst *proc, int& key) const;
+    bool get_key(Attribute attr, SimpleVariable *var, int& key) const;
+    bool get_key(Attribute attr, SimpleConstant *constant, int& key) const;
+
+    template <typename Condition>
+    bool get_key(Attribute attr, Condition *condition, int& key) const {
+        return false;
+    }
+
+    const ConditionSet& find(Attribute attr, int key) const;
+
+    /*
+     * The number of pairs of conditions whose attributes are equal.
+     */
+    size_t count_pairs(Attribute attr1, Attribute attr2) const;
+
+    void visit_statement_condition(StatementCondition *condition);
+    void visit_proc_condition(ProcCondition *condition);
+    void visit_variable_condition(VariableCondition *condition);
+    void visit_constant_condition(ConstantCondition *condition);
+    void visit_pattern_condition(PatternCondition *condition);
+
+  private:
+    typedef std::unordered_map<int, ConditionSet> KeyTable;
+
+    KeyTable    _tables[ATTR_COUNT];
+    std::unordered_map<StatementAst*, int> _callees;
+    ConditionSet _empty;
+
+    /*
+     * Only used while the index is being built.
+     */
+    ConditionPtr _current;
+};
+
+typedef std::shared_ptr<AttributeIndex> AttributeIndexPtr;
+
+} // namespace impl
+} // namespace simple
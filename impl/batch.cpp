@@ -0,0 +1,372 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <sys/resource.h>
+#include "impl/batch.h"
+
+namespace simple {
+namespace impl {
+
+namespace {
+
+std::string trim(const std::string& str) {
+    size_t begin = 0;
+    size_t end = str.size();
+
+    while(begin < end && isspace(static_cast<unsigned char>(str[begin]))) {
+        ++begin;
+    }
+    while(end > begin && isspace(static_cast<unsigned char>(str[end - 1]))) {
+        --end;
+    }
+    return str.substr(begin, end - begin);
+}
+
+bool is_number(const std::string& str) {
+    if(str.empty()) {
+        return false;
+    }
+
+    for(size_t i = 0; i < str.size(); ++i) {
+        if(!isdigit(static_cast<unsigned char>(str[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * A query header is the query number followed by a dash and the
+ * comment, such as "12 - follows with constants".
+ */
+bool parse_header(const std::string& line, BatchQuery& query) {
+    size_t dash = line.find('-');
+    if(dash == std::string::npos) {
+        return false;
+    }
+
+    std::string id = trim(line.substr(0, dash));
+    if(!is_number(id)) {
+        return false;
+    }
+
+    query.id = id;
+    query.comment = trim(line.substr(dash + 1));
+    return true;
+}
+
+std::set<std::string> split_answer(const std::string& answer) {
+    std::set<std::string> result;
+    std::string trimmed = trim(answer);
+
+    if(trimmed.empty() || trimmed == "none") {
+        return result;
+    }
+
+    size_t begin = 0;
+    while(begin <= trimmed.size()) {
+        size_t end = trimmed.find(',', begin);
+        if(end == std::string::npos) {
+            end = trimmed.size();
+        }
+
+        std::string value = trim(trimmed.substr(begin, end - begin));
+        if(value.size() >= 2 && value[0] == '"' && 
+                value[value.size() - 1] == '"') 
+        {
+            value = value.substr(1, value.size() - 2);
+        }
+        result.insert(value);
+
+        begin = end + 1;
+    }
+    return result;
+}
+
+/*
+ * The peak resident memory is read from VmHWM, which is reset before
+ * every query by writing 5 to clear_refs. On systems without them the
+ * process-wide peak from getrusage() is used instead.
+ */
+void reset_peak_memory() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if(clear_refs.is_open()) {
+        clear_refs << "5";
+    }
+}
+
+long get_peak_memory_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while(getline(status, line)) {
+        if(line.compare(0, 6, "VmHWM:") == 0) {
+            return atol(line.c_str() + 6);
+        }
+    }
+
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;
+    }
+    return -1;
+}
+
+const char* status_name(const BatchResult& result) {
+    switch(result.status) {
+        case QUERY_TIMEOUT:
+            return "timeout";
+        case QUERY_ERROR:
+            return "error";
+        default:
+            return result.passed ? "pass" : "fail";
+    }
+}
+
+std::string escape_json(const std::string& str) {
+    std::string result;
+    for(size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if(c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+BatchQueryRunner::BatchQueryRunner(SimplePqlFrontEnd& frontend, 
+        long default_timeout_ms, size_t threads) :
+    _frontend(frontend), _default_timeout_ms(default_timeout_ms),
+    _threads(std::max(threads, size_t(1)))
+{ }
+
+std::vector<BatchQuery> BatchQueryRunner::read_queries(std::istream& in) {
+    std::vector<std::string> lines;
+    std::string line;
+
+    while(getline(in, line)) {
+        if(!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        lines.push_back(line);
+    }
+
+    std::vector<BatchQuery> result;
+    size_t i = 0;
+
+    while(i < lines.size()) {
+        BatchQuery query;
+        if(!parse_header(lines[i], query)) {
+            ++i;
+            continue;
+        }
+
+        query.declarations = i + 1 < lines.size() ? lines[i + 1] : "";
+        query.query = i + 2 < lines.size() ? lines[i + 2] : "";
+        query.expected = i + 3 < lines.size() ? trim(lines[i + 3]) : "";
+        i += 4;
+
+        BatchQuery next;
+        if(i < lines.size() && is_number(trim(lines[i])) && 
+                !parse_header(lines[i], next)) 
+        {
+            query.timeout_ms = atol(trim(lines[i]).c_str());
+            ++i;
+        }
+
+        result.push_back(query);
+    }
+
+    return result;
+}
+
+BatchResult BatchQueryRunner::run(const BatchQuery& query) {
+    BatchResult result;
+    result.id = query.id;
+
+    long timeout_ms = query.timeout_ms >= 0 ? 
+        query.timeout_ms : _default_timeout_ms;
+
+    QueryBudgetPtr budget;
+    if(timeout_ms > 0) {
+        budget.reset(new QueryBudget(timeout_ms));
+    }
+
+    std::string text = query.declarations + "\n" + query.query;
+
+    if(_threads == 1) {
+        reset_peak_memory();
+    }
+    std::chrono::steady_clock::time_point start = 
+        std::chrono::steady_clock::now();
+
+    result.status = _frontend.process_query(text.begin(), text.end(), 
+            std::back_inserter(result.output), budget);
+
+    result.wall_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    result.peak_memory_kb = get_peak_memory_kb();
+
+    result.passed = result.status == QUERY_OK && 
+        match_answer(result.output, query.expected);
+
+    return result;
+}
+
+/*
+ * The workers take the next query from a shared counter. A finished
+ * result is only logged once all queries before it are logged, so
+ * the log keeps the order of the query file.
+ */
+std::vector<BatchResult> BatchQueryRunner::run_all(
+        const std::vector<BatchQuery>& queries, std::ostream& log)
+{
+    std::vector<BatchResult> results(queries.size());
+    std::vector<bool> done(queries.size(), false);
+    std::atomic<size_t> next(0);
+    std::mutex log_mutex;
+    size_t logged = 0;
+
+    auto worker = [&]() {
+        for(size_t i = next++; i < queries.size(); i = next++) {
+            BatchResult result = run(queries[i]);
+
+            std::lock_guard<std::mutex> lock(log_mutex);
+            results[i] = std::move(result);
+            done[i] = true;
+
+            while(logged < queries.size() && done[logged]) {
+                log_result(queries[logged], results[logged], log);
+                ++logged;
+            }
+        }
+    };
+
+    size_t threads = std::min(_threads, queries.size());
+    if(threads <= 1) {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> pool;
+    for(size_t i = 0; i < threads; ++i) {
+        pool.push_back(std::thread(worker));
+    }
+
+    for(size_t i = 0; i < pool.size(); ++i) {
+        pool[i].join();
+    }
+
+    return results;
+}
+
+void BatchQueryRunner::log_result(const BatchQuery& query, 
+        const BatchResult& result, std::ostream& log)
+{
+    log << query.id << " - " << status_name(result) << " " 
+        << result.wall_ms << " ms " 
+        << result.peak_memory_kb << " kB" << std::endl;
+
+    if(!result.passed) {
+        log << "  expected: " << query.expected << std::endl
+            << "  actual:   " << result.output << std::endl;
+    }
+}
+
+bool BatchQueryRunner::match_answer(const std::string& output,
+        const std::string& expected)
+{
+    std::string answer = output;
+
+    size_t separator = answer.find(" = ");
+    if(separator != std::string::npos) {
+        answer = answer.substr(separator + 3);
+    }
+
+    return split_answer(answer) == split_answer(expected);
+}
+
+void BatchQueryRunner::write_summary(const std::vector<BatchResult>& results,
+        std::ostream& out)
+{
+    size_t passed = 0, failed = 0, timeouts = 0, errors = 0;
+    double wall_ms = 0;
+    long peak_memory_kb = -1;
+
+    for(std::vector<BatchResult>::const_iterator it = results.begin();
+            it != results.end(); ++it)
+    {
+        if(it->status == QUERY_TIMEOUT) {
+            ++timeouts;
+        } else if(it->status == QUERY_ERROR) {
+            ++errors;
+        } else if(it->passed) {
+            ++passed;
+        } else {
+            ++failed;
+        }
+
+        wall_ms += it->wall_ms;
+        peak_memory_kb = std::max(peak_memory_kb, it->peak_memory_kb);
+    }
+
+    out << "{" << std::endl
+        << "  \"total\": " << results.size() << "," << std::endl
+        << "  \"passed\": " << passed << "," << std::endl
+        << "  \"failed\": " << failed << "," << std::endl
+        << "  \"timeouts\": " << timeouts << "," << std::endl
+        << "  \"errors\": " << errors << "," << std::endl
+        << "  \"wall_ms\": " << wall_ms << "," << std::endl
+        << "  \"peak_memory_kb\": " << peak_memory_kb << "," << std::endl
+        << "  \"queries\": [";
+
+    for(std::vector<BatchResult>::const_iterator it = results.begin();
+            it != results.end(); ++it)
+    {
+        out << (it == results.begin() ? "" : ",") << std::endl
+            << "    {\"id\": \"" << escape_json(it->id) << "\", "
+            << "\"status\": \"" << status_name(*it) << "\", "
+            << "\"wall_ms\": " << it->wall_ms << ", "
+            << "\"peak_memory_kb\": " << it->peak_memory_kb << "}";
+    }
+
+    out << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,119 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include "impl/frontend.h"
+
+namespace simple {
+namespace impl {
+
+/*
+ * A query read from an autotester query file. Each query takes the
+ * lines
+ *
+ *   <id> - <comment>
+ *   <declarations>
+ *   <query>
+ *   <expected answer>
+ *
+ * optionally followed by a line with its time limit in milliseconds.
+ */
+class BatchQuery {
+  public:
+    BatchQuery() : timeout_ms(-1) { }
+
+    std::string id;
+    std::string comment;
+    std::string declarations;
+    std::string query;
+    std::string expected;
+    long        timeout_ms;
+};
+
+class BatchResult {
+  public:
+    BatchResult() : status(QUERY_OK), passed(false), 
+        wall_ms(0), peak_memory_kb(-1) 
+    { }
+
+    std::string id;
+    std::string output;
+    QueryStatus status;
+    bool        passed;
+    double      wall_ms;
+    long        peak_memory_kb;
+};
+
+/*
+ * BatchQueryRunner evaluates a query file against a parsed program and
+ * records the wall time, the peak resident memory and whether the
+ * answer matches for every query. Queries without their own time
+ * limit use the default timeout, and a non-positive timeout disables
+ * the limit.
+ *
+ * With more than one thread the queries are evaluated concurrently
+ * against the shared front end. The peak memory is then the peak of
+ * the whole process, since it cannot be told apart per query.
+ */
+class BatchQueryRunner {
+  public:
+    BatchQueryRunner(SimplePqlFrontEnd& frontend, long default_timeout_ms,
+            size_t threads = 1);
+
+    static std::vector<BatchQuery> read_queries(std::istream& in);
+
+    BatchResult run(const BatchQuery& query);
+
+    /*
+     * Runs the queries, printing one line per query to log in the
+     * order of the queries.
+     */
+    std::vector<BatchResult> run_all(const std::vector<BatchQuery>& queries,
+            std::ostream& log);
+
+    /*
+     * Compares the printed result with the expected answer as sets of
+     * comma separated values. The selected query variable and the
+     * quotes around variable names are not part of the answer, and an
+     * empty expected answer or "none" matches an empty result.
+     */
+    static bool match_answer(const std::string& output, 
+            const std::string& expected);
+
+    /*
+     * Writes the totals and the per-query results as JSON.
+     */
+    static void write_summary(const std::vector<BatchResult>& results,
+            std::ostream& out);
+
+  private:
+    void log_result(const BatchQuery& query, const BatchResult& result,
+            std::ostream& log);
+
+    SimplePqlFrontEnd&  _frontend;
+    long                _default_timeout_ms;
+    size_t              _threads;
+};
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,81 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <exception>
+
+namespace simple {
+namespace impl {
+
+class QueryTimeoutError : public std::exception {
+  public:
+    const char* what() const throw() {
+        return "query timed out";
+    }
+};
+
+/*
+ * QueryBudget bounds the wall time of a single query. The processor
+ * and linker call check() inside their loops, which throws a
+ * QueryTimeoutError once the deadline has passed. The clock is only
+ * read every CHECK_INTERVAL calls to keep the check cheap.
+ */
+class QueryBudget {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const unsigned CHECK_INTERVAL = 256;
+
+    QueryBudget(long timeout_ms) : 
+        _deadline(Clock::now() + std::chrono::milliseconds(timeout_ms)),
+        _ticks(0)
+    { }
+
+    void check() {
+        if(++_ticks % CHECK_INTERVAL == 0) {
+            check_now();
+        }
+    }
+
+    void check_now() {
+        if(Clock::now() >= _deadline) {
+            throw QueryTimeoutError();
+        }
+    }
+
+  private:
+    Clock::time_point   _deadline;
+    unsigned            _ticks;
+};
+
+typedef std::shared_ptr<QueryBudget> QueryBudgetPtr;
+
+/*
+ * Queries without a budget run until they are done.
+ */
+inline void check_budget(const QueryBudgetPtr& budget) {
+    if(budget) {
+        budget->check();
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,646 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <algorithm>
+#include "impl/cfg.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+SimpleCfg::SimpleCfg(SimpleRoot ast, ConditionTablePtr table) :
+    SimpleCfg(ast, table, FlatAst(ast))
+{ }
+
+SimpleCfg::SimpleCfg(SimpleRoot ast, ConditionTablePtr table, const FlatAst& flat) :
+    _ast(ast), _table(table), _universe(table->get_universe()), 
+    _first(-1), _count(0), _inext_size(0)
+{
+    index_procs(flat, NULL, std::vector<ProcShift>());
+}
+
+SimpleCfg::SimpleCfg(SimpleRoot ast, ConditionTablePtr table, const FlatAst& flat,
+        const SimpleCfg& previous, const std::vector<ProcShift>& shifts) :
+    _ast(ast), _table(table), _universe(table->get_universe()), 
+    _first(-1), _count(0), _inext_size(0)
+{
+    index_procs(flat, &previous, shifts);
+}
+
+SimpleCfg::SimpleCfg(SimpleRoot ast, ConditionTablePtr table, 
+        SnapshotReader& in) :
+    _ast(ast), _table(table), _universe(table->get_universe()), 
+    _first(-1), _count(0), _inext_size(0)
+{
+    _next.load(in, _universe);
+    _first = in.read_int();
+    _count = in.read_int();
+    in.read_array(_proc);
+    in.read_array(_position);
+    in.read_array(_component);
+
+    _proc_members.resize(in.read_u64());
+    for(size_t p = 0; p < _proc_members.size(); ++p) {
+        in.read_array(_proc_members[p]);
+    }
+
+    _proc_components.resize(in.read_u64());
+    for(size_t p = 0; p < _proc_components.size(); ++p) {
+        in.read_array(_proc_components[p]);
+    }
+
+    in.read_array(_component_proc);
+    in.read_array(_member_offsets);
+    in.read_array(_members);
+    in.read_array(_reach_offsets);
+    in.read_array(_reach);
+    _inext_size = in.read_u64();
+}
+
+void SimpleCfg::save(SnapshotWriter& out) const {
+    _next.save(out);
+    out.write_int(_first);
+    out.write_int(_count);
+    out.write_array(_proc);
+    out.write_array(_position);
+    out.write_array(_component);
+
+    out.write_u64(_proc_members.size());
+    for(size_t p = 0; p < _proc_members.size(); ++p) {
+        out.write_array(_proc_members[p]);
+    }
+
+    out.write_u64(_proc_components.size());
+    for(size_t p = 0; p < _proc_components.size(); ++p) {
+        out.write_array(_proc_components[p]);
+    }
+
+    out.write_array(_component_proc);
+    out.write_array(_member_offsets);
+    out.write_array(_members);
+    out.write_array(_reach_offsets);
+    out.write_array(_reach);
+    out.write_u64(_inext_size);
+}
+
+const RelationTable& SimpleCfg::get_next() const {
+    return _next;
+}
+
+int SimpleCfg::get_proc_size(int statement_id) const {
+    int index = get_index(statement_id);
+    if(index == -1 || _proc[index] == -1) {
+        return 0;
+    }
+    return _proc_members[_proc[index]].size();
+}
+
+int SimpleCfg::get_statement_id(StatementAst *statement) {
+    ConditionPtr condition = _table->get_statement_condition(statement);
+    if(condition.get_table() == _table.get()) {
+        return condition.get_id();
+    } else {
+        return -1;
+    }
+}
+
+int SimpleCfg::get_index(int id) const {
+    if(id < _first || id >= _first + _count) {
+        return -1;
+    }
+    return id - _first;
+}
+
+/*
+ * The edges of a shifted procedure move with its statements.
+ */
+void SimpleCfg::index_procs(const FlatAst& flat, const SimpleCfg *previous,
+        const std::vector<ProcShift>& shifts)
+{
+    std::map<ProcAst*, const ProcShift*> shifted;
+    for(size_t i = 0; i < shifts.size(); ++i) {
+        shifted[shifts[i].proc] = &shifts[i];
+    }
+
+    std::vector<const ProcShift*> proc_shifts;
+    for(int p = 0; p < flat.get_proc_count(); ++p) {
+        _proc_ids.push_back(std::vector<int>());
+
+        std::map<ProcAst*, const ProcShift*>::iterator found = 
+            shifted.find(flat.get_proc_ast(p));
+        if(found == shifted.end()) {
+            proc_shifts.push_back(NULL);
+            index_proc(flat, p);
+        } else {
+            proc_shifts.push_back(found->second);
+            copy_proc(*previous, *found->second);
+        }
+    }
+
+    _next.build(_universe);
+    index_members();
+
+    _component.assign(_count, -1);
+    _member_offsets.push_back(0);
+    for(size_t p = 0; p < _proc_members.size(); ++p) {
+        if(proc_shifts[p] != NULL) {
+            copy_components(p, *previous, *proc_shifts[p]);
+        } else {
+            find_components(p);
+        }
+
+        if(!has_reach(p)) {
+            estimate_reach(p);
+        }
+    }
+}
+
+/*
+ * The follow of a statement is the one executed after it falls
+ * through: its next statement, else the loop around it, else the
+ * follow of the if statement around it. Parents come before their
+ * children in the flat layout, so their follows are already known.
+ */
+void SimpleCfg::index_proc(const FlatAst& flat, int proc) {
+    int begin = flat.get_proc_begin(proc);
+    int end = flat.get_proc_end(proc);
+
+    std::vector<int> ids(end - begin);
+    std::vector<int> follow(end - begin);
+
+    for(int i = begin; i < end; ++i) {
+        ids[i - begin] = get_statement_id(flat.get_statement_ast(i));
+        if(ids[i - begin] != -1) {
+            _proc_ids.back().push_back(ids[i - begin]);
+        }
+
+        int parent = flat.get_parent(i);
+        if(flat.get_next(i) != -1) {
+            follow[i - begin] = flat.get_next(i);
+        } else if(parent == -1) {
+            follow[i - begin] = -1;
+        } else if(flat.get_type(parent) == FLAT_WHILE) {
+            follow[i - begin] = parent;
+        } else {
+            follow[i - begin] = follow[parent - begin];
+        }
+    }
+
+    for(int i = begin; i < end; ++i) {
+        int targets[2] = { -1, -1 };
+
+        switch(flat.get_type(i)) {
+            case FLAT_ASSIGNMENT:
+            case FLAT_CALL:
+                targets[0] = follow[i - begin];
+            break;
+            case FLAT_CONDITIONAL:
+                targets[0] = flat.get_first_child(i);
+                targets[1] = flat.get_else_child(i);
+            break;
+            case FLAT_WHILE:
+                targets[0] = flat.get_first_child(i);
+                targets[1] = follow[i - begin];
+            break;
+        }
+
+        for(int k = 0; k < 2; ++k) {
+            if(targets[k] != -1) {
+                _next.add_pair(ids[i - begin], ids[targets[k] - begin]);
+            }
+        }
+    }
+}
+
+void SimpleCfg::copy_proc(const SimpleCfg& previous, const ProcShift& shift) {
+    int offset = shift.new_first - shift.old_first;
+
+    for(int id = shift.old_first; id < shift.old_first + shift.size; ++id) {
+        _proc_ids.back().push_back(id + offset);
+
+        for(RelationTable::id_iterator next = previous._next.right_begin(id);
+                next != previous._next.right_end(id); ++next)
+        {
+            _next.add_pair(id + offset, *next + offset);
+        }
+    }
+}
+
+void SimpleCfg::index_members() {
+    int last = -1;
+    for(size_t p = 0; p < _proc_ids.size(); ++p) {
+        for(size_t i = 0; i < _proc_ids[p].size(); ++i) {
+            int id = _proc_ids[p][i];
+            _first = (_first == -1) ? id : std::min(_first, id);
+            last = std::max(last, id);
+        }
+    }
+    _count = (_first == -1) ? 0 : last - _first + 1;
+
+    _proc.assign(_count, -1);
+    _position.assign(_count, -1);
+    _proc_members.resize(_proc_ids.size());
+    _proc_components.resize(_proc_ids.size());
+
+    for(size_t p = 0; p < _proc_ids.size(); ++p) {
+        std::vector<int>& members = _proc_members[p];
+        for(size_t i = 0; i < _proc_ids[p].size(); ++i) {
+            members.push_back(get_index(_proc_ids[p][i]));
+        }
+        std::sort(members.begin(), members.end());
+
+        for(size_t i = 0; i < members.size(); ++i) {
+            _proc[members[i]] = p;
+            _position[members[i]] = i;
+        }
+    }
+    std::vector< std::vector<int> >().swap(_proc_ids);
+}
+
+/*
+ * Tarjan's algorithm without recursion. Components are completed in
+ * reverse topological order, so the reachability of every successor
+ * component is known by the time a component is added. The Next
+ * relation never leaves a procedure, so each procedure is searched on
+ * its own, indexed by the positions of its statements.
+ */
+void SimpleCfg::find_components(int proc) {
+    const std::vector<int>& proc_members = _proc_members[proc];
+    std::vector<int> number(proc_members.size(), -1);
+    std::vector<int> low(proc_members.size(), 0);
+    std::vector<char> on_stack(proc_members.size(), 0);
+    std::vector<int> stack;
+    std::vector< std::pair<int, RelationTable::id_iterator> > frames;
+    int counter = 0;
+
+    for(size_t i = 0; i < proc_members.size(); ++i) {
+        int root = proc_members[i];
+        if(number[i] != -1) {
+            continue;
+        }
+
+        number[i] = low[i] = counter++;
+        stack.push_back(root);
+        on_stack[i] = 1;
+        frames.push_back(std::make_pair(root, _next.right_begin(_first + root)));
+
+        while(!frames.empty()) {
+            int v = frames.back().first;
+            RelationTable::id_iterator& it = frames.back().second;
+
+            if(it != _next.right_end(_first + v)) {
+                int w = get_index(*it++);
+                if(w == -1) {
+                    continue;
+                }
+
+                int position = _position[w];
+                if(number[position] == -1) {
+                    number[position] = low[position] = counter++;
+                    stack.push_back(w);
+                    on_stack[position] = 1;
+                    frames.push_back(std::make_pair(w, _next.right_begin(_first + w)));
+                } else if(on_stack[position]) {
+                    low[_position[v]] = std::min(low[_position[v]], number[position]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if(!frames.empty()) {
+                int parent = _position[frames.back().first];
+                low[parent] = std::min(low[parent], low[_position[v]]);
+            }
+
+            if(low[_position[v]] == number[_position[v]]) {
+                std::vector<int> members;
+                int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[_position[w]] = 0;
+                    members.push_back(w);
+                } while(w != v);
+
+                add_component(members);
+            }
+        }
+    }
+}
+
+void SimpleCfg::add_component(const std::vector<int>& members) {
+    int component = _component_proc.size();
+    int proc = _proc[members[0]];
+    size_t offset = _reach.size();
+
+    _component_proc.push_back(proc);
+    _proc_components[proc].push_back(component);
+    _reach_offsets.push_back(offset);
+
+    for(size_t i = 0; i < members.size(); ++i) {
+        _component[members[i]] = component;
+        _members.push_back(members[i]);
+    }
+    _member_offsets.push_back(_members.size());
+
+    if(!has_reach(proc)) {
+        return;
+    }
+
+    size_t words = (_proc_members[proc].size() + WORD_BITS - 1) / WORD_BITS;
+    _reach.resize(offset + words, 0);
+
+    Word *reach = &_reach[offset];
+    bool cyclic = members.size() > 1;
+
+    for(size_t i = 0; i < members.size(); ++i) {
+        int v = members[i];
+        for(RelationTable::id_iterator it = _next.right_begin(_first + v);
+                it != _next.right_end(_first + v); ++it)
+        {
+            int w = get_index(*it);
+            if(w == -1) {
+                continue;
+            }
+
+            int other = _component[w];
+            if(other == component) {
+                cyclic = true;
+                continue;
+            }
+
+            const Word *other_reach = &_reach[_reach_offsets[other]];
+            for(size_t k = 0; k < words; ++k) {
+                reach[k] |= other_reach[k];
+            }
+            reach[_position[w] / WORD_BITS] |= Word(1) << (_position[w] % WORD_BITS);
+        }
+    }
+
+    // statements in a loop can reach each other and themselves
+    if(cyclic) {
+        for(size_t i = 0; i < members.size(); ++i) {
+            int position = _position[members[i]];
+            reach[position / WORD_BITS] |= Word(1) << (position % WORD_BITS);
+        }
+    }
+
+    for(size_t k = 0; k < words; ++k) {
+        _inext_size += members.size() * __builtin_popcountll(reach[k]);
+    }
+}
+
+/*
+ * The components of a shifted procedure are the same as before, and
+ * their reachability is stored by position within the procedure, so
+ * only the statement indexes change.
+ */
+void SimpleCfg::copy_components(int proc, const SimpleCfg& previous,
+        const ProcShift& shift)
+{
+    int old_proc = previous._proc[previous.get_index(shift.old_first)];
+    int offset = shift.new_first - shift.old_first + previous._first - _first;
+    size_t words = has_reach(proc) ? 
+        (shift.size + WORD_BITS - 1) / WORD_BITS : 0;
+
+    const std::vector<int>& components = previous._proc_components[old_proc];
+    for(size_t i = 0; i < components.size(); ++i) {
+        int old_component = components[i];
+        int component = _component_proc.size();
+
+        _component_proc.push_back(proc);
+        _proc_components[proc].push_back(component);
+        _reach_offsets.push_back(_reach.size());
+
+        const Word *reach = previous._reach.data() + 
+            previous._reach_offsets[old_component];
+        _reach.insert(_reach.end(), reach, reach + words);
+
+        int begin = previous._member_offsets[old_component];
+        int end = previous._member_offsets[old_component + 1];
+        for(int m = begin; m < end; ++m) {
+            int index = previous._members[m] + offset;
+            _component[index] = component;
+            _members.push_back(index);
+        }
+        _member_offsets.push_back(_members.size());
+
+        for(size_t k = 0; k < words; ++k) {
+            _inext_size += (end - begin) * __builtin_popcountll(reach[k]);
+        }
+    }
+}
+
+bool SimpleCfg::has_reach(int proc) const {
+    return _proc_members[proc].size() <= REACH_LIMIT;
+}
+
+/*
+ * Without the bitsets, a component is taken to reach as many
+ * statements as the successor that reaches the most, plus its own
+ * statements if it is a loop. This is exact for straight-line code
+ * and only misses the other branch of an if statement.
+ */
+void SimpleCfg::estimate_reach(int proc) {
+    const std::vector<int>& components = _proc_components[proc];
+    if(components.empty()) {
+        return;
+    }
+
+    int base = components.front();
+    std::vector<size_t> reach(components.size(), 0);
+    std::vector<char> cyclic(components.size(), 0);
+
+    for(size_t c = 0; c < components.size(); ++c) {
+        int component = components[c];
+        int begin = _member_offsets[component];
+        int end = _member_offsets[component + 1];
+        size_t successor = 0;
+
+        cyclic[c] = end - begin > 1;
+        for(int m = begin; m < end; ++m) {
+            int v = _members[m];
+            for(RelationTable::id_iterator it = _next.right_begin(_first + v);
+                    it != _next.right_end(_first + v); ++it)
+            {
+                int w = get_index(*it);
+                if(w == -1) {
+                    continue;
+                }
+
+                int other = _component[w] - base;
+                if(other == int(c)) {
+                    cyclic[c] = 1;
+                } else {
+                    successor = std::max(successor, 
+                            reach[other] + (cyclic[other] ? 0 : 1));
+                }
+            }
+        }
+
+        reach[c] = successor + (cyclic[c] ? end - begin : 0);
+        _inext_size += (end - begin) * reach[c];
+    }
+}
+
+bool SimpleCfg::test_reach(int component, int position) const {
+    return (_reach[_reach_offsets[component] + position / WORD_BITS] >> 
+            (position % WORD_BITS)) & 1;
+}
+
+/*
+ * Marks the positions of the statements reachable from the statement
+ * at the given index, following the Next edges forward or backward.
+ * The search stops as soon as it reaches the target position, and
+ * returns whether it did; a target of -1 marks everything reachable.
+ * The buffers are kept per thread, since the graph is shared between
+ * the queries of a batch.
+ */
+bool SimpleCfg::search(int index, bool forward, int target, 
+        std::vector<char>& found) const 
+{
+    thread_local std::vector<int> pending;
+
+    found.assign(_proc_members[_proc[index]].size(), 0);
+    pending.assign(1, index);
+
+    while(!pending.empty()) {
+        int v = pending.back();
+        pending.pop_back();
+
+        RelationTable::id_iterator it = forward ? 
+            _next.right_begin(_first + v) : _next.left_begin(_first + v);
+        RelationTable::id_iterator end = forward ?
+            _next.right_end(_first + v) : _next.left_end(_first + v);
+
+        for(; it != end; ++it) {
+            int w = get_index(*it);
+            if(w != -1 && !found[_position[w]]) {
+                if(_position[w] == target) {
+                    return true;
+                }
+
+                found[_position[w]] = 1;
+                pending.push_back(w);
+            }
+        }
+    }
+    return false;
+}
+
+ConditionSet SimpleCfg::search_inext(int index, bool forward) const {
+    thread_local std::vector<char> found;
+    search(index, forward, -1, found);
+
+    const std::vector<int>& proc_members = _proc_members[_proc[index]];
+    std::vector<int> ids;
+    for(size_t position = 0; position < found.size(); ++position) {
+        if(found[position]) {
+            ids.push_back(_first + proc_members[position]);
+        }
+    }
+    return ConditionSet(_universe, ids);
+}
+
+bool SimpleCfg::validate_inext(int left, int right) const {
+    int i = get_index(left), j = get_index(right);
+    if(i == -1 || j == -1 || _component[i] == -1 || _proc[i] != _proc[j]) {
+        return false;
+    }
+
+    if(!has_reach(_proc[i])) {
+        thread_local std::vector<char> found;
+        return search(i, true, _position[j], found);
+    }
+    return test_reach(_component[i], _position[j]);
+}
+
+ConditionSet SimpleCfg::solve_inext_right(int left) const {
+    int i = get_index(left);
+    if(i == -1 || _component[i] == -1) {
+        return ConditionSet();
+    }
+
+    if(!has_reach(_proc[i])) {
+        return search_inext(i, true);
+    }
+
+    const std::vector<int>& proc_members = _proc_members[_proc[i]];
+    const Word *reach = &_reach[_reach_offsets[_component[i]]];
+    size_t words = (proc_members.size() + WORD_BITS - 1) / WORD_BITS;
+    std::vector<int> ids;
+
+    for(size_t w = 0; w < words; ++w) {
+        Word bits = reach[w];
+        while(bits != 0) {
+            int position = w * WORD_BITS + __builtin_ctzll(bits);
+            ids.push_back(_first + proc_members[position]);
+            bits &= bits - 1;
+        }
+    }
+    return ConditionSet(_universe, ids);
+}
+
+ConditionSet SimpleCfg::solve_inext_left(int right) const {
+    int j = get_index(right);
+    if(j == -1 || _component[j] == -1) {
+        return ConditionSet();
+    }
+
+    if(!has_reach(_proc[j])) {
+        return search_inext(j, false);
+    }
+
+    const std::vector<int>& components = _proc_components[_proc[j]];
+    std::vector<int> ids;
+
+    for(size_t k = 0; k < components.size(); ++k) {
+        int c = components[k];
+        if(!test_reach(c, _position[j])) {
+            continue;
+        }
+
+        for(int m = _member_offsets[c]; m < _member_offsets[c + 1]; ++m) {
+            ids.push_back(_first + _members[m]);
+        }
+    }
+    return ConditionSet(_universe, ids);
+}
+
+bool SimpleCfg::has_inext_right(int left) const {
+    return _next.has_right(left);
+}
+
+bool SimpleCfg::has_inext_left(int right) const {
+    return _next.has_left(right);
+}
+
+size_t SimpleCfg::get_inext_size() const {
+    return _inext_size;
+}
+
+size_t SimpleCfg::get_component_count() const {
+    return _component_proc.size();
+}
+
+SimpleCfg::~SimpleCfg() { }
+
+} // namespace impl
+} // namespace simple
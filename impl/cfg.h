@@ -0,0 +1,166 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include "simple/ast.h"
+#include "simple/condition_set.h"
+#include "simple/condition_table.h"
+#include "impl/relation_table.h"
+#include "impl/flat_ast.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * A procedure that is unchanged since a previous analysis of the
+ * program. Its statements keep their order and their IDs are still
+ * contiguous, so they all moved by the same offset from the old IDs.
+ */
+class ProcShift {
+  public:
+    ProcAst *proc;
+    int old_proc_id;
+    int new_proc_id;
+    int old_first;
+    int new_first;
+    int size;
+};
+
+/*
+ * SimpleCfg is the control flow graph of every procedure in the
+ * program. The Next relation is stored as a RelationTable, which keeps
+ * both the forward and the backward edges in compressed arrays.
+ *
+ * For Next*, each procedure graph is condensed into its strongly
+ * connected components, so a whole while loop becomes a single node.
+ * Every component keeps a bitset over the statements of its procedure
+ * that can be reached from it.
+ *
+ * The bitsets of a procedure grow with the square of its size, so
+ * procedures with more than REACH_LIMIT statements keep none. Next*
+ * in such a procedure is answered by searching the graph on every
+ * query instead, and its share of get_inext_size() is estimated.
+ */
+class SimpleCfg {
+  public:
+    SimpleCfg(SimpleRoot ast, ConditionTablePtr table);
+    SimpleCfg(SimpleRoot ast, ConditionTablePtr table, const FlatAst& flat);
+
+    /*
+     * Loads the graph from a snapshot instead of building it.
+     */
+    SimpleCfg(SimpleRoot ast, ConditionTablePtr table, SnapshotReader& in);
+
+    void save(SnapshotWriter& out) const;
+
+    /*
+     * Rebuilds the graph after the program was edited. The graphs of
+     * the shifted procedures are copied from the previous graph, all
+     * other procedures are indexed again.
+     */
+    SimpleCfg(SimpleRoot ast, ConditionTablePtr table, const FlatAst& flat,
+            const SimpleCfg& previous, const std::vector<ProcShift>& shifts);
+
+    const RelationTable& get_next() const;
+
+    /*
+     * Get the number of statements in the procedure of a statement.
+     */
+    int get_proc_size(int statement_id) const;
+
+    bool validate_inext(int left, int right) const;
+    ConditionSet solve_inext_right(int left) const;
+    ConditionSet solve_inext_left(int right) const;
+
+    bool has_inext_right(int left) const;
+    bool has_inext_left(int right) const;
+
+    size_t get_inext_size() const;
+    size_t get_component_count() const;
+
+    static const size_t REACH_LIMIT = 4096;
+
+    ~SimpleCfg();
+
+  private:
+    typedef unsigned long long Word;
+    static const size_t WORD_BITS = 64;
+
+    int get_statement_id(StatementAst *statement);
+    int get_index(int id) const;
+
+    void index_procs(const FlatAst& flat, const SimpleCfg *previous,
+            const std::vector<ProcShift>& shifts);
+    void index_proc(const FlatAst& flat, int proc);
+    void copy_proc(const SimpleCfg& previous, const ProcShift& shift);
+
+    void index_members();
+    void find_components(int proc);
+    void add_component(const std::vector<int>& members);
+    void copy_components(int proc, const SimpleCfg& previous,
+            const ProcShift& shift);
+
+    bool has_reach(int proc) const;
+    void estimate_reach(int proc);
+
+    bool test_reach(int component, int position) const;
+    bool search(int index, bool forward, int target, 
+            std::vector<char>& found) const;
+    ConditionSet search_inext(int index, bool forward) const;
+
+    SimpleRoot              _ast;
+    ConditionTablePtr       _table;
+    ConditionUniversePtr    _universe;
+    RelationTable           _next;
+
+    /*
+     * Statements are indexed by their ID minus the ID of the first
+     * statement.
+     */
+    int                 _first;
+    int                 _count;
+    std::vector<int>    _proc;
+    std::vector<int>    _position;
+    std::vector<int>    _component;
+
+    /*
+     * The statement indexes of each procedure in ascending order, and
+     * the components found in each procedure.
+     */
+    std::vector< std::vector<int> > _proc_members;
+    std::vector< std::vector<int> > _proc_components;
+
+    std::vector<int>    _component_proc;
+    std::vector<int>    _member_offsets;
+    std::vector<int>    _members;
+    std::vector<size_t> _reach_offsets;
+    std::vector<Word>   _reach;
+    size_t              _inext_size;
+
+    /*
+     * Only used while the graph is being built.
+     */
+    std::vector< std::vector<int> > _proc_ids;
+};
+
+} // namespace impl
+} // namespace simple
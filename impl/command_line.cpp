@@ -17,11 +17,15 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <memory>
 #include "impl/frontend.h"
+#include "impl/batch.h"
 
 using namespace simple;
 using namespace simple::impl;
@@ -30,36 +34,201 @@ using std::cout;
 using std::cin;
 using std::endl;
 
+/*
+ * Usage: main <source> [--batch <queries>] [--timeout <ms>] 
+ *                      [--summary <file>] [--jobs <threads>]
+ *                      [--snapshot <file>] [--linker simple|columnar]
+ *
+ * Without --batch the queries are read one line at a time from stdin.
+ * Batches run one query at a time unless --jobs is given, so that the
+ * peak memory of each query can be measured. With more jobs the batch
+ * finishes sooner, but every query reports the peak memory of the
+ * whole process instead.
+ *
+ * With --snapshot the program is loaded from the snapshot file if it
+ * was taken from the same source, otherwise the source is parsed and
+ * the snapshot is written for the next run.
+ *
+ * Queries are linked with the columnar linker unless --linker simple
+ * is given.
+ *
+ * Entering "reload" at the prompt reads the source file again. Only
+ * the procedures that were edited since are analyzed again.
+ */
+int run_batch(SimplePqlFrontEnd& frontend, const std::string& query_file,
+        long timeout_ms, const std::string& summary_file, size_t jobs)
+{
+    std::ifstream queries(query_file);
+    if(!queries.is_open()) {
+        cout << "file " << query_file << " not found." << endl;
+        return 1;
+    }
+
+    BatchQueryRunner runner(frontend, timeout_ms, jobs);
+    std::vector<BatchResult> results = runner.run_all(
+            BatchQueryRunner::read_queries(queries), cout);
+
+    if(summary_file.empty()) {
+        BatchQueryRunner::write_summary(results, cout);
+    } else {
+        std::ofstream summary(summary_file);
+        BatchQueryRunner::write_summary(results, summary);
+    }
+    return 0;
+}
+
+std::unique_ptr<SimplePqlFrontEnd> load_snapshot(
+        const std::string& snapshot_file, const std::string& source)
+{
+    uint64_t checksum = snapshot_checksum(source.data(), source.size());
+
+    try {
+        ProgramSnapshot snapshot(snapshot_file, checksum);
+        return std::unique_ptr<SimplePqlFrontEnd>(
+                new SimplePqlFrontEnd(snapshot));
+    } catch(SnapshotError& e) {
+        // a missing or stale snapshot is rebuilt from the source
+    }
+
+    std::unique_ptr<SimplePqlFrontEnd> frontend(
+            new SimplePqlFrontEnd(source));
+
+    try {
+        frontend->save_snapshot(snapshot_file, checksum);
+    } catch(SnapshotError& e) {
+        std::cerr << "Warning: " << e.what() << endl;
+    }
+    return frontend;
+}
+
+bool read_source(const std::string& filename, std::string& content) {
+    std::ifstream source(filename.c_str(), std::ios::binary);
+    if(!source.is_open()) {
+        return false;
+    }
+
+    content.assign(std::istreambuf_iterator<char>(source),
+            std::istreambuf_iterator<char>());
+    return true;
+}
+
+/*
+ * A batch without a snapshot never reloads the source, so it is
+ * parsed straight from a mapping of the file. Otherwise the source is
+ * kept as a string for the snapshot checksum and for reloads. Returns
+ * NULL if the source file cannot be read.
+ */
+std::unique_ptr<SimplePqlFrontEnd> load_frontend(const std::string& filename,
+        const std::string& snapshot_file, bool reloadable)
+{
+    if(!reloadable && snapshot_file.empty()) {
+        try {
+            MappedFile source(filename);
+            return std::unique_ptr<SimplePqlFrontEnd>(new SimplePqlFrontEnd(
+                        source.get_data(), source.get_data() + source.get_size()));
+        } catch(FileError& e) {
+            return std::unique_ptr<SimplePqlFrontEnd>();
+        }
+    }
+
+    std::string content;
+    if(!read_source(filename, content)) {
+        return std::unique_ptr<SimplePqlFrontEnd>();
+    }
+
+    if(!snapshot_file.empty()) {
+        return load_snapshot(snapshot_file, content);
+    }
+    return std::unique_ptr<SimplePqlFrontEnd>(new SimplePqlFrontEnd(content));
+}
+
+void reload_source(SimplePqlFrontEnd& frontend, const std::string& filename) {
+    std::string content;
+    if(!read_source(filename, content)) {
+        cout << "file " << filename << " not found.";
+        return;
+    }
+
+    try {
+        frontend.update_source(content);
+        cout << "Reloaded";
+    } catch(std::exception& e) {
+        cout << "Reload failed, keeping the previous program";
+    }
+}
+
 int main(int argc, const char* argv[]) {
     if(argc < 2) {
         cout << "Please supply filename as first argument." << endl;
+        return 1;
     }
 
     std::string filename(argv[1]);
-    std::ifstream source(filename);
+    std::string query_file;
+    std::string summary_file;
+    std::string snapshot_file;
+    LinkerMode linker_mode = LINKER_COLUMNAR;
+    long timeout_ms = 5000;
+    size_t jobs = 1;
 
-    if(source.is_open()) {
-        try {
-            std::istreambuf_iterator<char> source_begin(source);
-            std::istreambuf_iterator<char> source_end;
+    for(int i = 2; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "--batch") == 0) {
+            query_file = argv[i + 1];
+        } else if(strcmp(argv[i], "--timeout") == 0) {
+            timeout_ms = atol(argv[i + 1]);
+        } else if(strcmp(argv[i], "--summary") == 0) {
+            summary_file = argv[i + 1];
+        } else if(strcmp(argv[i], "--jobs") == 0) {
+            jobs = atol(argv[i + 1]);
+        } else if(strcmp(argv[i], "--snapshot") == 0) {
+            snapshot_file = argv[i + 1];
+        } else if(strcmp(argv[i], "--linker") == 0) {
+            if(strcmp(argv[i + 1], "simple") == 0) {
+                linker_mode = LINKER_SIMPLE;
+            } else if(strcmp(argv[i + 1], "columnar") == 0) {
+                linker_mode = LINKER_COLUMNAR;
+            } else {
+                cout << "Unknown linker " << argv[i + 1] << endl;
+                return 1;
+            }
+        } else {
+            cout << "Unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    try {
+        std::unique_ptr<SimplePqlFrontEnd> loaded = load_frontend(
+                filename, snapshot_file, query_file.empty());
+        if(!loaded) {
+            cout << "file " << filename << " not found." << endl;
+            return 0;
+        }
 
-            SimplePqlFrontEnd frontend(source_begin, source_end);
+        SimplePqlFrontEnd& frontend = *loaded;
+        frontend.set_linker_mode(linker_mode);
 
-            std::string line;
-            cout << "simple> ";
-            while(getline(cin, line)) {
+        if(!query_file.empty()) {
+            return run_batch(frontend, query_file, timeout_ms, 
+                    summary_file, jobs);
+        }
+
+        std::string line;
+        cout << "simple> ";
+        while(getline(cin, line)) {
+            if(line == "reload") {
+                reload_source(frontend, filename);
+            } else {
                 frontend.process_query(line.begin(), line.end(),
                         std::ostreambuf_iterator<char>(cout));
-
-                cout << endl << "simple> ";
             }
 
-        } catch(std::exception& e) {
-            cout << "InternalError" << e.what() << endl;
-            return 0;
+            cout << endl << "simple> ";
         }
-    } else {
-        cout << "file " << filename << " not found." << endl;
+
+    } catch(std::exception& e) {
+        cout << "InternalError" << e.what() << endl;
+        return 0;
     }
 
     return 0;
@@ -0,0 +1,293 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iterator>
+#include <algorithm>
+#include "impl/condition_table.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+namespace {
+
+/*
+ * Collects the conditions of one procedure.
+ */
+class ConditionCollector : public StatementVisitor, public ExprVisitor {
+  public:
+    typedef std::vector< std::pair<ExprAst*, ConditionPtr> > PatternList;
+
+    ConditionCollector(std::vector<ConditionPtr>& conditions, PatternList& patterns) :
+        _conditions(conditions), _patterns(patterns)
+    { }
+
+    void index_proc(ProcAst *proc) {
+        _conditions.push_back(new SimpleProcCondition(proc));
+        index_statement_list(proc->get_statement());
+    }
+
+    void index_statement_list(StatementAst *statement) {
+        while(statement != NULL) {
+            _conditions.push_back(new SimpleStatementCondition(statement));
+            statement->accept_statement_visitor(this);
+            statement = statement->next();
+        }
+    }
+
+    void index_variable(SimpleVariable *var) {
+        _conditions.push_back(new SimpleVariableCondition(*var));
+    }
+
+    void visit_assignment(AssignmentAst *assign) {
+        index_variable(assign->get_variable());
+
+        if(assign->get_expr() == NULL) {
+            return;
+        }
+
+        ConditionPtr pattern = new SimplePatternCondition(assign->get_expr()->clone());
+        _conditions.push_back(pattern);
+        _patterns.push_back(std::make_pair(assign->get_expr(), pattern));
+
+        assign->get_expr()->accept_expr_visitor(this);
+    }
+
+    void visit_conditional(ConditionalAst *condition) {
+        index_variable(condition->get_variable());
+        index_statement_list(condition->get_then_branch());
+        index_statement_list(condition->get_else_branch());
+    }
+
+    void visit_while(WhileAst *loop) {
+        index_variable(loop->get_variable());
+        index_statement_list(loop->get_body());
+    }
+
+    void visit_call(CallAst *call) {
+        // the called procedure is indexed from the root
+    }
+
+    void visit_variable(VariableAst *var) {
+        index_variable(var->get_variable());
+    }
+
+    void visit_const(ConstAst *constant) {
+        _conditions.push_back(new SimpleConstantCondition(*constant->get_constant()));
+    }
+
+    void visit_binary_op(BinaryOpAst *bin) {
+        bin->get_lhs()->accept_expr_visitor(this);
+        bin->get_rhs()->accept_expr_visitor(this);
+    }
+
+  private:
+    std::vector<ConditionPtr>&  _conditions;
+    PatternList&                _patterns;
+};
+
+void sort_unique(std::vector<ConditionPtr>& conditions) {
+    std::sort(conditions.begin(), conditions.end());
+    conditions.erase(std::unique(conditions.begin(), conditions.end()), 
+            conditions.end());
+}
+
+void merge_unique(std::vector<ConditionPtr>& first, std::vector<ConditionPtr>& second,
+        std::vector<ConditionPtr>& result)
+{
+    result.reserve(first.size() + second.size());
+    std::merge(std::make_move_iterator(first.begin()), std::make_move_iterator(first.end()),
+               std::make_move_iterator(second.begin()), std::make_move_iterator(second.end()),
+               std::back_inserter(result));
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    std::vector<ConditionPtr>().swap(first);
+    std::vector<ConditionPtr>().swap(second);
+}
+
+} // anonymous namespace
+
+SimpleConditionTable::SimpleConditionTable(SimpleRoot ast, size_t threads) :
+    _ast(ast), _universe(new ConditionUniverse(this)), _current_id(0)
+{
+    std::vector<ProcAst*> procs;
+    for(SimpleRoot::iterator it = _ast.begin(); it != _ast.end(); ++it) {
+        procs.push_back(*it);
+    }
+
+    std::vector< std::vector<ConditionPtr> > runs(procs.size());
+    std::vector<ConditionCollector::PatternList> patterns(procs.size());
+
+    parallel_for(procs.size(), threads, [&](size_t p) {
+        ConditionCollector collector(runs[p], patterns[p]);
+        collector.index_proc(procs[p]);
+        sort_unique(runs[p]);
+    });
+
+    // the sorted runs are merged in pairs until one is left
+    while(runs.size() > 1) {
+        std::vector< std::vector<ConditionPtr> > merged((runs.size() + 1) / 2);
+
+        parallel_for(merged.size(), threads, [&](size_t i) {
+            if(2 * i + 1 < runs.size()) {
+                merge_unique(runs[2 * i], runs[2 * i + 1], merged[i]);
+            } else {
+                merged[i].swap(runs[2 * i]);
+            }
+        });
+        runs.swap(merged);
+    }
+
+    /*
+     * The merged run is sorted by is_less_than_condition(), so
+     * assigning the IDs in order keeps both orderings consistent
+     * with each other.
+     */
+    if(!runs.empty()) {
+        const std::vector<ConditionPtr>& conditions = runs[0];
+        for(size_t i = 0; i < conditions.size(); ++i) {
+            _current_id = _universe->get_size();
+            _universe->add_condition(ConditionPtr(conditions[i], this, _current_id));
+            conditions[i].get()->accept_condition_visitor(this);
+        }
+    }
+
+    std::vector< std::vector<int> > pattern_ids(procs.size());
+    parallel_for(procs.size(), threads, [&](size_t p) {
+        for(size_t i = 0; i < patterns[p].size(); ++i) {
+            pattern_ids[p].push_back(find_id(patterns[p][i].second));
+        }
+    });
+
+    for(size_t p = 0; p < patterns.size(); ++p) {
+        for(size_t i = 0; i < patterns[p].size(); ++i) {
+            _pattern_ids[patterns[p][i].first] = pattern_ids[p][i];
+        }
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_statement_condition(StatementAst *statement) {
+    std::unordered_map<StatementAst*, int>::iterator it = 
+        _statement_ids.find(statement);
+
+    if(it != _statement_ids.end()) {
+        return _universe->get_condition(it->second);
+    } else {
+        return new SimpleStatementCondition(statement);
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_proc_condition(ProcAst *proc) {
+    std::unordered_map<ProcAst*, int>::iterator it = _proc_ids.find(proc);
+
+    if(it != _proc_ids.end()) {
+        return _universe->get_condition(it->second);
+    } else {
+        return new SimpleProcCondition(proc);
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_variable_condition(SimpleVariable *var) {
+    size_t symbol = var->get_symbol();
+
+    if(symbol < _variable_ids.size() && _variable_ids[symbol] != -1) {
+        return _universe->get_condition(_variable_ids[symbol]);
+    } else {
+        return new SimpleVariableCondition(*var);
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_constant_condition(SimpleConstant *constant) {
+    std::unordered_map<int, int>::iterator it = 
+        _constant_ids.find(constant->get_int());
+
+    if(it != _constant_ids.end()) {
+        return _universe->get_condition(it->second);
+    } else {
+        return new SimpleConstantCondition(*constant);
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_pattern_condition(ExprAst *expr) {
+    std::unordered_map<ExprAst*, int>::iterator it = _pattern_ids.find(expr);
+
+    if(it != _pattern_ids.end()) {
+        return _universe->get_condition(it->second);
+    } else {
+        return intern(new SimplePatternCondition(expr->clone()));
+    }
+}
+
+ConditionPtr SimpleConditionTable::intern(const ConditionPtr& condition) {
+    if(condition.get_table() == this) {
+        return condition;
+    }
+
+    int id = find_id(condition);
+    if(id != -1) {
+        return _universe->get_condition(id);
+    } else {
+        return condition;
+    }
+}
+
+ConditionPtr SimpleConditionTable::get_condition(int id) {
+    return _universe->get_condition(id);
+}
+
+int SimpleConditionTable::get_size() {
+    return _universe->get_size();
+}
+
+ConditionUniversePtr SimpleConditionTable::get_universe() const {
+    return _universe;
+}
+
+int SimpleConditionTable::find_id(const ConditionPtr& condition) {
+    return _universe->find_id(condition);
+}
+
+void SimpleConditionTable::visit_statement_condition(StatementCondition *condition) {
+    _statement_ids[condition->get_statement_ast()] = _current_id;
+}
+
+void SimpleConditionTable::visit_proc_condition(ProcCondition *condition) {
+    _proc_ids[condition->get_proc_ast()] = _current_id;
+}
+
+void SimpleConditionTable::visit_variable_condition(VariableCondition *condition) {
+    size_t symbol = condition->get_variable()->get_symbol();
+    if(symbol >= _variable_ids.size()) {
+        _variable_ids.resize(symbol + 1, -1);
+    }
+    _variable_ids[symbol] = _current_id;
+}
+
+void SimpleConditionTable::visit_constant_condition(ConstantCondition *condition) {
+    _constant_ids[condition->get_constant()->get_int()] = _current_id;
+}
+
+void SimpleConditionTable::visit_pattern_condition(PatternCondition *condition) {
+    // patterns are keyed by the program expressions after all IDs are assigned
+}
+
+SimpleConditionTable::~SimpleConditionTable() { }
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,99 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "simple/ast.h"
+#include "simple/condition_table.h"
+#include "impl/condition.h"
+#include "impl/parallel.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * The table is built once from the program AST and is read only
+ * afterwards, so it can be shared by all solvers and predicates.
+ *
+ * The conditions of each procedure are collected and sorted on up to
+ * the given number of threads, and the sorted runs are then merged.
+ */
+class SimpleConditionTable : public ConditionTable, public ConditionVisitor {
+  public:
+    SimpleConditionTable(SimpleRoot ast, size_t threads = default_thread_count());
+
+    ConditionPtr get_statement_condition(StatementAst *statement);
+    ConditionPtr get_proc_condition(ProcAst *proc);
+    ConditionPtr get_variable_condition(SimpleVariable *var);
+    ConditionPtr get_constant_condition(SimpleConstant *constant);
+    ConditionPtr get_pattern_condition(ExprAst *expr);
+
+    ConditionPtr intern(const ConditionPtr& condition);
+
+    ConditionPtr get_condition(int id);
+    int get_size();
+
+    ConditionUniversePtr get_universe() const;
+
+    void visit_statement_condition(StatementCondition *condition);
+    void visit_proc_condition(ProcCondition *condition);
+    void visit_variable_condition(VariableCondition *condition);
+    void visit_constant_condition(ConstantCondition *condition);
+    void visit_pattern_condition(PatternCondition *condition);
+
+    ~SimpleConditionTable();
+
+  private:
+    int find_id(const ConditionPtr& condition);
+
+    SimpleRoot _ast;
+    std::shared_ptr<ConditionUniverse> _universe;
+
+    std::unordered_map<StatementAst*, int>  _statement_ids;
+    std::unordered_map<ProcAst*, int>       _proc_ids;
+    std::vector<int>                        _variable_ids;
+    std::unordered_map<int, int>            _constant_ids;
+    std::unordered_map<ExprAst*, int>       _pattern_ids;
+
+    /*
+     * Only used while the table is being built.
+     */
+    int _current_id;
+};
+
+/*
+ * Solvers and predicates share the table built by the front end, but
+ * build their own table when they are constructed on their own.
+ */
+inline ConditionTablePtr make_condition_table(
+        SimpleRoot ast, ConditionTablePtr table)
+{
+    if(table) {
+        return table;
+    } else {
+        return ConditionTablePtr(new SimpleConditionTable(ast));
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,216 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "impl/expr_index.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+class PatternBuilder : public ExprVisitor {
+  public:
+    PatternBuilder(const FlatAst& flat, ExprPattern& pattern) :
+        _flat(flat), _pattern(pattern), _valid(true)
+    { }
+
+    void visit_variable(VariableAst *var) {
+        int number = _flat.find_variable(var->get_variable()->get_name());
+        if(number == -1) {
+            _valid = false;
+        }
+        push(FLAT_VARIABLE, number);
+    }
+
+    void visit_const(ConstAst *constant) {
+        push(FLAT_CONSTANT, constant->get_constant()->get_int());
+    }
+
+    void visit_binary_op(BinaryOpAst *bin) {
+        bin->get_lhs()->accept_expr_visitor(this);
+        bin->get_rhs()->accept_expr_visitor(this);
+        push(FLAT_BINARY_OP, bin->get_op());
+    }
+
+    bool is_valid() {
+        return _valid;
+    }
+
+  private:
+    void push(FlatExprType type, int value) {
+        _pattern.types.push_back(type);
+        _pattern.values.push_back(value);
+    }
+
+    const FlatAst&  _flat;
+    ExprPattern&    _pattern;
+    bool            _valid;
+};
+
+} // anonymous namespace
+
+ExprIndex::ExprIndex(const FlatAst& flat) : _flat(flat) {
+    std::vector<uint64_t> hashes;
+    std::vector<int> sizes;
+
+    for(int statement = 0; statement < flat.get_statement_count(); ++statement) {
+        int begin = flat.get_expr_begin(statement);
+        int end = flat.get_expr_end(statement);
+
+        for(int node = begin; node < end; ++node) {
+            int value = flat.get_expr_value(node);
+            FlatExprType type = flat.get_expr_type(node);
+
+            if(type == FLAT_BINARY_OP) {
+                uint64_t rhs = hashes.back();
+                int size = sizes.back() + 1;
+                hashes.pop_back();
+                sizes.pop_back();
+
+                hashes.back() = hash_binary_op(value, hashes.back(), rhs);
+                sizes.back() += size;
+            } else {
+                hashes.push_back(hash_leaf(type, value));
+                sizes.push_back(1);
+            }
+
+            _statement.push_back(statement);
+            _size.push_back(sizes.back());
+            _roots[hashes.back()].push_back(node);
+        }
+
+        hashes.clear();
+        sizes.clear();
+    }
+}
+
+bool ExprIndex::make_pattern(ExprAst *expr, ExprPattern& pattern) const {
+    PatternBuilder builder(_flat, pattern);
+    expr->accept_expr_visitor(&builder);
+    return builder.is_valid();
+}
+
+std::vector<int> ExprIndex::find_exact(const ExprPattern& pattern) const {
+    std::vector<int> result;
+    const std::vector<int> *roots = find_roots(pattern);
+    if(roots == NULL) {
+        return result;
+    }
+
+    for(size_t i = 0; i < roots->size(); ++i) {
+        int root = (*roots)[i];
+        int statement = _statement[root];
+
+        if(root == _flat.get_expr_end(statement) - 1 && matches(root, pattern)) {
+            result.push_back(statement);
+        }
+    }
+    return result;
+}
+
+std::vector<int> ExprIndex::find_subexpr(const ExprPattern& pattern) const {
+    std::vector<int> result;
+    const std::vector<int> *roots = find_roots(pattern);
+    if(roots == NULL) {
+        return result;
+    }
+
+    // the roots are in node order, so the statements are grouped
+    for(size_t i = 0; i < roots->size(); ++i) {
+        int root = (*roots)[i];
+        int statement = _statement[root];
+
+        if((result.empty() || result.back() != statement) && matches(root, pattern)) {
+            result.push_back(statement);
+        }
+    }
+    return result;
+}
+
+uint64_t ExprIndex::hash_leaf(int type, int value) {
+    return mix((static_cast<uint64_t>(type) << 32) ^ static_cast<uint32_t>(value));
+}
+
+uint64_t ExprIndex::hash_binary_op(int op, uint64_t lhs, uint64_t rhs) {
+    return mix(lhs * 0x9e3779b97f4a7c15ULL + mix(rhs ^ (static_cast<uint64_t>(op) << 56)));
+}
+
+uint64_t ExprIndex::hash_pattern(const ExprPattern& pattern) {
+    std::vector<uint64_t> hashes;
+
+    for(size_t node = 0; node < pattern.types.size(); ++node) {
+        if(pattern.types[node] == FLAT_BINARY_OP) {
+            uint64_t rhs = hashes.back();
+            hashes.pop_back();
+            hashes.back() = hash_binary_op(pattern.values[node], hashes.back(), rhs);
+        } else {
+            hashes.push_back(hash_leaf(pattern.types[node], pattern.values[node]));
+        }
+    }
+    return hashes.back();
+}
+
+/*
+ * The subtree of a root is the run of nodes of the same size that ends
+ * at the root.
+ */
+bool ExprIndex::matches(int root, const ExprPattern& pattern) const {
+    int size = pattern.types.size();
+    if(_size[root] != size) {
+        return false;
+    }
+
+    int first = root - size + 1;
+    for(int i = 0; i < size; ++i) {
+        if(_flat.get_expr_type(first + i) != pattern.types[i] ||
+                _flat.get_expr_value(first + i) != pattern.values[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<int>* ExprIndex::find_roots(const ExprPattern& pattern) const {
+    if(pattern.types.empty()) {
+        return NULL;
+    }
+
+    std::unordered_map< uint64_t, std::vector<int> >::const_iterator it =
+        _roots.find(hash_pattern(pattern));
+
+    if(it == _roots.end()) {
+        return NULL;
+    } else {
+        return &it->second;
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,88 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "simple/ast.h"
+#include "impl/flat_ast.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * An expression in the post-order form of the FlatAst node pool, with
+ * variables given by their flat variable numbers.
+ */
+struct ExprPattern {
+  public:
+    std::vector<unsigned char>  types;
+    std::vector<int>            values;
+};
+
+/*
+ * ExprIndex maps the hash of every subtree of the assignment
+ * expressions to the nodes at the root of that subtree.
+ *
+ * A subtree is the run of post-order nodes that ends at its root. Its
+ * hash is computed bottom-up from the hashes of its operands, with
+ * variables hashed by their number rather than by their AST node, so
+ * that equal subtrees anywhere in the program get the same hash. Every
+ * hit is verified by comparing the node runs, so hash collisions never
+ * produce a wrong match.
+ */
+class ExprIndex {
+  public:
+    ExprIndex(const FlatAst& flat);
+
+    /*
+     * Returns false if the expression uses a variable that does not
+     * occur in the program, in which case it matches nothing.
+     */
+    bool make_pattern(ExprAst *expr, ExprPattern& pattern) const;
+
+    /*
+     * The flat numbers of the assignments whose whole expression, or
+     * any subexpression, is the pattern. The numbers are increasing.
+     */
+    std::vector<int> find_exact(const ExprPattern& pattern) const;
+    std::vector<int> find_subexpr(const ExprPattern& pattern) const;
+
+  private:
+    static uint64_t hash_leaf(int type, int value);
+    static uint64_t hash_binary_op(int op, uint64_t lhs, uint64_t rhs);
+    static uint64_t hash_pattern(const ExprPattern& pattern);
+
+    bool matches(int root, const ExprPattern& pattern) const;
+    const std::vector<int>* find_roots(const ExprPattern& pattern) const;
+
+    const FlatAst&      _flat;
+
+    // indexed by expression node
+    std::vector<int>    _statement;
+    std::vector<int>    _size;
+
+    std::unordered_map< uint64_t, std::vector<int> >   _roots;
+};
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,244 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "impl/flat_ast.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+FlatAst::FlatAst(SimpleRoot ast) : _current(-1) {
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        _proc_index[*it] = _procs.size();
+        _procs.push_back(*it);
+    }
+
+    for(size_t p = 0; p < _procs.size(); ++p) {
+        _proc_offsets.push_back(_type.size());
+        index_statement_list(_procs[p]->get_statement(), -1);
+    }
+    _proc_offsets.push_back(_type.size());
+    _expr_offsets.push_back(_expr_type.size());
+
+    std::map<ProcAst*, int>().swap(_proc_index);
+}
+
+int FlatAst::get_statement_count() const {
+    return _type.size();
+}
+
+int FlatAst::get_proc_count() const {
+    return _procs.size();
+}
+
+int FlatAst::get_variable_count() const {
+    return _variables.size();
+}
+
+FlatStatementType FlatAst::get_type(int statement) const {
+    return static_cast<FlatStatementType>(_type[statement]);
+}
+
+int FlatAst::get_line(int statement) const {
+    return _line[statement];
+}
+
+int FlatAst::get_proc(int statement) const {
+    return _proc[statement];
+}
+
+int FlatAst::get_parent(int statement) const {
+    return _parent[statement];
+}
+
+int FlatAst::get_next(int statement) const {
+    return _next[statement];
+}
+
+int FlatAst::get_prev(int statement) const {
+    return _prev[statement];
+}
+
+int FlatAst::get_first_child(int statement) const {
+    return _first_child[statement];
+}
+
+int FlatAst::get_else_child(int statement) const {
+    return _else_child[statement];
+}
+
+int FlatAst::get_variable(int statement) const {
+    return _variable[statement];
+}
+
+int FlatAst::get_callee(int statement) const {
+    return _callee[statement];
+}
+
+int FlatAst::get_expr_begin(int statement) const {
+    return _expr_offsets[statement];
+}
+
+int FlatAst::get_expr_end(int statement) const {
+    return _expr_offsets[statement + 1];
+}
+
+FlatExprType FlatAst::get_expr_type(int node) const {
+    return static_cast<FlatExprType>(_expr_type[node]);
+}
+
+int FlatAst::get_expr_value(int node) const {
+    return _expr_value[node];
+}
+
+int FlatAst::get_proc_begin(int proc) const {
+    return _proc_offsets[proc];
+}
+
+int FlatAst::get_proc_end(int proc) const {
+    return _proc_offsets[proc + 1];
+}
+
+StatementAst* FlatAst::get_statement_ast(int statement) const {
+    return _statements[statement];
+}
+
+ProcAst* FlatAst::get_proc_ast(int proc) const {
+    return _procs[proc];
+}
+
+SimpleVariable* FlatAst::get_variable_ast(int variable) {
+    return &_variables[variable];
+}
+
+int FlatAst::find_variable(const std::string& name) const {
+    const Symbol *symbol = SymbolTable::find(name);
+    if(symbol == NULL || symbol->get_id() >= static_cast<int>(_variable_index.size())) {
+        return -1;
+    }
+    return _variable_index[symbol->get_id()];
+}
+
+/*
+ * Returns the number of the first statement in the list.
+ */
+int FlatAst::index_statement_list(StatementAst *statement, int parent) {
+    int first = _type.size();
+    int prev = -1;
+
+    for(; statement != NULL; statement = statement->next()) {
+        int index = _type.size();
+
+        _type.push_back(FLAT_ASSIGNMENT);
+        _line.push_back(statement->get_line());
+        _proc.push_back(_proc_offsets.size() - 1);
+        _parent.push_back(parent);
+        _next.push_back(-1);
+        _prev.push_back(prev);
+        _first_child.push_back(-1);
+        _else_child.push_back(-1);
+        _variable.push_back(-1);
+        _callee.push_back(-1);
+        _expr_offsets.push_back(_expr_type.size());
+        _statements.push_back(statement);
+
+        if(prev != -1) {
+            _next[prev] = index;
+        }
+        prev = index;
+
+        _current = index;
+        statement->accept_statement_visitor(this);
+    }
+
+    return prev == -1 ? -1 : first;
+}
+
+int FlatAst::index_variable(SimpleVariable *var) {
+    size_t symbol = var->get_symbol();
+    if(symbol >= _variable_index.size()) {
+        _variable_index.resize(symbol + 1, -1);
+    }
+
+    if(_variable_index[symbol] == -1) {
+        _variable_index[symbol] = _variables.size();
+        _variables.push_back(*var);
+    }
+    return _variable_index[symbol];
+}
+
+void FlatAst::visit_assignment(AssignmentAst *assign) {
+    int index = _current;
+    _type[index] = FLAT_ASSIGNMENT;
+    _variable[index] = index_variable(assign->get_variable());
+
+    if(assign->get_expr() != NULL) {
+        assign->get_expr()->accept_expr_visitor(this);
+    }
+}
+
+void FlatAst::visit_conditional(ConditionalAst *condition) {
+    int index = _current;
+    _type[index] = FLAT_CONDITIONAL;
+    _variable[index] = index_variable(condition->get_variable());
+
+    int then_child = index_statement_list(condition->get_then_branch(), index);
+    int else_child = index_statement_list(condition->get_else_branch(), index);
+    _first_child[index] = then_child;
+    _else_child[index] = else_child;
+}
+
+void FlatAst::visit_while(WhileAst *loop) {
+    int index = _current;
+    _type[index] = FLAT_WHILE;
+    _variable[index] = index_variable(loop->get_variable());
+
+    int body = index_statement_list(loop->get_body(), index);
+    _first_child[index] = body;
+}
+
+void FlatAst::visit_call(CallAst *call) {
+    int index = _current;
+    _type[index] = FLAT_CALL;
+
+    std::map<ProcAst*, int>::iterator it = 
+        _proc_index.find(call->get_proc_called());
+    _callee[index] = (it == _proc_index.end()) ? -1 : it->second;
+}
+
+void FlatAst::visit_variable(VariableAst *var) {
+    _expr_type.push_back(FLAT_VARIABLE);
+    _expr_value.push_back(index_variable(var->get_variable()));
+}
+
+void FlatAst::visit_const(ConstAst *constant) {
+    _expr_type.push_back(FLAT_CONSTANT);
+    _expr_value.push_back(constant->get_constant()->get_int());
+}
+
+void FlatAst::visit_binary_op(BinaryOpAst *bin) {
+    bin->get_lhs()->accept_expr_visitor(this);
+    bin->get_rhs()->accept_expr_visitor(this);
+
+    _expr_type.push_back(FLAT_BINARY_OP);
+    _expr_value.push_back(bin->get_op());
+}
+
+} // namespace impl
+} // namespace simple
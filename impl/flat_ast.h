@@ -0,0 +1,162 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "simple/ast.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+enum FlatStatementType {
+    FLAT_ASSIGNMENT,
+    FLAT_CONDITIONAL,
+    FLAT_WHILE,
+    FLAT_CALL
+};
+
+enum FlatExprType {
+    FLAT_VARIABLE,
+    FLAT_CONSTANT,
+    FLAT_BINARY_OP
+};
+
+/*
+ * FlatAst lays the program out in parallel arrays, so that passes over
+ * the whole program read contiguous memory instead of following the
+ * pointers between AST nodes.
+ *
+ * Statements are numbered in pre-order, procedure by procedure in the
+ * order of the SimpleRoot. The statements of a procedure are therefore
+ * contiguous and every container comes right before its children.
+ * Missing links are -1.
+ *
+ * The expression of each assignment is stored in post-order in a
+ * shared node pool. Variables are numbered by first occurrence.
+ */
+class FlatAst : public StatementVisitor, public ExprVisitor {
+  public:
+    FlatAst(SimpleRoot ast);
+
+    int get_statement_count() const;
+    int get_proc_count() const;
+    int get_variable_count() const;
+
+    FlatStatementType get_type(int statement) const;
+    int get_line(int statement) const;
+    int get_proc(int statement) const;
+    int get_parent(int statement) const;
+    int get_next(int statement) const;
+    int get_prev(int statement) const;
+
+    /*
+     * The first child is the first statement of a then branch or a
+     * loop body, the else child is the first statement of an else
+     * branch.
+     */
+    int get_first_child(int statement) const;
+    int get_else_child(int statement) const;
+
+    /*
+     * The variable modified by an assignment, or the control variable
+     * of a container.
+     */
+    int get_variable(int statement) const;
+    int get_callee(int statement) const;
+
+    /*
+     * The post-order expression nodes of an assignment are found from
+     * get_expr_begin() up to get_expr_end() - 1.
+     */
+    int get_expr_begin(int statement) const;
+    int get_expr_end(int statement) const;
+    FlatExprType get_expr_type(int node) const;
+
+    /*
+     * The variable number, constant value or operator character of an
+     * expression node.
+     */
+    int get_expr_value(int node) const;
+
+    /*
+     * The statements of a procedure are numbered from get_proc_begin()
+     * up to get_proc_end() - 1.
+     */
+    int get_proc_begin(int proc) const;
+    int get_proc_end(int proc) const;
+
+    /*
+     * The AST nodes stay the public view of the program.
+     */
+    StatementAst* get_statement_ast(int statement) const;
+    ProcAst* get_proc_ast(int proc) const;
+    SimpleVariable* get_variable_ast(int variable);
+
+    int find_variable(const std::string& name) const;
+
+    void visit_assignment(AssignmentAst *assign);
+    void visit_conditional(ConditionalAst *condition);
+    void visit_while(WhileAst *loop);
+    void visit_call(CallAst *call);
+
+    void visit_variable(VariableAst *var);
+    void visit_const(ConstAst *constant);
+    void visit_binary_op(BinaryOpAst *bin);
+
+  private:
+    int index_statement_list(StatementAst *statement, int parent);
+    int index_variable(SimpleVariable *var);
+
+    std::vector<unsigned char>  _type;
+    std::vector<int>            _line;
+    std::vector<int>            _proc;
+    std::vector<int>            _parent;
+    std::vector<int>            _next;
+    std::vector<int>            _prev;
+    std::vector<int>            _first_child;
+    std::vector<int>            _else_child;
+    std::vector<int>            _variable;
+    std::vector<int>            _callee;
+    std::vector<int>            _expr_offsets;
+    std::vector<StatementAst*>  _statements;
+
+    std::vector<unsigned char>  _expr_type;
+    std::vector<int>            _expr_value;
+
+    std::vector<ProcAst*>       _procs;
+    std::vector<int>            _proc_offsets;
+
+    std::vector<SimpleVariable> _variables;
+
+    // indexed by symbol
+    std::vector<int>            _variable_index;
+
+    /*
+     * Only used while the arrays are being built.
+     */
+    std::map<ProcAst*, int>     _proc_index;
+    int                         _current;
+};
+
+} // namespace impl
+} // namespace simple
@@ -32,6 +32,8 @@
 #include "impl/solvers/next.h"
 #include "impl/solvers/inext.h"
 #include "impl/solvers/same_name.h"
+#include "impl/solvers/pattern.h"
+#include "impl/solvers/with.h"
 
 #include "simple/util/solver_generator.h"
 #include "simple/util/query_utils.h"
@@ -40,10 +42,19 @@
 #include "impl/parser/parser.h"
 #include "impl/parser/pql_parser.h"
 #include "impl/parser/iterator_tokenizer.h"
+#include "impl/parser/buffer_tokenizer.h"
 
+#include "impl/condition_table.h"
+#include "impl/pkb.h"
 #include "impl/predicate.h"
 #include "impl/linker.h"
+#include "impl/result_table.h"
+#include "impl/result_writer.h"
 #include "impl/processor.h"
+#include "impl/planner.h"
+#include "impl/budget.h"
+#include "impl/program_snapshot.h"
+#include "impl/incremental.h"
 
 namespace simple {
 namespace impl {
@@ -52,44 +63,141 @@ using namespace simple;
 using namespace simple::util;
 using namespace simple::parser;
 
+enum QueryStatus {
+    QUERY_OK,
+    QUERY_ERROR,
+    QUERY_TIMEOUT
+};
+
+/*
+ * The columnar linker joins result tables and is the default. The
+ * simple linker keeps the links of each condition instead.
+ */
+enum LinkerMode {
+    LINKER_COLUMNAR,
+    LINKER_SIMPLE
+};
+
 class SimplePqlFrontEnd {
   public:
     template <typename Iterator>
-    SimplePqlFrontEnd(Iterator begin, Iterator end)
+    SimplePqlFrontEnd(Iterator begin, Iterator end) :
+        _linker_mode(LINKER_COLUMNAR)
     {
         parse_source(begin, end);
+        _condition_table.reset(new SimpleConditionTable(_ast));
+        _pkb.reset(new SimplePkb(_ast, _condition_table));
         populate_solvers();
         populate_predicates();
+        populate_statistics();
+    }
+
+    /*
+     * Builds the program from a source that can be edited later on
+     * with update_source().
+     */
+    SimplePqlFrontEnd(const std::string& source) :
+        _program(new IncrementalProgram()), _linker_mode(LINKER_COLUMNAR)
+    {
+        apply_update(_program->update(source));
+    }
+
+    /*
+     * Loads the program and its PKB from a snapshot instead of parsing
+     * the source. Throws a SnapshotError if the snapshot is unusable.
+     */
+    SimplePqlFrontEnd(ProgramSnapshot& snapshot) :
+        _linker_mode(LINKER_COLUMNAR)
+    {
+        _ast = snapshot.load_program(_line_table);
+        _condition_table.reset(new SimpleConditionTable(_ast));
+        _pkb = snapshot.load_pkb(_ast, _condition_table);
+        populate_solvers();
+        populate_predicates();
+        populate_statistics();
+    }
+
+    /*
+     * Applies an edited source. Only the edited procedures are parsed
+     * again, and the relations of procedures that neither changed nor
+     * call a changed procedure are copied from the current PKB. No
+     * query may run during an update.
+     */
+    void update_source(const std::string& source) {
+        if(!_program) {
+            _program.reset(new IncrementalProgram());
+        }
+        apply_update(_program->update(source));
+    }
+
+    void set_linker_mode(LinkerMode mode) {
+        _linker_mode = mode;
+    }
+
+    void save_snapshot(const std::string& path, uint64_t source_checksum) {
+        ProgramSnapshot::save(path, source_checksum, _ast, *_pkb);
+    }
+
+    template <typename Iterator, typename OutputIterator>
+    QueryStatus process_query(Iterator begin, Iterator end, OutputIterator out)
+    {
+        return process_query(begin, end, out, QueryBudgetPtr());
     }
 
+    /*
+     * A query that runs out of its budget prints "Timeout" in place
+     * of the result.
+     */
     template <typename Iterator, typename OutputIterator>
-    void process_query(Iterator begin, Iterator end, OutputIterator out)
+    QueryStatus process_query(Iterator begin, Iterator end, OutputIterator out,
+            const QueryBudgetPtr& budget)
     {
         try {
-            std::shared_ptr<QueryLinker> linker(new SimpleQueryLinker());
+            std::shared_ptr<QueryLinker> linker = make_linker(budget);
 
             SimplePqlParser parser(std::shared_ptr<SimpleTokenizer>(
                     new IteratorTokenizer<Iterator>(begin, end)),
-                    _ast, _line_table, _solver_table, _pred_table);
+                    _ast, _line_table, _solver_table, _pred_table,
+                    _pkb, _attribute_index);
 
             PqlQuerySet query = parser.parse_query();
 
             QueryProcessor processor(linker, query.predicates, _wildcard_pred);
+            processor.set_budget(budget);
 
-            for(ClauseSet::iterator it = query.clauses.begin();
-                it != query.clauses.end(); ++it)
-            {
-                processor.solve_clause(it->get());
-            }
+            RelationStatistics statistics(_statistics);
+            statistics.insert(parser.get_statistics().begin(),
+                    parser.get_statistics().end());
+
+            SimpleQueryPlanner planner(statistics);
+            QueryPlan plan = planner.plan(query.clauses);
+            solve_plan(plan, get_selected_qvars(query), processor, linker.get());
 
             format_selected(linker.get(), query, out);
+        } catch(QueryTimeoutError& e) {
+            print("Timeout", out);
+            return QUERY_TIMEOUT;
         } catch(std::exception& e) {
             print("Internal error: ", out);
             print(e.what(), out);
+            return QUERY_ERROR;
         }
+        return QUERY_OK;
     }
   
   protected:
+    std::shared_ptr<QueryLinker> make_linker(const QueryBudgetPtr& budget) {
+        if(_linker_mode == LINKER_SIMPLE) {
+            std::shared_ptr<SimpleQueryLinker> linker(new SimpleQueryLinker());
+            linker->set_budget(budget);
+            return linker;
+        } else {
+            std::shared_ptr<ColumnarQueryLinker> linker(new ColumnarQueryLinker());
+            linker->set_budget(budget);
+            return linker;
+        }
+    }
+
     template <typename OutputIterator>
     void print(const std::string& message, OutputIterator& out) {
         std::copy(message.begin(), message.end(), out);
@@ -105,53 +213,208 @@ class SimplePqlFrontEnd {
         _line_table = parser.get_line_table();
     }
 
+    /*
+     * A contiguous source is scanned directly from memory.
+     */
+    void parse_source(const char *begin, const char *end) {
+        SimpleParser parser(new BufferTokenizer(begin, end));
+
+        _ast = parser.parse_program();
+        _line_table = parser.get_line_table();
+    }
+
+    void apply_update(const ProgramUpdate& update) {
+        ConditionTablePtr table(new SimpleConditionTable(update.ast));
+
+        if(_pkb && !update.reused.empty()) {
+            _pkb.reset(new SimplePkb(update.ast, table, *_pkb, update.reused));
+        } else {
+            _pkb.reset(new SimplePkb(update.ast, table));
+        }
+
+        _ast = update.ast;
+        _line_table = update.line_table;
+        _condition_table = table;
+
+        _solver_table.clear();
+        _pred_table.clear();
+        _statistics.clear();
+        populate_solvers();
+        populate_predicates();
+        populate_statistics();
+    }
+
     void populate_solvers() {
-        _solver_table["follows"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<FollowSolver>(new FollowSolver(_ast)));
+        _attribute_index.reset(new AttributeIndex(_condition_table));
+
+        /*
+         * A transitive closure has the same domain and range as the
+         * relation it is built from.
+         */
+        _solver_table["follows"] = make_relation_solver(
+                new FollowSolver(_ast, _pkb), _pkb->get_follows());
 
-        _solver_table["ifollows"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<IFollowSolver>(new IFollowSolver(_ast)));
+        _solver_table["ifollows"] = make_relation_solver(
+                new IFollowSolver(_ast, _pkb), _pkb->get_follows());
 
-        _solver_table["parent"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<ParentSolver>(new ParentSolver(_ast)));
+        _solver_table["parent"] = make_relation_solver(
+                new ParentSolver(_ast, _pkb), _pkb->get_parent());
 
-        _solver_table["iparent"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<IParentSolver>(new IParentSolver(_ast)));
+        _solver_table["iparent"] = make_relation_solver(
+                new IParentSolver(_ast, _pkb), _pkb->get_parent());
 
-        _solver_table["call"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<CallSolver>(new CallSolver(_ast)));
+        _solver_table["call"] = make_relation_solver(
+                new CallSolver(_ast, _pkb), _pkb->get_calls());
 
-        _solver_table["icall"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<ICallSolver>(new ICallSolver(_ast)));
+        _solver_table["icall"] = make_relation_solver(
+                new ICallSolver(_ast, _pkb), _pkb->get_calls());
 
-        _solver_table["modifies"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<ModifiesSolver>(new ModifiesSolver(_ast)));
+        _solver_table["modifies"] = make_relation_solver(
+                new ModifiesSolver(_ast, _pkb), _pkb->get_modifies());
 
-        _solver_table["uses"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<UsesSolver>(new UsesSolver(_ast)));
+        _solver_table["uses"] = make_relation_solver(
+                new UsesSolver(_ast, _pkb), _pkb->get_uses());
         
-        std::shared_ptr<NextSolver> next_solver(new NextSolver(_ast));
+        std::shared_ptr<NextSolver> next_solver(new NextSolver(_ast, _pkb));
+
+        std::shared_ptr<INextSolver> inext_solver(new INextSolver(
+                _ast, next_solver));
 
-        std::shared_ptr<INextSolver> inext_solver(new INextSolver(_ast, next_solver));
+        const RelationTable& next = _pkb->get_cfg().get_next();
 
         _solver_table["next"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<NextSolver>(next_solver));
+            new SimpleSolverGenerator<NextSolver>(next_solver,
+                next.get_domain(), next.get_range()));
         _solver_table["inext"] = std::shared_ptr<QuerySolver>(
-            new SimpleSolverGenerator<INextSolver>(inext_solver));
+            new SimpleSolverGenerator<INextSolver>(inext_solver,
+                next.get_domain(), next.get_range()));
+    }
+
+    template <typename Solver>
+    std::shared_ptr<QuerySolver> make_relation_solver(Solver *solver,
+            const RelationTable& relation)
+    {
+        return std::shared_ptr<QuerySolver>(new SimpleSolverGenerator<Solver>(
+                    std::shared_ptr<Solver>(solver),
+                    relation.get_domain(), relation.get_range()));
     }
 
     void populate_predicates() {
-        _wildcard_pred = PredicatePtr(new SimpleWildCardPredicate(_ast));
+        _wildcard_pred = PredicatePtr(new SimpleWildCardPredicate(_ast, _condition_table));
 
         _pred_table["wildcard"] = _wildcard_pred;
-        _pred_table["procedure"] = PredicatePtr(new SimpleProcPredicate(_ast));
-        _pred_table["statement"] = PredicatePtr(new SimpleStatementPredicate(_ast));
-        _pred_table["assign"] = PredicatePtr(new SimpleAssignmentPredicate(_ast));
-        _pred_table["while"] = PredicatePtr(new SimpleWhilePredicate(_ast));
-        _pred_table["if"] = PredicatePtr(new SimpleConditionalPredicate(_ast));
-        _pred_table["call"] = PredicatePtr(new SimpleCallPredicate(_ast));
-        _pred_table["var"] = PredicatePtr(new SimpleVariablePredicate(_ast));
-        _pred_table["const"] = PredicatePtr(new SimpleConstantPredicate(_ast));
+        _pred_table["procedure"] = PredicatePtr(new SimpleProcPredicate(_ast, _condition_table));
+        _pred_table["statement"] = PredicatePtr(new SimpleStatementPredicate(_ast, _condition_table));
+        _pred_table["assign"] = PredicatePtr(new SimpleAssignmentPredicate(_ast, _condition_table));
+        _pred_table["while"] = PredicatePtr(new SimpleWhilePredicate(_ast, _condition_table));
+        _pred_table["if"] = PredicatePtr(new SimpleConditionalPredicate(_ast, _condition_table));
+        _pred_table["call"] = PredicatePtr(new SimpleCallPredicate(_ast, _condition_table));
+        _pred_table["var"] = PredicatePtr(new SimpleVariablePredicate(_ast, _condition_table));
+        _pred_table["const"] = PredicatePtr(new SimpleConstantPredicate(_ast, _condition_table));
+    }
+
+    /*
+     * Groups that have no selected query variable only need to be
+     * satisfiable, so they are checked for a single solution instead
+     * of being materialized in the linker. Evaluation stops as soon as
+     * the linker becomes invalid.
+     */
+    void solve_plan(QueryPlan& plan, const std::set<std::string>& selected,
+            QueryProcessor& processor, QueryLinker *linker)
+    {
+        QueryBudgetPtr budget = processor.get_budget();
+
+        for(QueryPlan::iterator group = plan.begin(); 
+                group != plan.end() && linker->is_valid_state(); ++group)
+        {
+            if(budget) {
+                budget->check_now();
+            }
+            if(!has_selected_qvar(*group, selected)) {
+                if(!processor.has_solution(group->clauses)) {
+                    linker->invalidate_state();
+                }
+                continue;
+            }
+
+            for(ClauseList::iterator it = group->clauses.begin();
+                    it != group->clauses.end() && linker->is_valid_state(); 
+                    ++it)
+            {
+                processor.solve_clause(it->get());
+                drop_unused_qvars(*group, it + 1, selected, linker);
+            }
+        }
+    }
+
+    /*
+     * Query variables that are not selected and not used by the rest of
+     * the group are projected out of the result tables.
+     */
+    void drop_unused_qvars(const ClauseGroup& group, ClauseList::const_iterator next,
+            const std::set<std::string>& selected, QueryLinker *linker)
+    {
+        std::set<std::string> used(selected);
+        for(; next != group.clauses.end(); ++next) {
+            PqlTermInfo left((*next)->get_left_term());
+            PqlTermInfo right((*next)->get_right_term());
+
+            if(left.is_qvar()) {
+                used.insert(left.get_qvar());
+            }
+            if(right.is_qvar()) {
+                used.insert(right.get_qvar());
+            }
+        }
+
+        for(std::set<std::string>::const_iterator it = group.qvars.begin();
+                it != group.qvars.end(); ++it)
+        {
+            if(used.count(*it) == 0) {
+                linker->drop_qvar(*it);
+            }
+        }
+    }
+
+    std::set<std::string> get_selected_qvars(PqlQuerySet& query) {
+        std::set<std::string> result;
+        PqlSelector *selector = query.selector.get();
+
+        if(is_selector<PqlSingleVarSelector>(selector)) {
+            result.insert(selector_cast<PqlSingleVarSelector>(
+                        selector)->get_qvar_name());
+        } else if(is_selector<PqlTupleSelector>(selector)) {
+            std::vector<std::string> tuples = selector_cast<
+                PqlTupleSelector>(selector)->get_tuples();
+            result.insert(tuples.begin(), tuples.end());
+        }
+        return result;
+    }
+
+    bool has_selected_qvar(const ClauseGroup& group, 
+            const std::set<std::string>& selected) 
+    {
+        for(std::set<std::string>::const_iterator it = group.qvars.begin();
+                it != group.qvars.end(); ++it)
+        {
+            if(selected.count(*it) > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void populate_statistics() {
+        _statistics[_solver_table["follows"].get()] = _pkb->get_follows().get_size();
+        _statistics[_solver_table["ifollows"].get()] = _pkb->get_ifollows().get_size();
+        _statistics[_solver_table["parent"].get()] = _pkb->get_parent().get_size();
+        _statistics[_solver_table["iparent"].get()] = _pkb->get_iparent().get_size();
+        _statistics[_solver_table["call"].get()] = _pkb->get_calls().get_size();
+        _statistics[_solver_table["icall"].get()] = _pkb->get_icalls().get_size();
+        _statistics[_solver_table["modifies"].get()] = _pkb->get_modifies().get_size();
+        _statistics[_solver_table["uses"].get()] = _pkb->get_uses().get_size();
+        _statistics[_solver_table["next"].get()] = _pkb->get_cfg().get_next().get_size();
+        _statistics[_solver_table["inext"].get()] = _pkb->get_cfg().get_inext_size();
     }
 
     template <typename OutputIterator>
@@ -159,13 +422,10 @@ class SimplePqlFrontEnd {
                 OutputIterator& out) 
     {
         PqlSelector *selector = query.selector.get();
+        ResultWriter<OutputIterator> writer(out);
 
         if(is_selector<PqlBooleanSelector>(selector)) {
-            if(linker->is_valid_state()) {
-                print("true", out);
-            } else {
-                print("false", out);
-            }
+            writer.write(linker->is_valid_state() ? "true" : "false");
         } else if(is_selector<PqlSingleVarSelector>(selector)) {
             PqlSingleVarSelector *var_selector = selector_cast<
                             PqlSingleVarSelector>(selector);
@@ -179,29 +439,60 @@ class SimplePqlFrontEnd {
                 pred = _wildcard_pred.get();
             }
 
-            ConditionSet conditions = linker->get_conditions(qvar, pred);
-            print(qvar, out);
-            print(" = ", out);
+            // an invalid linker has no result even for unconstrained qvars
+            ConditionSet conditions;
+            if(linker->is_valid_state()) {
+                conditions = linker->get_conditions(qvar, pred);
+            }
+
+            writer.write(qvar);
+            writer.write(" = ");
+            writer.write_elements(conditions);
+        } else if(is_selector<PqlTupleSelector>(selector)) {
+            std::vector<std::string> qvars = selector_cast<
+                            PqlTupleSelector>(selector)->get_tuples();
+
+            writer.write("<");
+            for(size_t i = 0; i < qvars.size(); ++i) {
+                if(i != 0) {
+                    writer.write(", ");
+                }
+                writer.write(qvars[i]);
+            }
+            writer.write("> = ");
 
-            for(ConditionSet::iterator it = conditions.begin(); 
-                    it != conditions.end();)
-            {
-                print(condition_to_string(*it), out);
-                if(++it != conditions.end()) {
-                    print(", ", out);
+            if(linker->is_valid_state()) {
+                // selected qvars that no clause mentions are not in the linker yet
+                for(size_t i = 0; i < qvars.size(); ++i) {
+                    SimplePredicate *pred;
+                    if(query.predicates.count(qvars[i]) > 0) {
+                        pred = query.predicates[qvars[i]].get();
+                    } else {
+                        pred = _wildcard_pred.get();
+                    }
+                    linker->ensure_initialized(qvars[i], pred);
                 }
+
+                TupleWriter<OutputIterator> visitor(writer);
+                linker->enumerate_tuples(qvars, &visitor);
             }
         } else {
-            print("Not implemented", out);
+            writer.write("Not implemented");
         }
     }
 
   private:
     SimpleRoot      _ast;
+    ConditionTablePtr _condition_table;
+    PkbPtr          _pkb;
+    AttributeIndexPtr _attribute_index;
     SolverTable     _solver_table;
     PredicateTable  _pred_table;
     LineTable       _line_table;
     PredicatePtr    _wildcard_pred;
+    RelationStatistics _statistics;
+    std::unique_ptr<IncrementalProgram> _program;
+    LinkerMode      _linker_mode;
 };
 
 }
@@ -0,0 +1,278 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cctype>
+#include "impl/incremental.h"
+#include "impl/parser/parser.h"
+#include "impl/parser/buffer_tokenizer.h"
+#include "impl/parallel.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple::parser;
+
+namespace {
+
+bool is_new_line(const std::string& source, size_t i) {
+    return source[i] == '\n' ||
+        (source[i] == '\r' && (i + 1 == source.size() || source[i + 1] != '\n'));
+}
+
+void collect_callees(StatementAst *statement, std::set<std::string>& callees) {
+    for(; statement != NULL; statement = statement->next()) {
+        if(CallAst *call = dynamic_cast<CallAst*>(statement)) {
+            callees.insert(call->get_proc_called()->get_name());
+        } else if(ConditionalAst *condition = dynamic_cast<ConditionalAst*>(statement)) {
+            collect_callees(condition->get_then_branch(), callees);
+            collect_callees(condition->get_else_branch(), callees);
+        } else if(WhileAst *loop = dynamic_cast<WhileAst*>(statement)) {
+            collect_callees(loop->get_body(), callees);
+        }
+    }
+}
+
+void index_lines(StatementAst *statement, int shift, LineTable& line_table) {
+    for(; statement != NULL; statement = statement->next()) {
+        if(shift != 0) {
+            SimpleStatementAst *simple_statement = 
+                dynamic_cast<SimpleStatementAst*>(statement);
+            simple_statement->set_line(statement->get_line() + shift);
+        }
+        line_table[statement->get_line()] = statement;
+
+        if(ConditionalAst *condition = dynamic_cast<ConditionalAst*>(statement)) {
+            index_lines(condition->get_then_branch(), shift, line_table);
+            index_lines(condition->get_else_branch(), shift, line_table);
+        } else if(WhileAst *loop = dynamic_cast<WhileAst*>(statement)) {
+            index_lines(loop->get_body(), shift, line_table);
+        }
+    }
+}
+
+}
+
+IncrementalProgram::IncrementalProgram(size_t threads) :
+    _procs(), _threads(threads)
+{ }
+
+/*
+ * Cuts the source into one piece per procedure by matching braces.
+ * The parser does not count the procedure declaration as a line, so
+ * the n-th procedure starts n - 1 lines before its physical line.
+ */
+std::vector<IncrementalProgram::ProcChunk> IncrementalProgram::split_source(
+        const std::string& source)
+{
+    std::vector<ProcChunk> chunks;
+    int line = 1;
+    size_t i = 0;
+
+    while(true) {
+        for(; i < source.size() && isspace(source[i]); ++i) {
+            if(is_new_line(source, i)) {
+                ++line;
+            }
+        }
+        if(i == source.size()) {
+            break;
+        }
+
+        if(source.compare(i, 4, "proc") != 0 || i + 4 >= source.size() ||
+           !isspace(source[i + 4])) 
+        {
+            throw ParserError();
+        }
+
+        ProcChunk chunk;
+        chunk.line = line - chunks.size();
+        size_t start = i;
+
+        for(i += 4; i < source.size() && isspace(source[i]); ++i) {
+            if(is_new_line(source, i)) {
+                ++line;
+            }
+        }
+        // procedure names follow the identifier rule of the tokenizer
+        for(; i < source.size() && (isalnum(source[i]) || source[i] == '_'); ++i) {
+            chunk.name += source[i];
+        }
+
+        int depth = 0;
+        bool opened = false;
+        for(; i < source.size() && !(opened && depth == 0); ++i) {
+            if(source[i] == '{') {
+                ++depth;
+                opened = true;
+            } else if(source[i] == '}') {
+                --depth;
+            } else if(is_new_line(source, i)) {
+                ++line;
+            }
+        }
+
+        if(chunk.name.empty() || depth != 0 || !opened) {
+            throw ParserError();
+        }
+
+        chunk.text = source.substr(start, i - start);
+        chunks.push_back(chunk);
+    }
+
+    return chunks;
+}
+
+ProgramUpdate IncrementalProgram::update(const std::string& source) {
+    std::vector<ProcChunk> chunks = split_source(source);
+
+    std::map<std::string, SimpleProcAst*> proc_table;
+    std::map<std::string, std::shared_ptr<SimpleProcAst> > procs;
+
+    for(size_t i = 0; i < chunks.size(); ++i) {
+        const std::string& name = chunks[i].name;
+        if(procs.count(name) != 0) {
+            throw ParserError();
+        }
+
+        ProcSourceTable::iterator it = _procs.find(name);
+        if(it != _procs.end()) {
+            procs[name] = it->second.proc;
+        } else {
+            procs[name].reset(new SimpleProcAst(name));
+        }
+        proc_table[name] = procs[name].get();
+    }
+
+    /*
+     * The old bodies of the changed procedures are kept until all of
+     * them are parsed, so that the previous program can be restored.
+     */
+    std::vector< std::pair<SimpleProcAst*, StatementAst*> > replaced;
+    std::vector<size_t> changed_chunks;
+    std::vector< std::set<std::string> > changed_callees;
+    ProgramUpdate result;
+
+    try {
+        for(size_t i = 0; i < chunks.size(); ++i) {
+            const ProcChunk& chunk = chunks[i];
+            ProcSourceTable::iterator it = _procs.find(chunk.name);
+
+            if(it != _procs.end() && it->second.text == chunk.text) {
+                std::set<std::string>& callees = it->second.callees;
+                for(std::set<std::string>::iterator callee = callees.begin();
+                        callee != callees.end(); ++callee)
+                {
+                    if(proc_table.count(*callee) == 0) {
+                        throw ParserError();
+                    }
+                }
+                continue;
+            }
+
+            SimpleProcAst *proc = proc_table[chunk.name];
+            replaced.push_back(std::make_pair(proc, proc->release_statement()));
+            result.changed.insert(chunk.name);
+            changed_chunks.push_back(i);
+        }
+
+        // each procedure is parsed on its own, so they are parsed in parallel
+        changed_callees.resize(changed_chunks.size());
+        parallel_for(changed_chunks.size(), _threads, [&](size_t k) {
+            const ProcChunk& chunk = chunks[changed_chunks[k]];
+
+            SimpleParser parser(
+                new BufferTokenizer(chunk.text.data(), 
+                    chunk.text.data() + chunk.text.size()),
+                chunk.line, proc_table);
+            SimpleProcAst *proc = parser.parse_proc_fragment();
+            collect_callees(proc->get_statement(), changed_callees[k]);
+        });
+    } catch(...) {
+        for(size_t i = replaced.size(); i > 0; --i) {
+            SimpleProcAst *proc = replaced[i - 1].first;
+            delete proc->release_statement();
+            if(replaced[i - 1].second != NULL) {
+                proc->set_first_statement(replaced[i - 1].second);
+            }
+        }
+        throw;
+    }
+
+    for(size_t i = 0; i < replaced.size(); ++i) {
+        delete replaced[i].second;
+    }
+
+    ProcSourceTable next;
+    std::map<std::string, std::set<std::string> > callers;
+
+    for(size_t i = 0, k = 0; i < chunks.size(); ++i) {
+        const ProcChunk& chunk = chunks[i];
+        ProcSource& proc_source = next[chunk.name];
+        proc_source.text = chunk.text;
+        proc_source.line = chunk.line;
+        proc_source.proc = procs[chunk.name];
+
+        int shift = 0;
+        if(k < changed_chunks.size() && changed_chunks[k] == i) {
+            proc_source.callees.swap(changed_callees[k++]);
+        } else {
+            ProcSource& old_source = _procs[chunk.name];
+            proc_source.callees.swap(old_source.callees);
+            shift = chunk.line - old_source.line;
+        }
+        index_lines(proc_source.proc->get_statement(), shift, 
+                result.line_table);
+
+        for(std::set<std::string>::iterator it = proc_source.callees.begin();
+                it != proc_source.callees.end(); ++it)
+        {
+            callers[*it].insert(chunk.name);
+        }
+    }
+
+    // callers of a changed procedure modify and use other variables now
+    std::set<std::string> affected(result.changed);
+    std::vector<std::string> pending(affected.begin(), affected.end());
+    while(!pending.empty()) {
+        std::set<std::string>& proc_callers = callers[pending.back()];
+        pending.pop_back();
+
+        for(std::set<std::string>::iterator it = proc_callers.begin();
+                it != proc_callers.end(); ++it)
+        {
+            if(affected.insert(*it).second) {
+                pending.push_back(*it);
+            }
+        }
+    }
+
+    SimpleRoot::ProcListType *proc_list = new SimpleRoot::ProcListType();
+    for(ProcSourceTable::iterator it = next.begin(); it != next.end(); ++it) {
+        (*proc_list)[it->first] = it->second.proc;
+        if(affected.count(it->first) == 0) {
+            result.reused.insert(it->second.proc.get());
+        }
+    }
+
+    result.ast = SimpleRoot(proc_list);
+    _procs.swap(next);
+    return result;
+}
+
+} // namespace impl
+} // namespace simple
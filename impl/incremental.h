@@ -0,0 +1,97 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <set>
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include "simple/ast.h"
+#include "impl/ast.h"
+#include "impl/parallel.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * The program after an edit. The reused procedures neither changed
+ * nor call a changed procedure, so their relations can be kept from
+ * the analysis of the previous version.
+ */
+class ProgramUpdate {
+  public:
+    SimpleRoot              ast;
+    LineTable               line_table;
+    std::set<std::string>   changed;
+    std::set<ProcAst*>      reused;
+};
+
+/*
+ * IncrementalProgram keeps the source of every procedure it parsed, so
+ * that an edited source only needs its changed procedures parsed again.
+ * Unchanged procedures keep their AST nodes, and only have their line
+ * numbers moved when the code above them grew or shrank.
+ *
+ * Procedure nodes are never replaced, so call statements in unchanged
+ * procedures still refer to the right procedures. An update therefore
+ * modifies the AST returned by the previous update.
+ */
+class IncrementalProgram {
+  public:
+    /*
+     * The changed procedures are parsed on up to the given number of
+     * threads.
+     */
+    IncrementalProgram(size_t threads = default_thread_count());
+
+    /*
+     * Throws a ParserError and keeps the previous program if the new
+     * source is invalid.
+     */
+    ProgramUpdate update(const std::string& source);
+
+  private:
+    class ProcChunk {
+      public:
+        std::string name;
+        std::string text;
+        int         line;
+    };
+
+    class ProcSource {
+      public:
+        std::string             text;
+        int                     line;
+        std::set<std::string>   callees;
+        std::shared_ptr<SimpleProcAst> proc;
+    };
+
+    typedef std::map<std::string, ProcSource> ProcSourceTable;
+
+    static std::vector<ProcChunk> split_source(const std::string& source);
+
+    ProcSourceTable _procs;
+    size_t          _threads;
+};
+
+} // namespace impl
+} // namespace simple
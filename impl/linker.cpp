@@ -16,6 +16,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include "impl/linker.h"
 
 namespace simple {
@@ -37,6 +38,7 @@ void SimpleQueryLinker::update_links(
     for(std::vector<ConditionPair>::const_iterator it = links.begin();
         it != links.end(); ++it) 
     {
+        check_budget(_budget);
         if(add_link(qvar1, qvar2, it->first, it->second)) {
             new_set1.insert(it->first);
             new_set2.insert(it->second);
@@ -45,9 +47,68 @@ void SimpleQueryLinker::update_links(
 
     update_results(qvar1, new_set1);
     update_results(qvar2, new_set2);
+}
+
+/*
+ * A rejected pair is dropped from the partners on both sides, and a
+ * condition that is left without a partner is removed like any other.
+ */
+bool SimpleQueryLinker::filter_links(
+        const std::string& qvar1, const std::string& qvar2,
+        LinkFilter *filter)
+{
+    size_t index1 = find_qvar(qvar1);
+    size_t index2 = find_qvar(qvar2);
+    size_t side;
+    size_t link = find_link(index1, index2, side);
+    if(link == npos) {
+        return false;
+    }
+
+    std::map<ConditionPtr, LinkSupport>& supports = _links[link].supports[side];
+    std::map<ConditionPtr, LinkSupport>& other_supports = 
+        _links[link].supports[1 - side];
+    std::vector< std::pair<size_t, ConditionPtr> > worklist;
+
+    for(std::map<ConditionPtr, LinkSupport>::iterator it = supports.begin();
+            it != supports.end(); ++it)
+    {
+        if(!_qvar_sets[index1].has_element(it->first)) {
+            continue;
+        }
+
+        ConditionSet rejected;
+        for(ConditionSet::iterator cit = it->second.partners.begin();
+                cit != it->second.partners.end(); ++cit)
+        {
+            check_budget(_budget);
+            if(_qvar_sets[index2].has_element(*cit) && 
+                    !filter->is_linked(it->first, *cit)) 
+            {
+                rejected.insert(*cit);
+            }
+        }
+
+        for(ConditionSet::iterator cit = rejected.begin();
+                cit != rejected.end(); ++cit)
+        {
+            _path_cache.clear();
 
-    _qvar_link_table[qvar1].insert(qvar2);
-    _qvar_link_table[qvar2].insert(qvar1);
+            it->second.partners.remove(*cit);
+            if(--it->second.count == 0) {
+                worklist.push_back(std::make_pair(index1, it->first));
+            }
+
+            LinkSupport& other = other_supports[*cit];
+            other.partners.remove(it->first);
+            if(--other.count == 0) {
+                worklist.push_back(std::make_pair(index2, *cit));
+            }
+        }
+    }
+
+    propagate(worklist);
+    return true;
 }
 
 /*
@@ -59,266 +120,577 @@ bool SimpleQueryLinker::add_link(
         const std::string& qvar1, const std::string& qvar2, 
         const ConditionPtr& condition1, const ConditionPtr& condition2)
 {
-    if(has_condition(qvar1, condition1) && has_condition(qvar2, condition2)) {
-        _condition_link_table[QVarPair(qvar1, qvar2)][condition1].insert(condition2);
-        _condition_link_table[QVarPair(qvar2, qvar1)][condition2].insert(condition1);
-        return true;
-    } else {
+    if(!has_condition(qvar1, condition1) || !has_condition(qvar2, condition2)) {
         return false;
     }
+
+    size_t index1 = find_qvar(qvar1);
+    size_t index2 = find_qvar(qvar2);
+    size_t side;
+    size_t link = find_link(index1, index2, side);
+
+    if(link == npos) {
+        QVarLink new_link;
+        new_link.qvars[0] = index1;
+        new_link.qvars[1] = index2;
+
+        link = _links.size();
+        side = 0;
+        _links.push_back(std::move(new_link));
+
+        LinkEnd end1 = { link, 0 };
+        LinkEnd end2 = { link, 1 };
+        _qvar_links[index1].push_back(end1);
+        _qvar_links[index2].push_back(end2);
+    }
+
+    std::map<ConditionPtr, LinkSupport>::iterator it = 
+        _links[link].supports[side].find(condition1);
+    if(it == _links[link].supports[side].end()) {
+        LinkSupport support = { ConditionSet(), 0 };
+        it = _links[link].supports[side].insert(
+                std::make_pair(condition1, support)).first;
+    }
+
+    if(!it->second.partners.has_element(condition2)) {
+        _path_cache.clear();
+
+        it->second.partners.insert(condition2);
+        ++it->second.count;
+
+        LinkSupport& other = _links[link].supports[1 - side][condition2];
+        other.partners.insert(condition1);
+        ++other.count;
+    }
+    return true;
 }
 
 void SimpleQueryLinker::update_results(const std::string& qvar, 
         const ConditionSet& new_set)
 {
-    if(!is_initialized(qvar)) {
-        _qvar_table[qvar] = new_set;
-    } else {
-        ConditionSet difference = _qvar_table[qvar].difference_with(new_set);
-        if(!difference.is_empty()) {
-            for(ConditionSet::iterator it = difference.begin(); 
-                    it != difference.end(); ++it )
-            {
-                remove_condition(qvar, *it);
-            }
-        }
+    size_t index = find_qvar(qvar);
+    if(index == npos) {
+        init_qvar(qvar, new_set);
+        return;
     }
+
+    ConditionSet difference = _qvar_sets[index].difference_with(new_set);
+    std::vector< std::pair<size_t, ConditionPtr> > worklist;
+
+    for(ConditionSet::iterator it = difference.begin(); 
+            it != difference.end(); ++it)
+    {
+        worklist.push_back(std::make_pair(index, *it));
+    }
+    propagate(worklist);
 }
 
 TupleList SimpleQueryLinker::make_tuples(
         const std::vector<std::string>& variables) 
 {
-    TupleList result;
+    TupleCollector collector;
+    enumerate_tuples(variables, &collector);
+    return collector.result;
+}
 
-    std::string first_qvar = *variables.begin();
-    
-    if(!is_initialized(first_qvar)) {
-        throw QueryLinkerError();
+void SimpleQueryLinker::enumerate_tuples(
+        const std::vector<std::string>& variables, TupleVisitor *visitor)
+{
+    for(size_t i = 0; i < variables.size(); ++i) {
+        if(!is_initialized(variables[i])) {
+            throw QueryLinkerError();
+        }
     }
 
-    for(ConditionSet::iterator cit = _qvar_table[first_qvar].begin();
-        cit != _qvar_table[first_qvar].end(); ++cit)
-    {
-        TupleList tuples = make_tuples(first_qvar, *cit, 
-                ++variables.begin(), variables.end());
+    if(variables.empty()) {
+        return;
+    }
 
-        for(TupleList::iterator tit = tuples.begin();
-            tit != tuples.end(); ++tit)
-        {
-            result.insert(*tit);
+    std::vector<std::string> qvars(variables.begin(), variables.end());
+    std::sort(qvars.begin(), qvars.end());
+    qvars.erase(std::unique(qvars.begin(), qvars.end()), qvars.end());
+
+    std::vector<TuplePlan> plans = plan_tuples(qvars);
+    std::vector<TupleRows> rows(plans.size());
+
+    // the group and the step of each variable
+    std::map< std::string, std::pair<size_t, size_t> > positions;
+
+    for(size_t group = 0; group < plans.size(); ++group) {
+        std::vector<ConditionPtr> chosen;
+        enumerate_plan(plans[group], 0, chosen, rows[group]);
+
+        std::vector<size_t> hidden;
+        if(find_hidden_qvars(plans[group], hidden)) {
+            TupleRows checked;
+
+            for(size_t row = 0; row < rows[group].size(); ++row) {
+                std::map<size_t, ConditionPtr> assigned;
+                for(size_t step = 0; step < plans[group].size(); ++step) {
+                    assigned.insert(std::make_pair(find_qvar(plans[group][step].qvar),
+                                rows[group][row][step]));
+                }
+
+                if(extend_row(hidden, 0, assigned)) {
+                    checked.push_back(rows[group][row]);
+                }
+            }
+            rows[group].swap(checked);
         }
-    }
 
-    return result;
-}
+        if(rows[group].empty()) {
+            return;
+        }
 
-TupleList SimpleQueryLinker::make_tuples(
-        const std::string& current_qvar,
-        const ConditionPtr& current_condition,
-        std::vector<std::string>::const_iterator next_qit,
-        std::vector<std::string>::const_iterator end)
-{
-    if(!is_initialized(current_qvar)) {
-        throw QueryLinkerError();
+        for(size_t step = 0; step < plans[group].size(); ++step) {
+            positions[plans[group][step].qvar] = std::make_pair(group, step);
+        }
     }
 
-    TupleList result;
+    std::vector<size_t> current(rows.size(), 0);
+    std::vector<ConditionPtr> row;
+    row.reserve(variables.size());
 
-    if(next_qit == end) {
-        result.insert(ConditionTuplePtr(
-                    new SimpleConditionTuple(current_condition)));
-    } else {
-        std::string next_qvar = *next_qit++;
+    while(true) {
+        check_budget(_budget);
 
-        if(has_link(current_qvar, next_qvar)) {
-            ConditionSet linked_conditions = get_linked_conditions(
-                    current_qvar, next_qvar, current_condition);
+        row.clear();
+        for(size_t i = 0; i < variables.size(); ++i) {
+            const std::pair<size_t, size_t>& position = positions[variables[i]];
+            row.push_back(rows[position.first][current[position.first]][position.second]);
+        }
+        visitor->visit_tuple(row);
 
-            for(ConditionSet::iterator cit = linked_conditions.begin();
-                    cit != linked_conditions.end(); ++cit)
+        size_t group = 0;
+        while(group < rows.size() && ++current[group] == rows[group].size()) {
+            current[group++] = 0;
+        }
+        if(group == rows.size()) {
+            break;
+        }
+    }
+}
+
+std::vector<SimpleQueryLinker::TuplePlan> SimpleQueryLinker::plan_tuples(
+        std::vector<std::string> qvars)
+{
+    std::vector<TuplePlan> plans;
+
+    while(!qvars.empty()) {
+        size_t smallest = 0;
+        for(size_t i = 1; i < qvars.size(); ++i) {
+            if(_qvar_sets[find_qvar(qvars[i])].get_size() < 
+                    _qvar_sets[find_qvar(qvars[smallest])].get_size()) 
             {
-                merge_tuples(current_condition, 
-                        make_tuples(next_qvar, *cit, next_qit, end), 
-                        result);
+                smallest = i;
             }
-        } else if(has_indirect_links(current_qvar, next_qvar)) {
-            ConditionSet linked_conditions = get_indirect_links(
-                    current_qvar, next_qvar, current_condition);
+        }
 
-            for(ConditionSet::iterator cit = linked_conditions.begin();
-                    cit != linked_conditions.end(); ++cit)
-            {
-                merge_tuples(current_condition, 
-                        make_tuples(next_qvar, *cit, next_qit, end), 
-                        result);
+        TuplePlan plan;
+        TupleStep first = { qvars[smallest], std::vector<size_t>(), 0 };
+        plan.push_back(first);
+        qvars.erase(qvars.begin() + smallest);
+
+        while(true) {
+            TupleStep best = { "", std::vector<size_t>(), 0 };
+            size_t best_index = qvars.size();
+            bool best_indirect = false;
+
+            for(size_t i = 0; i < qvars.size(); ++i) {
+                TupleStep step = { qvars[i], std::vector<size_t>(), 0 };
+                bool indirect = false;
+
+                for(size_t k = 0; k < plan.size(); ++k) {
+                    if(has_link(plan[k].qvar, qvars[i])) {
+                        step.direct.push_back(k);
+                    }
+                }
+
+                if(step.direct.empty()) {
+                    size_t k = 0;
+                    while(k < plan.size() && !has_indirect_links(plan[k].qvar, qvars[i])) {
+                        ++k;
+                    }
+                    if(k == plan.size()) {
+                        continue;
+                    }
+                    step.anchor = k;
+                    indirect = true;
+                }
+
+                // direct links first, then the smaller set
+                if(best_index == qvars.size() || (best_indirect && !indirect) ||
+                        (best_indirect == indirect && 
+                         _qvar_sets[find_qvar(qvars[i])].get_size() < 
+                         _qvar_sets[find_qvar(best.qvar)].get_size()))
+                {
+                    best = step;
+                    best_index = i;
+                    best_indirect = indirect;
+                }
             }
-        } else {
-            for(ConditionSet::iterator cit = _qvar_table[next_qvar].begin();
-                cit != _qvar_table[next_qvar].end(); ++cit)
-            {
-                merge_tuples(current_condition, 
-                        make_tuples(next_qvar, *cit, next_qit, end), 
-                        result);
+
+            if(best_index == qvars.size()) {
+                break;
             }
+            plan.push_back(best);
+            qvars.erase(qvars.begin() + best_index);
         }
+
+        plans.push_back(plan);
     }
 
-    return result;
+    return plans;
 }
 
-void SimpleQueryLinker::merge_tuples(const ConditionPtr& target_condition,
-        const TupleList& tuples, TupleList& result)
+void SimpleQueryLinker::enumerate_plan(const TuplePlan& plan, size_t step,
+        std::vector<ConditionPtr>& chosen, TupleRows& rows)
 {
-    for(TupleList::const_iterator tit = tuples.begin();
-        tit != tuples.end(); ++tit)
-    {
-        result.insert(ConditionTuplePtr(
-                    new SimpleConditionTuple(target_condition, *tit)));
+    if(step == plan.size()) {
+        rows.push_back(chosen);
+        return;
+    }
+
+    const TupleStep& current = plan[step];
+    ConditionSet candidates;
+
+    if(step == 0) {
+        candidates = _qvar_sets[find_qvar(current.qvar)];
+    } else if(current.direct.empty()) {
+        candidates = get_indirect_links(plan[current.anchor].qvar, current.qvar,
+                chosen[current.anchor]);
+    } else {
+        candidates = get_linked_conditions(plan[current.direct[0]].qvar, 
+                current.qvar, chosen[current.direct[0]]);
+
+        for(size_t i = 1; i < current.direct.size() && !candidates.is_empty(); ++i) {
+            candidates.intersect_with(get_linked_conditions(
+                        plan[current.direct[i]].qvar, current.qvar, 
+                        chosen[current.direct[i]]));
+        }
+    }
+
+    for(ConditionSet::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        check_budget(_budget);
+
+        chosen.push_back(*it);
+        enumerate_plan(plan, step + 1, chosen, rows);
+        chosen.pop_back();
     }
 }
 
+/*
+ * The hidden qvars are listed in breadth first order from the qvars
+ * of the plan, so each of them is linked to an earlier one. A
+ * connected group is cyclic if it has as many links as qvars.
+ */
+bool SimpleQueryLinker::find_hidden_qvars(const TuplePlan& plan, 
+        std::vector<size_t>& hidden)
+{
+    std::vector<char> seen(_qvar_sets.size(), 0);
+    std::vector<size_t> queue;
+    for(size_t step = 0; step < plan.size(); ++step) {
+        size_t qvar = find_qvar(plan[step].qvar);
+        seen[qvar] = 1;
+        queue.push_back(qvar);
+    }
+
+    // each link is seen from both of its ends
+    size_t ends = 0;
+    for(size_t i = 0; i < queue.size(); ++i) {
+        const std::vector<LinkEnd>& links = _qvar_links[queue[i]];
+        ends += links.size();
+
+        for(size_t k = 0; k < links.size(); ++k) {
+            size_t next = _links[links[k].link].qvars[1 - links[k].side];
+            if(!seen[next]) {
+                seen[next] = 1;
+                queue.push_back(next);
+                hidden.push_back(next);
+            }
+        }
+    }
+    return ends / 2 >= queue.size();
+}
+
+bool SimpleQueryLinker::extend_row(const std::vector<size_t>& hidden, size_t k,
+        std::map<size_t, ConditionPtr>& assigned)
+{
+    if(k == hidden.size()) {
+        return true;
+    }
+
+    size_t qvar = hidden[k];
+    const std::vector<LinkEnd>& links = _qvar_links[qvar];
+    ConditionSet candidates;
+    bool first = true;
+
+    for(size_t i = 0; i < links.size(); ++i) {
+        size_t other = _links[links[i].link].qvars[1 - links[i].side];
+        std::map<size_t, ConditionPtr>::iterator it = assigned.find(other);
+        if(it == assigned.end()) {
+            continue;
+        }
+
+        ConditionSet linked = get_linked_conditions(
+                _qvar_names[other], _qvar_names[qvar], it->second);
+        if(first) {
+            candidates = std::move(linked);
+            first = false;
+        } else {
+            candidates.intersect_with(linked);
+        }
+
+        if(candidates.is_empty()) {
+            return false;
+        }
+    }
+
+    bool found = false;
+    for(ConditionSet::iterator it = candidates.begin(); 
+            it != candidates.end() && !found; ++it) 
+    {
+        check_budget(_budget);
+
+        assigned.insert(std::make_pair(qvar, *it));
+        found = extend_row(hidden, k + 1, assigned);
+        assigned.erase(qvar);
+    }
+    return found;
+}
 
 void SimpleQueryLinker::remove_condition(
         const std::string& qvar, const ConditionPtr& condition)
 {
-    if(_qvar_table[qvar].has_element(condition)) {
-        _qvar_table[qvar].remove(condition);
+    size_t index = find_qvar(qvar);
+    if(index == npos) {
+        return;
+    }
+
+    std::vector< std::pair<size_t, ConditionPtr> > worklist;
+    worklist.push_back(std::make_pair(index, condition));
+    propagate(worklist);
+}
+
+void SimpleQueryLinker::propagate(
+        std::vector< std::pair<size_t, ConditionPtr> >& worklist)
+{
+    while(!worklist.empty()) {
+        check_budget(_budget);
+
+        size_t qvar = worklist.back().first;
+        ConditionPtr condition = worklist.back().second;
+        worklist.pop_back();
+
+        if(!_qvar_sets[qvar].has_element(condition)) {
+            continue;
+        }
+        _qvar_sets[qvar].remove(condition);
+        _path_cache.clear();
 
         /*
          * If it is a removal of the last condition in a qvar and
          * makes it empty, the whole PQL is then fall into an invalid state.
          */
-        if(_qvar_table[qvar].is_empty()) {
+        if(_qvar_sets[qvar].is_empty()) {
             invalidate_state();
         }
 
-        /*
-         * Iterate through the query variables that have linkage with this query variable
-         */
-        for(std::set<std::string>::iterator qit = _qvar_link_table[qvar].begin();
-            qit != _qvar_link_table[qvar].end(); ++qit)
-        {
-            // clear the current link table and move that to local variable
-            ConditionSet linked_set = std::move(
-                    _condition_link_table[QVarPair(qvar, *qit)][condition]);
-
-            if(linked_set.is_empty()) {
+        const std::vector<LinkEnd>& ends = _qvar_links[qvar];
+        for(size_t i = 0; i < ends.size(); ++i) {
+            QVarLink& link = _links[ends[i].link];
+            size_t other_side = 1 - ends[i].side;
+            size_t other_qvar = link.qvars[other_side];
+
+            std::map<ConditionPtr, LinkSupport>& supports = 
+                link.supports[ends[i].side];
+            std::map<ConditionPtr, LinkSupport>::iterator sit = 
+                supports.find(condition);
+            if(sit == supports.end()) {
                 continue;
             }
 
+            std::map<ConditionPtr, LinkSupport>& other_supports = 
+                link.supports[other_side];
+
             /*
-             * Iterate through the conditions in the iterated query variable that
-             * are linked to this condition.
+             * A partner only loses this condition as a support, and is
+             * removed when it has no other partner left in this link.
              */
-            for(ConditionSet::iterator cit = linked_set.begin();
-                cit != linked_set.end(); ++cit)
+            for(ConditionSet::iterator cit = sit->second.partners.begin();
+                cit != sit->second.partners.end(); ++cit)
             {
-                break_link(*qit, qvar, *cit, condition);
+                std::map<ConditionPtr, LinkSupport>::iterator oit = 
+                    other_supports.find(*cit);
+                if(oit != other_supports.end() && --oit->second.count == 0) {
+                    worklist.push_back(std::make_pair(other_qvar, *cit));
+                }
             }
-        }
-    }
-}
 
-/*
- * Simple breaking of the link of condition1 in qvar with condition2.
- * if condition1 does not have any other link in qvar, return true 
- * to indicate that the break is complete.
- */
-void SimpleQueryLinker::break_link(
-        const std::string& qvar1, const std::string& qvar2,
-        const ConditionPtr& condition1, const ConditionPtr& condition2)
-{
-    ConditionSet& set = _condition_link_table[QVarPair(qvar1, qvar2)][condition1];
-    set.remove(condition2);
-    if(set.is_empty()) {
-        /*
-         * If there is no other condition link in condition1 to
-         * other conditions in qvar2, then condition1 is 
-         * invalidated and needs to be removed as well.
-         */
-        remove_condition(qvar1, condition1);
+            supports.erase(sit);
+        }
     }
 }
 
 bool SimpleQueryLinker::is_initialized(const std::string& qvar) {
-    return _qvar_table.count(qvar) > 0;
+    return _qvar_indices.count(qvar) > 0;
 }
 
 bool SimpleQueryLinker::has_condition(const std::string& qvar, const ConditionPtr& condition) {
-    return _qvar_table[qvar].has_element(condition);
+    size_t index = find_qvar(qvar);
+    return index != npos && _qvar_sets[index].has_element(condition);
 }
 
 bool SimpleQueryLinker::has_link(const std::string& qvar1,
               const std::string& qvar2)
 {
-    return _qvar_link_table[qvar1].count(qvar2) > 0;
+    size_t side;
+    return find_link(find_qvar(qvar1), find_qvar(qvar2), side) != npos;
 }
 
 ConditionSet SimpleQueryLinker::get_linked_conditions(
         const std::string& qvar1, const std::string& qvar2,
         const ConditionPtr& condition1) 
 {
-    if(_condition_link_table[QVarPair(qvar1, qvar2)].count(condition1) > 0) {
-        return _condition_link_table[QVarPair(qvar1, qvar2)][condition1];
-    } else {
+    size_t index2 = find_qvar(qvar2);
+    size_t side;
+    size_t link = find_link(find_qvar(qvar1), index2, side);
+    if(link == npos) {
+        return ConditionSet();
+    }
+
+    std::map<ConditionPtr, LinkSupport>::iterator it = 
+        _links[link].supports[side].find(condition1);
+    if(it == _links[link].supports[side].end()) {
         return ConditionSet();
     }
+
+    // partners removed from qvar2 are only dropped from the count
+    ConditionSet result = it->second.partners;
+    result.intersect_with(_qvar_sets[index2]);
+    return result;
 }
 
 bool SimpleQueryLinker::has_indirect_links(
-        const std::string& qvar1, const std::string& qvar2,
-        std::set<std::string> visited_qvars)
+        const std::string& qvar1, const std::string& qvar2)
 {
     if(has_link(qvar1, qvar2)) {
         return true;
-    } else {
-        for(std::set<std::string>::iterator qit = _qvar_link_table[qvar1].begin();
-            qit != _qvar_link_table[qvar1].end(); ++qit)
-        {
+    }
 
-            std::string mid_qvar = *qit;
+    std::vector<size_t> path;
+    return find_path(find_qvar(qvar1), find_qvar(qvar2), path);
+}
 
-            if(visited_qvars.count(mid_qvar) == 0) {
-                visited_qvars.insert(mid_qvar);
-                if(has_indirect_links(mid_qvar, qvar2, visited_qvars)) {
-                    return true;
-                }
+ConditionSet SimpleQueryLinker::get_indirect_links(
+        const std::string& qvar1, const std::string& qvar2,
+        const ConditionPtr& condition1)
+{
+    if(has_link(qvar1, qvar2)) {
+        return get_linked_conditions(qvar1, qvar2, condition1);
+    }
+
+    const LinkRelation& relation = get_path_relation(
+            find_qvar(qvar1), find_qvar(qvar2));
+    LinkRelation::const_iterator it = relation.find(condition1);
+    return it == relation.end() ? ConditionSet() : it->second;
+}
+
+/*
+ * Breadth first search over the qvar links. The path holds both
+ * ends, and is only found between two different qvars.
+ */
+bool SimpleQueryLinker::find_path(size_t qvar1, size_t qvar2, 
+        std::vector<size_t>& path)
+{
+    if(qvar1 == npos || qvar2 == npos || qvar1 == qvar2) {
+        return false;
+    }
+
+    std::vector<size_t> parents(_qvar_sets.size(), npos);
+    std::vector<size_t> queue(1, qvar1);
+    parents[qvar1] = qvar1;
+
+    for(size_t i = 0; i < queue.size() && parents[qvar2] == npos; ++i) {
+        const std::vector<LinkEnd>& ends = _qvar_links[queue[i]];
+        for(size_t k = 0; k < ends.size(); ++k) {
+            size_t next = _links[ends[k].link].qvars[1 - ends[k].side];
+            if(parents[next] == npos) {
+                parents[next] = queue[i];
+                queue.push_back(next);
             }
         }
+    }
+
+    if(parents[qvar2] == npos) {
         return false;
     }
+
+    path.clear();
+    for(size_t qvar = qvar2; qvar != qvar1; qvar = parents[qvar]) {
+        path.push_back(qvar);
+    }
+    path.push_back(qvar1);
+    std::reverse(path.begin(), path.end());
+    return true;
 }
 
-ConditionSet SimpleQueryLinker::get_indirect_links(
-        const std::string& qvar1, const std::string& qvar2,
-        const ConditionPtr& condition1, 
-        std::set<std::string> visited_qvars)
+/*
+ * Composes the links along the path from qvar1 to qvar2 hop by hop.
+ * Each hop only looks up the links of the conditions that were
+ * reached by the previous hops, and each of them only once.
+ */
+const SimpleQueryLinker::LinkRelation& SimpleQueryLinker::get_path_relation(
+        size_t qvar1, size_t qvar2)
 {
-    if(has_link(qvar1, qvar2)) {
-        return get_linked_conditions(qvar1, qvar2, condition1);
-    } else {
-        ConditionSet result;
+    std::pair<size_t, size_t> key(qvar1, qvar2);
+    std::map< std::pair<size_t, size_t>, LinkRelation >::iterator cached = 
+        _path_cache.find(key);
+    if(cached != _path_cache.end()) {
+        return cached->second;
+    }
 
-        for(std::set<std::string>::iterator qit = _qvar_link_table[qvar1].begin();
-            qit != _qvar_link_table[qvar1].end(); ++qit)
-        {
-            std::string mid_qvar = *qit;
+    LinkRelation& relation = _path_cache[key];
+    std::vector<size_t> path;
+    if(!find_path(qvar1, qvar2, path)) {
+        return relation;
+    }
 
-            if(visited_qvars.count(mid_qvar) == 0) {
-                visited_qvars.insert(mid_qvar);
+    const std::string& first = _qvar_names[path[0]];
+    const std::string& second = _qvar_names[path[1]];
+    for(ConditionSet::iterator it = _qvar_sets[qvar1].begin();
+            it != _qvar_sets[qvar1].end(); ++it)
+    {
+        ConditionSet linked = get_linked_conditions(first, second, *it);
+        if(!linked.is_empty()) {
+            relation[*it] = linked;
+        }
+    }
 
-                ConditionSet direct_links = get_linked_conditions(
-                        qvar1, mid_qvar, condition1);
-                for(ConditionSet::iterator cit = direct_links.begin();
-                    cit != direct_links.end(); ++cit)
-                {
-                    result.union_with(get_indirect_links(mid_qvar, qvar2,
-                                *cit, visited_qvars));
+    for(size_t hop = 2; hop < path.size(); ++hop) {
+        const std::string& from = _qvar_names[path[hop - 1]];
+        const std::string& to = _qvar_names[path[hop]];
+        LinkRelation step;
+
+        for(LinkRelation::iterator it = relation.begin(); it != relation.end(); ++it) {
+            check_budget(_budget);
+
+            ConditionSet reached;
+            for(ConditionSet::iterator cit = it->second.begin();
+                    cit != it->second.end(); ++cit)
+            {
+                LinkRelation::iterator sit = step.find(*cit);
+                if(sit == step.end()) {
+                    sit = step.insert(std::make_pair(*cit, 
+                                get_linked_conditions(from, to, *cit))).first;
                 }
+                reached.union_with(sit->second);
             }
+            it->second = std::move(reached);
         }
-        return result;
     }
+
+    return relation;
 }
 
 bool SimpleQueryLinker::validate(
@@ -336,20 +708,74 @@ bool SimpleQueryLinker::validate(
 ConditionSet SimpleQueryLinker::get_conditions(
         const std::string& qvar, SimplePredicate *pred) 
 {
-    if(!is_initialized(qvar)) {
-        _qvar_table[qvar] = pred->global_set();
+    ensure_initialized(qvar, pred);
+    return _qvar_sets[find_qvar(qvar)];
+}
+
+void SimpleQueryLinker::ensure_initialized(
+        const std::string& qvar, SimplePredicate *pred) 
+{
+    if(find_qvar(qvar) == npos) {
+        init_qvar(qvar, pred->global_set());
     }
-    return _qvar_table[qvar];
 }
 
 ConditionSet SimpleQueryLinker::get_conditions(const std::string& qvar) {
-    return _qvar_table[qvar];
+    size_t index = find_qvar(qvar);
+    return index == npos ? ConditionSet() : _qvar_sets[index];
 }
 
+void SimpleQueryLinker::drop_qvar(const std::string&) { }
+
 std::map<ConditionPtr, ConditionSet> SimpleQueryLinker::get_links(
         const std::string& qvar1, const std::string& qvar2)
 {
-    return _condition_link_table[QVarPair(qvar1, qvar2)];
+    std::map<ConditionPtr, ConditionSet> result;
+    size_t index1 = find_qvar(qvar1);
+    if(index1 == npos) {
+        return result;
+    }
+
+    for(ConditionSet::iterator it = _qvar_sets[index1].begin();
+            it != _qvar_sets[index1].end(); ++it)
+    {
+        ConditionSet linked = get_linked_conditions(qvar1, qvar2, *it);
+        if(!linked.is_empty()) {
+            result[*it] = linked;
+        }
+    }
+    return result;
+}
+
+size_t SimpleQueryLinker::find_qvar(const std::string& qvar) {
+    std::map<std::string, size_t>::iterator it = _qvar_indices.find(qvar);
+    return it == _qvar_indices.end() ? npos : it->second;
+}
+
+size_t SimpleQueryLinker::find_link(size_t qvar1, size_t qvar2, size_t& side) {
+    if(qvar1 == npos || qvar2 == npos) {
+        return npos;
+    }
+
+    const std::vector<LinkEnd>& ends = _qvar_links[qvar1];
+    for(size_t i = 0; i < ends.size(); ++i) {
+        if(_links[ends[i].link].qvars[1 - ends[i].side] == qvar2) {
+            side = ends[i].side;
+            return ends[i].link;
+        }
+    }
+    return npos;
+}
+
+size_t SimpleQueryLinker::init_qvar(const std::string& qvar, 
+        const ConditionSet& conditions)
+{
+    size_t index = _qvar_sets.size();
+    _qvar_indices[qvar] = index;
+    _qvar_names.push_back(qvar);
+    _qvar_sets.push_back(conditions);
+    _qvar_links.push_back(std::vector<LinkEnd>());
+    return index;
 }
 
 bool SimpleQueryLinker::is_valid_state() {
@@ -360,6 +786,10 @@ void SimpleQueryLinker::invalidate_state() {
     _valid_state = false;
 }
 
+void SimpleQueryLinker::set_budget(const QueryBudgetPtr& budget) {
+    _budget = budget;
+}
+
 
 
 }
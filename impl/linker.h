@@ -20,17 +20,17 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <utility>
 #include <exception>
 #include "simple/linker.h"
+#include "impl/budget.h"
 
 namespace simple {
 namespace impl {
 
 using namespace simple;
 
-typedef std::pair<std::string, std::string> QVarPair;
-
 class QueryLinkerError : public std::exception { };
 
 class SimpleQueryLinker : public QueryLinker {
@@ -41,30 +41,37 @@ class SimpleQueryLinker : public QueryLinker {
                    const std::string& qvar2, 
                    const std::vector<ConditionPair>& links);
 
+    /*
+     * Only a direct link between the two qvars is filtered.
+     */
+    bool filter_links(const std::string& qvar1,
+                   const std::string& qvar2,
+                   LinkFilter *filter);
+
     void update_results(const std::string& qvar,
                        const ConditionSet& conditions);
 
     TupleList make_tuples(const std::vector<std::string>& variables);
 
-    TupleList make_tuples(
-            const std::string& current_qvar,
-            const ConditionPtr& current_condition,
-            std::vector<std::string>::const_iterator next_qit,
-            std::vector<std::string>::const_iterator end);
+    /*
+     * Each connected group of variables is enumerated on its own,
+     * starting from its smallest set and following the direct links
+     * to the variables chosen so far before the indirect ones, so
+     * that only linked combinations are ever visited. The groups are
+     * crossed once at the end.
+     */
+    void enumerate_tuples(const std::vector<std::string>& variables,
+            TupleVisitor *visitor);
 
     bool add_link(const std::string& qvar1, const std::string& qvar2, 
                   const ConditionPtr& condition1, const ConditionPtr& condition2);
 
-    void remove_condition(const std::string& qvar, 
-                          const ConditionPtr& condition);
-
     /*
-     * Break the link of condition1 in qvar1 with condition2 in qvar2. 
+     * Remove the condition from qvar, together with every condition
+     * that is left without a linked condition in some other qvar.
      */
-    void break_link(const std::string& qvar1, 
-                    const std::string& qvar2,
-                    const ConditionPtr& condition1, 
-                    const ConditionPtr& condition2);
+    void remove_condition(const std::string& qvar, 
+                          const ConditionPtr& condition);
 
     bool is_initialized(const std::string& qvar);
 
@@ -79,26 +86,36 @@ class SimpleQueryLinker : public QueryLinker {
                     const std::string& qvar2,
                     const ConditionPtr& condition1);
 
-    void merge_tuples(const ConditionPtr& target_condition,
-            const TupleList& tuples, TupleList& result);
-
     ConditionSet get_conditions(const std::string& qvar,
             SimplePredicate *pred);
 
     ConditionSet get_conditions(const std::string& qvar);
 
+    void ensure_initialized(const std::string& qvar, SimplePredicate *pred);
+
+    /*
+     * A dropped qvar is kept, since the links through it may be the
+     * only ones between the qvars on either side.
+     */
+    void drop_qvar(const std::string& qvar);
+
     std::map<ConditionPtr, ConditionSet> get_links(
             const std::string& qvar1,
             const std::string& qvar2);
 
     bool has_indirect_links(
-            const std::string& qvar1, const std::string& qvar2,
-            std::set<std::string> visited_qvars = std::set<std::string>());
+            const std::string& qvar1, const std::string& qvar2);
 
+    /*
+     * The conditions in qvar2 reachable from condition1 in qvar1
+     * along the shortest path of qvar links between them. The whole
+     * path is composed once into a relation that is kept until the
+     * linker is updated again. If the qvars are also linked along a
+     * longer path, that path is not checked.
+     */
     ConditionSet get_indirect_links(
             const std::string& qvar1, const std::string& qvar2,
-            const ConditionPtr& condition1, 
-            std::set<std::string> visited_qvars = std::set<std::string>());
+            const ConditionPtr& condition1);
 
     bool validate(const std::string& qvar1, const std::string& qvar2, 
             const ConditionPtr& condition1, const ConditionPtr& condition2);
@@ -106,18 +123,94 @@ class SimpleQueryLinker : public QueryLinker {
 
     bool is_valid_state();
     void invalidate_state();
+
+    void set_budget(const QueryBudgetPtr& budget);
   private:
-    std::map< QVarPair, 
-        std::map<ConditionPtr, ConditionSet> >
-    _condition_link_table;
+    /*
+     * A variable in the enumeration order of a group. Its candidates
+     * are the conditions linked to the chosen conditions of the
+     * earlier steps in direct, or if there are none, the conditions
+     * indirectly linked to the chosen condition of the anchor step.
+     */
+    struct TupleStep {
+        std::string         qvar;
+        std::vector<size_t> direct;
+        size_t              anchor;
+    };
+
+    typedef std::vector<TupleStep> TuplePlan;
+    typedef std::vector< std::vector<ConditionPtr> > TupleRows;
+
+    std::vector<TuplePlan> plan_tuples(std::vector<std::string> qvars);
+
+    void enumerate_plan(const TuplePlan& plan, size_t step,
+            std::vector<ConditionPtr>& chosen, TupleRows& rows);
 
-    std::map< std::string, std::set<std::string> >
-    _qvar_link_table;
-    
-    std::map< std::string, ConditionSet > 
-    _qvar_table;
+    /*
+     * The indirect links of a group follow a single path between two
+     * qvars, which is exact as long as the qvars of the group and the
+     * qvars between them form no cycle. Otherwise each row is checked
+     * against all links by finding conditions for the qvars that are
+     * not selected, one qvar at a time.
+     */
+    bool find_hidden_qvars(const TuplePlan& plan, std::vector<size_t>& hidden);
+
+    bool extend_row(const std::vector<size_t>& hidden, size_t k,
+            std::map<size_t, ConditionPtr>& assigned);
+
+    /*
+     * The conditions of one side of a link that a condition of the
+     * other side is linked to. The count is the number of them that
+     * are still in the result set of their qvar, so the partners do
+     * not have to be updated when one of them is removed.
+     */
+    struct LinkSupport {
+        ConditionSet    partners;
+        size_t          count;
+    };
+
+    /*
+     * All links between two qvars, with the supports of the conditions
+     * of each side by the side index.
+     */
+    struct QVarLink {
+        size_t qvars[2];
+        std::map<ConditionPtr, LinkSupport> supports[2];
+    };
+
+    struct LinkEnd {
+        size_t link;
+        size_t side;
+    };
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+    typedef std::map<ConditionPtr, ConditionSet> LinkRelation;
+
+    size_t find_qvar(const std::string& qvar);
+    size_t find_link(size_t qvar1, size_t qvar2, size_t& side);
+    size_t init_qvar(const std::string& qvar, const ConditionSet& conditions);
+
+    /*
+     * Removes the conditions in the worklist from their qvars and
+     * propagates the removals through the support counts, enqueuing
+     * only the conditions whose count drops to zero.
+     */
+    void propagate(std::vector< std::pair<size_t, ConditionPtr> >& worklist);
+
+    bool find_path(size_t qvar1, size_t qvar2, std::vector<size_t>& path);
+    const LinkRelation& get_path_relation(size_t qvar1, size_t qvar2);
+
+    std::map<std::string, size_t>       _qvar_indices;
+    std::vector<std::string>            _qvar_names;
+    std::vector<ConditionSet>           _qvar_sets;
+    std::vector< std::vector<LinkEnd> > _qvar_links;
+    std::vector<QVarLink>               _links;
+
+    std::map< std::pair<size_t, size_t>, LinkRelation > _path_cache;
 
     bool _valid_state;
+    QueryBudgetPtr _budget;
 };
 
 class SimpleConditionTuple : public ConditionTuple {
@@ -144,5 +237,21 @@ class SimpleConditionTuple : public ConditionTuple {
     ConditionTuplePtr   _next;
 };
 
+/*
+ * Collects the enumerated rows into a TupleList.
+ */
+class TupleCollector : public TupleVisitor {
+  public:
+    void visit_tuple(const std::vector<ConditionPtr>& row) {
+        ConditionTuplePtr tuple;
+        for(size_t i = row.size(); i-- > 0;) {
+            tuple = ConditionTuplePtr(new SimpleConditionTuple(row[i], tuple));
+        }
+        result.insert(tuple);
+    }
+
+    TupleList result;
+};
+
 }
 }
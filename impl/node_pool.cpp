@@ -0,0 +1,234 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <mutex>
+#include <cstdlib>
+#include "impl/node_pool.h"
+
+namespace simple {
+namespace impl {
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+/*
+ * The unused end of a chunk, left behind by a thread that exited.
+ */
+struct SpareChunk {
+    SpareChunk  *next;
+    size_t      size;
+};
+
+const size_t CLASS_COUNT = NodePool::MAX_SIZE / NodePool::GRANULARITY;
+
+inline size_t size_class(size_t size) {
+    return (size + NodePool::GRANULARITY - 1) / NodePool::GRANULARITY - 1;
+}
+
+/*
+ * Detach up to count blocks from the front of the list and return
+ * them as a list of their own, storing its length in taken.
+ */
+FreeBlock* take_blocks(FreeBlock *&list, size_t count, size_t& taken) {
+    FreeBlock *first = list;
+    FreeBlock *last = NULL;
+    taken = 0;
+
+    for(FreeBlock *block = list; block != NULL && taken < count; 
+            block = block->next) 
+    {
+        last = block;
+        ++taken;
+    }
+
+    if(last != NULL) {
+        list = last->next;
+        last->next = NULL;
+    }
+    return taken == 0 ? NULL : first;
+}
+
+/*
+ * Prepend a list of blocks to another list.
+ */
+void splice_blocks(FreeBlock *&list, FreeBlock *blocks) {
+    if(blocks == NULL) {
+        return;
+    }
+
+    FreeBlock *last = blocks;
+    while(last->next != NULL) {
+        last = last->next;
+    }
+    last->next = list;
+    list = blocks;
+}
+
+class SharedPool {
+  public:
+    std::mutex  mutex;
+    FreeBlock   *free_lists[CLASS_COUNT];
+    SpareChunk  *spare_chunks;
+    size_t      chunk_count;
+};
+
+SharedPool shared;
+
+class ThreadPool {
+  public:
+    ThreadPool() :
+        chunk(NULL), chunk_left(0)
+    {
+        for(size_t i = 0; i < CLASS_COUNT; ++i) {
+            free_lists[i] = NULL;
+            free_counts[i] = 0;
+        }
+    }
+
+    /*
+     * Hand everything this thread still holds to the shared pool, so
+     * that it is not lost when the thread exits.
+     */
+    ~ThreadPool() {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        for(size_t i = 0; i < CLASS_COUNT; ++i) {
+            splice_blocks(shared.free_lists[i], free_lists[i]);
+        }
+
+        if(chunk_left > 0) {
+            SpareChunk *spare = reinterpret_cast<SpareChunk*>(chunk);
+            spare->size = chunk_left;
+            spare->next = shared.spare_chunks;
+            shared.spare_chunks = spare;
+        }
+    }
+
+    /*
+     * Refill an empty free list from the shared pool, or failing that
+     * switch to a spare or a new chunk. The end of the old chunk is
+     * too small for the block, so it goes to the free list of its own
+     * size class.
+     */
+    void refill(size_t index) {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        free_lists[index] = take_blocks(shared.free_lists[index], 
+                NodePool::BATCH_SIZE, free_counts[index]);
+        if(free_lists[index] != NULL) {
+            return;
+        }
+
+        if(chunk_left > 0) {
+            size_t tail_index = size_class(chunk_left);
+            FreeBlock *tail = reinterpret_cast<FreeBlock*>(chunk);
+            tail->next = free_lists[tail_index];
+            free_lists[tail_index] = tail;
+            ++free_counts[tail_index];
+        }
+
+        if(shared.spare_chunks != NULL) {
+            SpareChunk *spare = shared.spare_chunks;
+            shared.spare_chunks = spare->next;
+            chunk = reinterpret_cast<char*>(spare);
+            chunk_left = spare->size;
+        } else {
+            chunk = static_cast<char*>(::operator new(NodePool::CHUNK_SIZE));
+            chunk_left = NodePool::CHUNK_SIZE;
+            ++shared.chunk_count;
+        }
+    }
+
+    /*
+     * Give a batch of free blocks back to the shared pool once this
+     * thread has freed more than it is likely to allocate again.
+     */
+    void flush(size_t index) {
+        size_t taken;
+        FreeBlock *blocks = take_blocks(free_lists[index], 
+                NodePool::BATCH_SIZE, taken);
+        free_counts[index] -= taken;
+
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        splice_blocks(shared.free_lists[index], blocks);
+    }
+
+    FreeBlock   *free_lists[CLASS_COUNT];
+    size_t      free_counts[CLASS_COUNT];
+    char        *chunk;
+    size_t      chunk_left;
+};
+
+thread_local ThreadPool pool;
+
+} // anonymous namespace
+
+void* NodePool::allocate(size_t size) {
+    if(size == 0 || size > MAX_SIZE) {
+        return ::operator new(size);
+    }
+
+    size_t index = size_class(size);
+    size_t block_size = (index + 1) * GRANULARITY;
+    if(pool.free_lists[index] == NULL && pool.chunk_left < block_size) {
+        pool.refill(index);
+    }
+
+    if(pool.free_lists[index] != NULL) {
+        FreeBlock *block = pool.free_lists[index];
+        pool.free_lists[index] = block->next;
+        --pool.free_counts[index];
+        return block;
+    }
+
+    void *block = pool.chunk;
+    pool.chunk += block_size;
+    pool.chunk_left -= block_size;
+    return block;
+}
+
+void NodePool::release(void *block, size_t size) {
+    if(block == NULL) {
+        return;
+    }
+
+    if(size == 0 || size > MAX_SIZE) {
+        ::operator delete(block);
+        return;
+    }
+
+    size_t index = size_class(size);
+    FreeBlock *free_block = static_cast<FreeBlock*>(block);
+    free_block->next = pool.free_lists[index];
+    pool.free_lists[index] = free_block;
+
+    if(++pool.free_counts[index] >= 2 * BATCH_SIZE) {
+        pool.flush(index);
+    }
+}
+
+size_t NodePool::get_chunk_count() {
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    return shared.chunk_count;
+}
+
+} // namespace impl
+} // namespace simple
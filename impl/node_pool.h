@@ -0,0 +1,70 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace simple {
+namespace impl {
+
+/*
+ * Small fixed-size blocks carved out of large chunks, with one free
+ * list per size class. Freed blocks are reused by later nodes of the
+ * same size, and chunks are kept for the lifetime of the program, so
+ * a parse costs a handful of chunk allocations instead of one malloc
+ * per node. 
+ *
+ * Each thread has its own free lists, which exchange blocks with a
+ * shared pool in batches of BATCH_SIZE. Nodes parsed on one thread 
+ * and deleted on another therefore find their way back to the threads
+ * that allocate, and a thread that exits hands its free blocks and the
+ * rest of its chunk to the shared pool.
+ */
+class NodePool {
+  public:
+    static void* allocate(size_t size);
+    static void release(void *block, size_t size);
+
+    /*
+     * The number of chunks allocated so far by all threads.
+     */
+    static size_t get_chunk_count();
+
+    static const size_t GRANULARITY = 16;
+    static const size_t MAX_SIZE = 256;
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t BATCH_SIZE = 256;
+};
+
+/*
+ * AST nodes inherit their allocation from the pool.
+ */
+class PooledNode {
+  public:
+    static void* operator new(size_t size) {
+        return NodePool::allocate(size);
+    }
+
+    static void operator delete(void *block, size_t size) {
+        NodePool::release(block, size);
+    }
+};
+
+} // namespace impl
+} // namespace simple
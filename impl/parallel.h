@@ -0,0 +1,87 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+
+namespace simple {
+namespace impl {
+
+inline size_t default_thread_count() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+/*
+ * Runs task(i) for every i below count on up to the given number of
+ * threads, including the calling thread. The threads take the next
+ * index from a shared counter, so uneven tasks balance out. Once a
+ * task throws, no new tasks are started and the first exception is
+ * rethrown after all threads have stopped.
+ */
+template <typename Task>
+void parallel_for(size_t count, size_t threads, Task task) {
+    threads = std::min(threads, count);
+    if(threads <= 1) {
+        for(size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for(size_t i = next++; i < count; i = next++) {
+            try {
+                task(i);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(size_t i = 1; i < threads; ++i) {
+        pool.push_back(std::thread(worker));
+    }
+    worker();
+
+    for(size_t i = 0; i < pool.size(); ++i) {
+        pool[i].join();
+    }
+
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace impl
+} // namespace simple
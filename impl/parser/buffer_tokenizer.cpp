@@ -0,0 +1,216 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "impl/parser/buffer_tokenizer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace simple {
+namespace parser {
+
+namespace {
+
+#ifdef __SSE2__
+
+/*
+ * Marks the bytes between low and high. Bytes above 0x7f compare as
+ * negative and never match.
+ */
+inline __m128i in_range(__m128i chars, char low, char high) {
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8(low - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8(high + 1)));
+}
+
+#endif
+
+/*
+ * Each character class tests one character, and with SSE2 also
+ * returns a 16 bit mask of the matching bytes in a block.
+ */
+struct SpaceClass {
+    static bool match(char c) {
+        return c == ' ';
+    }
+
+#ifdef __SSE2__
+    static int mask(__m128i chars) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')));
+    }
+#endif
+};
+
+struct DigitClass {
+    static bool match(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+#ifdef __SSE2__
+    static int mask(__m128i chars) {
+        return _mm_movemask_epi8(in_range(chars, '0', '9'));
+    }
+#endif
+};
+
+struct IdentifierClass {
+    static bool match_start(char c) {
+        char lower = c | 0x20;
+        return (lower >= 'a' && lower <= 'z') || c == '_';
+    }
+
+    static bool match(char c) {
+        return match_start(c) || DigitClass::match(c);
+    }
+
+#ifdef __SSE2__
+    static int mask(__m128i chars) {
+        __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(in_range(lower, 'a', 'z'), in_range(chars, '0', '9')),
+            _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+        return _mm_movemask_epi8(matches);
+    }
+#endif
+};
+
+/*
+ * Returns the first character from it that is not in the class.
+ */
+template <typename Class>
+const char* scan(const char *it, const char *end) {
+#ifdef __SSE2__
+    while(end - it >= 16) {
+        int mask = ~Class::mask(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(it))) & 0xffff;
+        if(mask != 0) {
+            return it + __builtin_ctz(mask);
+        }
+        it += 16;
+    }
+#endif
+    while(it != end && Class::match(*it)) {
+        ++it;
+    }
+    return it;
+}
+
+} // anonymous namespace
+
+BufferTokenizer::BufferTokenizer(const char *begin, const char *end) :
+    _it(begin), _end(end),
+    _plus_token('+'), _minus_token('-'), _multiply_token('*'),
+    _identifier_token(""), _integer_token(0), _literal_token("")
+{ }
+
+SimpleToken* BufferTokenizer::next_token() {
+    _it = scan<SpaceClass>(_it, _end);
+
+    if(_it == _end) {
+        return &_eof_token;
+    }
+
+    char c = *_it;
+    switch(c) {
+        case '\0':
+            ++_it;
+            return &_eof_token;
+        case '\n':
+            ++_it;
+            return &_new_line_token;
+        case '\r':
+            if(++_it != _end && *_it == '\n') {
+                ++_it;
+            }
+            return &_new_line_token;
+        case '{':
+            ++_it;
+            return &_open_brace_token;
+        case '}':
+            ++_it;
+            return &_close_brace_token;
+        case '(':
+            ++_it;
+            return &_open_bracket_token;
+        case ')':
+            ++_it;
+            return &_close_bracket_token;
+        case ';':
+            ++_it;
+            return &_semi_colon_token;
+        case ',':
+            ++_it;
+            return &_comma_token;
+        case '.':
+            ++_it;
+            return &_dot_token;
+        case '=':
+            ++_it;
+            return &_equal_token;
+        case '+':
+            ++_it;
+            return &_plus_token;
+        case '-':
+            ++_it;
+            return &_minus_token;
+        case '*':
+            ++_it;
+            return &_multiply_token;
+        case '"': {
+            const char *begin = ++_it;
+            while(_it != _end && *_it != '"') {
+                ++_it;
+            }
+            if(_it == _end) {
+                throw InvalidTokenError("Unterminated literal");
+            }
+            _literal_token.set_content(begin, _it++);
+            return &_literal_token;
+        }
+    }
+
+    if(IdentifierClass::match_start(c)) {
+        const char *begin = _it;
+        _it = scan<IdentifierClass>(_it + 1, _end);
+
+        if(_it - begin == 1 && c == '_') {
+            return &_wild_card_token;
+        }
+
+        _identifier_token.set_content(begin, _it);
+        return &_identifier_token;
+    }
+
+    if(DigitClass::match(c)) {
+        const char *begin = _it;
+        _it = scan<DigitClass>(_it + 1, _end);
+
+        unsigned int value = 0;
+        for(; begin != _it; ++begin) {
+            value = value * 10 + (*begin - '0');
+        }
+        _integer_token.set_value(value);
+        return &_integer_token;
+    }
+
+    throw InvalidTokenError(c);
+}
+
+}
+}
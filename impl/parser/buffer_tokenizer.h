@@ -0,0 +1,72 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "impl/parser/tokenizer.h"
+
+namespace simple {
+namespace parser {
+
+/*
+ * BufferTokenizer reads the same tokens as IteratorTokenizer from a
+ * contiguous buffer, such as a memory mapped source file. Runs of
+ * spaces, identifiers and numbers are scanned 16 bytes at a time, and
+ * the value tokens are reused, so tokenizing does not allocate once
+ * the longest identifier has been seen. The buffer must outlive the
+ * tokenizer.
+ */
+class BufferTokenizer : public SimpleTokenizer {
+  public:
+    BufferTokenizer(const char *begin, const char *end);
+
+    template <typename Token>
+    Token* next_token_as() {
+        return token_cast<Token>(next_token());
+    }
+
+    SimpleToken* next_token();
+
+    ~BufferTokenizer() { }
+
+  private:
+    const char *_it;
+    const char *_end;
+
+    OpenBraceToken      _open_brace_token;
+    CloseBraceToken     _close_brace_token;
+    OpenBracketToken    _open_bracket_token;
+    CloseBracketToken   _close_bracket_token;
+    SemiColonToken      _semi_colon_token;
+    CommaToken          _comma_token;
+    DotToken            _dot_token;
+    EqualToken          _equal_token;
+    EOFToken            _eof_token;
+    NewLineToken        _new_line_token;
+    WildCardToken       _wild_card_token;
+    OperatorToken       _plus_token;
+    OperatorToken       _minus_token;
+    OperatorToken       _multiply_token;
+
+    IdentifierToken     _identifier_token;
+    IntegerToken        _integer_token;
+    LiteralToken        _literal_token;
+};
+
+}
+}
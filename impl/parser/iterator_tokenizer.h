@@ -103,6 +103,16 @@ class IteratorTokenizer : public SimpleTokenizer {
                 next_char();
                 return &_equal_token;
 
+            break;
+            case '<':
+                next_char();
+                return &_less_than_token;
+
+            break;
+            case '>':
+                next_char();
+                return &_more_than_token;
+
             break;
             case '+':
                 next_char();
@@ -139,6 +149,12 @@ class IteratorTokenizer : public SimpleTokenizer {
                 value += current_char();
                 next_char();
             }
+
+            // the stmt# attribute of query variables
+            if(current_char() == '#') {
+                value += current_char();
+                next_char();
+            }
             
             if(value == "_") {
                 return &_wild_card_token;
@@ -191,6 +207,8 @@ class IteratorTokenizer : public SimpleTokenizer {
     CommaToken          _comma_token;
     DotToken            _dot_token;
     EqualToken          _equal_token;
+    LessThanToken       _less_than_token;
+    MoreThanToken       _more_than_token;
     EOFToken            _eof_token;
     NewLineToken        _new_line_token;
     WildCardToken       _wild_card_token;
@@ -32,6 +32,16 @@ SimpleParser::SimpleParser(SimpleTokenizer *tokenizer) :
     next_token();
 }
 
+SimpleParser::SimpleParser(SimpleTokenizer *tokenizer, int line,
+        const std::map<std::string, SimpleProcAst*>& procs) :
+    _line(line),
+    _procs_table(procs),
+    _line_table(),
+    _tokenizer(tokenizer)
+{
+    next_token();
+}
+
 SimpleRoot SimpleParser::parse_program() {
     while(!current_token_is<EOFToken>()) {
         _procs.push_back(parse_proc());
@@ -41,6 +51,16 @@ SimpleRoot SimpleParser::parse_program() {
     return SimpleRoot(_procs.begin(), _procs.end());
 }
 
+SimpleProcAst* SimpleParser::parse_proc_fragment() {
+    size_t known_procs = _procs_table.size();
+    SimpleProcAst *proc = parse_proc();
+
+    if(!current_token_is<EOFToken>() || _procs_table.size() != known_procs) {
+        throw ParserError();
+    }
+    return proc;
+}
+
 ExprAst* SimpleParser::parse_expr() {
     ExprAst *primary = parse_primary();
     return parse_binary_op_rhs(0, primary);
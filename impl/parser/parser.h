@@ -39,8 +39,21 @@ class SimpleParser {
   public:
     SimpleParser(SimpleTokenizer *tokenizer);
 
+    /*
+     * Parser for a fragment of a program that starts at the given line.
+     * Procedure names resolve to the given procedures.
+     */
+    SimpleParser(SimpleTokenizer *tokenizer, int line,
+            const std::map<std::string, SimpleProcAst*>& procs);
+
     SimpleRoot parse_program();
 
+    /*
+     * Parse a fragment that holds exactly one procedure. Calling a
+     * procedure that is not in the procedure table is an error.
+     */
+    SimpleProcAst* parse_proc_fragment();
+
     ExprAst* parse_expr();
 
     SimpleStatementAst* parse_statement(ProcAst *proc, ContainerAst *parent = NULL);
@@ -18,6 +18,9 @@
 
 #include <algorithm>
 #include "impl/parser/pql_parser.h"
+#include "impl/parser/parser.h"
+#include "impl/parser/buffer_tokenizer.h"
+#include "simple/util/solver_generator.h"
 
 namespace simple {
 namespace parser {
@@ -30,10 +33,14 @@ SimplePqlParser::SimplePqlParser(
         const SimpleRoot& ast,
         const LineTable& line_table,
         const SolverTable& solver_table,
-        const PredicateTable& pred_table) :
+        const PredicateTable& pred_table,
+        PkbPtr pkb,
+        AttributeIndexPtr attributes) :
     _tokenizer(tokenizer), _ast(ast),
     _line_table(line_table), _solver_table(solver_table), 
-    _pred_table(pred_table)
+    _pred_table(pred_table),
+    _condition_table(pkb->get_condition_table()),
+    _pkb(pkb), _attributes(attributes)
 { 
     next_token();
 }
@@ -42,6 +49,10 @@ PqlQuerySet& SimplePqlParser::get_query_set() {
     return _query_set;
 }
 
+const RelationStatistics& SimplePqlParser::get_statistics() {
+    return _statistics;
+}
+
 PqlQuerySet SimplePqlParser::parse_query() {
     while(!current_token_is<EOFToken>()) {
         std::string first_word = current_token_as_keyword();
@@ -79,7 +90,7 @@ void SimplePqlParser::parse_predicate() {
         pred = get_predicate("var");
     } else if(keyword == "call") {
         pred = get_predicate("call");
-    } else if (keyword == "const") {
+    } else if(keyword == "const" || keyword == "constant") {
         pred = get_predicate("const");
     } else {
         pred = get_predicate(keyword);
@@ -105,6 +116,9 @@ void SimplePqlParser::parse_predicate() {
 void SimplePqlParser::parse_main_query() {
     _query_set.selector = parse_selector();
 
+    // "and" continues the previous kind of clause
+    std::string clause_type;
+
     while(!(current_token_is<EOFToken>() || 
                 current_token_is<SemiColonToken>())) 
     {
@@ -114,19 +128,21 @@ void SimplePqlParser::parse_main_query() {
         if(keyword == "such") {
             if(current_token_as_keyword() != "that") {
                 throw PqlParserError();
-            } else {
-                next_token(); // eat "that"
-
-                _query_set.clauses.insert(parse_clause());
             }
-        } else if(keyword == "and") {
-                _query_set.clauses.insert(parse_clause());
-        } else if(keyword == "with") {
+            next_token(); // eat "that"
+            clause_type = keyword;
+        } else if(keyword == "with" || keyword == "pattern") {
+            clause_type = keyword;
+        } else if(keyword != "and" || clause_type.empty()) {
+            throw PqlParserError();
+        }
+
+        if(clause_type == "such") {
+            _query_set.clauses.insert(parse_clause());
+        } else if(clause_type == "with") {
             parse_with();
-        } else if(keyword == "pattern") {
-            parse_pattern();
         } else {
-            throw PqlParserError();
+            parse_pattern();
         }
     }
 }
@@ -201,7 +217,7 @@ PqlTerm* SimplePqlParser::parse_term() {
         int line = current_token_as<IntegerToken>()->get_value();
         next_token();
         return new SimplePqlConditionTerm(
-               new SimpleStatementCondition(get_statement(line)));
+               _condition_table->get_statement_condition(get_statement(line)));
         
     } else if(current_token_is<IdentifierToken>()) {
         std::string var_name = current_token_as<
@@ -221,22 +237,197 @@ PqlTerm* SimplePqlParser::parse_term() {
 ConditionPtr SimplePqlParser::parse_condition(const std::string& name) {
     ProcAst *proc = _ast.get_proc(name);
     if(proc) {
-        return new SimpleProcCondition(proc);
+        return _condition_table->get_proc_condition(proc);
     } else {
-        return new SimpleVariableCondition(SimpleVariable(name));
+        SimpleVariable var(name);
+        return _condition_table->get_variable_condition(&var);
     }
 }
 
 void SimplePqlParser::parse_pattern() {
-    throw PqlParserError(); // not implemented
+    PqlTerm *assign_term = new SimplePqlVariableTerm(
+            current_token_as<IdentifierToken>()->get_content());
+    next_token(); // eat assignment qvar
+
+    current_token_as<OpenBracketToken>();
+    next_token();
+
+    PqlTerm *var_term;
+    if(current_token_is<LiteralToken>()) {
+        SimpleVariable var(current_token_as<LiteralToken>()->get_content());
+        var_term = new SimplePqlConditionTerm(
+                _condition_table->get_variable_condition(&var));
+        next_token();
+    } else {
+        var_term = parse_term();
+    }
+
+    current_token_as<CommaToken>();
+    next_token();
+
+    PatternType type = PATTERN_EXACT;
+    std::unique_ptr<ExprAst> expr;
+
+    if(current_token_is<WildCardToken>()) {
+        next_token(); // eat '_'
+        type = PATTERN_ANY;
+
+        if(current_token_is<LiteralToken>()) {
+            expr.reset(parse_expr_literal());
+            current_token_as<WildCardToken>();
+            next_token(); // eat closing '_'
+            type = PATTERN_SUBEXPR;
+        }
+    } else {
+        expr.reset(parse_expr_literal());
+    }
+
+    current_token_as<CloseBracketToken>();
+    next_token();
+
+    PatternSolver *pattern_solver = new PatternSolver(_ast, _pkb, expr.get(), type);
+    std::shared_ptr<QuerySolver> solver(
+            new SimpleSolverGenerator<PatternSolver>(pattern_solver));
+    _statistics[solver.get()] = pattern_solver->get_size();
+
+    _query_set.clauses.insert(ClausePtr(
+                new SimplePqlClause(solver, assign_term, var_term)));
 }
 
 void SimplePqlParser::parse_with() {
-    throw PqlParserError(); // not implemented
+    if(!_attributes) {
+        _attributes.reset(new AttributeIndex(_condition_table));
+    }
+
+    Attribute left_attr, right_attr;
+    int left_key, right_key;
+    bool left_bound, right_bound;
+
+    PqlTerm *left_term = parse_attribute_ref(left_attr, left_key, left_bound);
+
+    current_token_as<EqualToken>();
+    next_token();
+
+    PqlTerm *right_term = parse_attribute_ref(right_attr, right_key, right_bound);
+
+    if(AttributeIndex::is_name(left_attr) != AttributeIndex::is_name(right_attr)) {
+        throw PqlParserError();
+    }
+
+    WithSolver *with_solver = new WithSolver(_attributes, left_attr, right_attr);
+    std::shared_ptr<QuerySolver> solver(
+            new SimpleSolverGenerator<WithSolver>(with_solver));
+
+    // a bound side is a single probe into the index
+    if(left_bound && right_bound) {
+        _statistics[solver.get()] = 1;
+    } else if(left_bound) {
+        _statistics[solver.get()] = _attributes->find(right_attr, left_key).get_size();
+    } else if(right_bound) {
+        _statistics[solver.get()] = _attributes->find(left_attr, right_key).get_size();
+    } else {
+        _statistics[solver.get()] = with_solver->get_size();
+    }
+
+    _query_set.clauses.insert(ClausePtr(
+                new SimplePqlClause(solver, left_term, right_term)));
+}
+
+/*
+ * Names are compared as variable names and integers as constant
+ * values. The key of a bound ref is its attribute value.
+ */
+PqlTerm* SimplePqlParser::parse_attribute_ref(Attribute& attr, int& key, bool& bound) {
+    bound = true;
+
+    if(current_token_is<LiteralToken>()) {
+        SimpleVariable var(current_token_as<LiteralToken>()->get_content());
+        next_token();
+
+        attr = ATTR_VAR_NAME;
+        key = var.get_symbol();
+        return new SimplePqlConditionTerm(
+                _condition_table->get_variable_condition(&var));
+
+    } else if(current_token_is<IntegerToken>()) {
+        SimpleConstant constant(current_token_as<IntegerToken>()->get_value());
+        next_token();
+
+        attr = ATTR_VALUE;
+        key = constant.get_int();
+        return new SimplePqlConditionTerm(
+                _condition_table->get_constant_condition(&constant));
+    }
+
+    std::string qvar = current_token_as<IdentifierToken>()->get_content();
+    next_token(); // eat var name
+
+    std::string name;
+    if(current_token_is<DotToken>()) {
+        next_token(); // eat '.'
+        name = current_token_as_keyword();
+        next_token(); // eat attribute name
+    }
+
+    bound = false;
+    attr = get_attribute(qvar, name);
+    return new SimplePqlVariableTerm(qvar);
+}
+
+/*
+ * A query variable without an attribute stands for its statement
+ * number, value or name.
+ */
+Attribute SimplePqlParser::get_attribute(const std::string& qvar, 
+        const std::string& name) 
+{
+    if(_query_set.predicates.count(qvar) == 0) {
+        throw PqlParserError();
+    }
+
+    std::string pred = _query_set.predicates[qvar]->get_predicate_name();
+    bool is_statement = pred == "statement" || pred == "assign" || 
+        pred == "while" || pred == "if" || pred == "call";
+
+    if(name == "procname" && pred == "procedure") {
+        return ATTR_PROC_NAME;
+    } else if(name == "procname" && pred == "call") {
+        return ATTR_CALL_NAME;
+    } else if((name == "varname" || name.empty()) && pred == "variable") {
+        return ATTR_VAR_NAME;
+    } else if((name == "value" || name.empty()) && pred == "constant") {
+        return ATTR_VALUE;
+    } else if((name == "stmt#" || name.empty()) && is_statement) {
+        return ATTR_STMT_NUMBER;
+    } else if(name.empty() && pred == "procedure") {
+        return ATTR_PROC_NAME;
+    } else {
+        throw PqlParserError();
+    }
 }
 
 std::shared_ptr<PqlSelector> SimplePqlParser::parse_tuple_selector() {
-    throw PqlParserError(); // not implemented
+    next_token(); // eat '<'
+
+    std::shared_ptr<SimplePqlTupleSelector> selector(
+            new SimplePqlTupleSelector());
+
+    while(true) {
+        selector->insert_qvar(current_token_as<
+                IdentifierToken>()->get_content());
+        next_token(); // eat var name
+
+        if(current_token_is<CommaToken>()) {
+            next_token(); // eat ','
+        } else if(current_token_is<MoreThanToken>()) {
+            next_token(); // eat '>'
+            break;
+        } else {
+            throw PqlParserError();
+        }
+    }
+
+    return selector;
 }
 
 std::string SimplePqlParser::current_token_as_keyword() {
@@ -265,6 +456,23 @@ PredicatePtr SimplePqlParser::get_predicate(const std::string& name) {
     return _pred_table[name];
 }
 
+/*
+ * Parses the expression in the current literal token, which has to
+ * hold nothing else.
+ */
+ExprAst* SimplePqlParser::parse_expr_literal() {
+    std::string content = current_token_as<LiteralToken>()->get_content();
+    next_token();
+
+    SimpleParser parser(new BufferTokenizer(
+                content.data(), content.data() + content.size()));
+
+    std::unique_ptr<ExprAst> expr(parser.parse_expr());
+    parser.current_token_as<EOFToken>();
+
+    return expr.release();
+}
+
 StatementAst* SimplePqlParser::get_statement(int line) {
     if(_line_table.count(line) == 0) {
         throw PqlParserError();
@@ -24,6 +24,12 @@
 #include "simple/query.h"
 #include "simple/solver.h"
 #include "impl/condition.h"
+#include "impl/condition_table.h"
+#include "impl/pkb.h"
+#include "impl/solvers/pattern.h"
+#include "impl/solvers/with.h"
+#include "impl/attribute_index.h"
+#include "impl/planner.h"
 #include "impl/parser/tokenizer.h"
 #include "impl/query.h"
 
@@ -37,15 +43,27 @@ class PqlParserError : public std::exception { };
 
 class SimplePqlParser {
   public:
+    /*
+     * Pattern clauses are solved against the PKB, and the conditions
+     * in the query are interned in the condition table of the PKB.
+     */
     SimplePqlParser(
             std::shared_ptr<SimpleTokenizer> tokenizer, 
             const SimpleRoot& ast,
             const LineTable& line_table,
             const SolverTable& solver_table,
-            const PredicateTable& pred_table);
+            const PredicateTable& pred_table,
+            PkbPtr pkb,
+            AttributeIndexPtr attributes = AttributeIndexPtr());
 
     PqlQuerySet& get_query_set();
 
+    /*
+     * The relation sizes of the solvers made for single pattern and
+     * with clauses, which the front end has no statistics for.
+     */
+    const RelationStatistics& get_statistics();
+
     PqlQuerySet parse_query();
 
     void parse_predicate();
@@ -60,8 +78,16 @@ class SimplePqlParser {
 
     ConditionPtr parse_condition(const std::string& name);
 
+    /*
+     * pattern a(v, "expr"), a(v, _"expr"_) or a(v, _), where v may
+     * also be a variable name or a wildcard.
+     */
     void parse_pattern();
 
+    /*
+     * with ref = ref, where a ref is an attribute such as p.procName,
+     * v.varName, c.value or s.stmt#, a prog_line, a name or an integer.
+     */
     void parse_with();
     
     std::shared_ptr<PqlSelector> parse_tuple_selector();
@@ -96,6 +122,12 @@ class SimplePqlParser {
 
     StatementAst* get_statement(int line);
 
+    ExprAst* parse_expr_literal();
+
+    PqlTerm* parse_attribute_ref(Attribute& attr, int& key, bool& bound);
+
+    Attribute get_attribute(const std::string& qvar, const std::string& name);
+
   private:
     std::shared_ptr<SimpleTokenizer> _tokenizer;
 
@@ -103,6 +135,10 @@ class SimplePqlParser {
     LineTable       _line_table;
     SolverTable     _solver_table;
     PredicateTable  _pred_table;
+    ConditionTablePtr _condition_table;
+    PkbPtr          _pkb;
+    AttributeIndexPtr _attributes;
+    RelationStatistics _statistics;
     PqlQuerySet     _query_set;
 
     SimpleToken     *_current_token;
@@ -240,6 +240,10 @@ class IntegerToken : public SimpleToken {
   public:
     IntegerToken(int value) : _value(value) { }
 
+    void set_value(int value) {
+        _value = value;
+    }
+
     int get_value() const {
         return _value;
     }
@@ -259,6 +263,10 @@ class LiteralToken : public SimpleToken {
         _content(content)
     { }
 
+    void set_content(const char *begin, const char *end) {
+        _content.assign(begin, end);
+    }
+
     const std::string& get_content() const {
         return _content;
     }
@@ -279,6 +287,10 @@ class IdentifierToken : public SimpleToken {
         _content(content)
     { }
 
+    void set_content(const char *begin, const char *end) {
+        _content.assign(begin, end);
+    }
+
     const std::string& get_content() const {
         return _content;
     }
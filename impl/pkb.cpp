@@ -0,0 +1,599 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "impl/pkb.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+SimplePkb::SimplePkb(SimpleRoot ast, ConditionTablePtr table, ClosureMode mode) :
+    _ast(ast), _table(table), _flat(ast), _cfg(ast, table, _flat), 
+    _expr_index(_flat),
+    _words(0), _first_variable_id(-1),
+    _statement_range(-1, -1), _proc_range(-1, -1)
+{
+    index_ids();
+    index_procs();
+    build_relations(mode);
+}
+
+SimplePkb::SimplePkb(SimpleRoot ast, ConditionTablePtr table,
+        const SimplePkb& previous, const std::set<ProcAst*>& reused,
+        ClosureMode mode) :
+    SimplePkb(ast, table, previous, 
+            find_proc_shifts(ast, table, previous, reused), mode)
+{ }
+
+SimplePkb::SimplePkb(SimpleRoot ast, ConditionTablePtr table,
+        const SimplePkb& previous, const std::vector<ProcShift>& shifts,
+        ClosureMode mode) :
+    _ast(ast), _table(table), _flat(ast), 
+    _cfg(ast, table, _flat, previous._cfg, shifts), _expr_index(_flat),
+    _words(0), _first_variable_id(-1),
+    _statement_range(-1, -1), _proc_range(-1, -1)
+{
+    index_ids();
+
+    std::map<ProcAst*, int> procs;
+    for(int p = 0; p < _flat.get_proc_count(); ++p) {
+        procs[_flat.get_proc_ast(p)] = p;
+    }
+
+    // copied procedures are already indexed when their callers are
+    for(size_t i = 0; i < shifts.size(); ++i) {
+        copy_proc(previous, shifts[i], procs[shifts[i].proc]);
+    }
+    std::vector<int>().swap(_id_map);
+
+    index_procs();
+    build_relations(mode);
+}
+
+void SimplePkb::build_relations(ClosureMode mode) {
+    ConditionUniversePtr universe = _table->get_universe();
+    _follows.build(universe);
+    _parent.build(universe);
+    _calls.build(universe);
+    _modifies.build(universe);
+    _uses.build(universe);
+
+    // the ranges are contiguous since conditions are sorted by type first
+    int statement_count = _statement_range.first == -1 ? 0 :
+        _statement_range.second - _statement_range.first + 1;
+    int proc_count = _proc_range.first == -1 ? 0 :
+        _proc_range.second - _proc_range.first + 1;
+
+    _ifollows.build(_follows, universe, 
+            _statement_range.first, statement_count, mode);
+    _iparent.build(_parent, universe, 
+            _statement_range.first, statement_count, mode);
+    _icalls.build(_calls, universe, 
+            _proc_range.first, proc_count, CLOSURE_MATRIX);
+
+    std::vector<int>().swap(_statement_ids);
+    std::vector<int>().swap(_proc_ids);
+    std::vector<int>().swap(_variable_ids);
+    std::vector<int>().swap(_variable_numbers);
+    std::vector<char>().swap(_proc_state);
+    std::vector<Word>().swap(_proc_variables);
+    std::vector< std::vector<Word> >().swap(_scratch);
+}
+
+SimplePkb::SimplePkb(SimpleRoot ast, ConditionTablePtr table, 
+        SnapshotReader& in) :
+    _ast(ast), _table(table), _flat(ast), _cfg(ast, table, in),
+    _expr_index(_flat),
+    _words(0), _first_variable_id(-1),
+    _statement_range(-1, -1), _proc_range(-1, -1)
+{
+    ConditionUniversePtr universe = _table->get_universe();
+    _follows.load(in, universe);
+    _parent.load(in, universe);
+    _calls.load(in, universe);
+    _modifies.load(in, universe);
+    _uses.load(in, universe);
+
+    _ifollows.load(in, universe);
+    _iparent.load(in, universe);
+    _icalls.load(in, universe);
+}
+
+void SimplePkb::save(SnapshotWriter& out) const {
+    _cfg.save(out);
+
+    _follows.save(out);
+    _parent.save(out);
+    _calls.save(out);
+    _modifies.save(out);
+    _uses.save(out);
+
+    _ifollows.save(out);
+    _iparent.save(out);
+    _icalls.save(out);
+}
+
+ConditionTablePtr SimplePkb::get_condition_table() {
+    return _table;
+}
+
+namespace {
+
+enum ProcState {
+    PROC_PENDING,
+    PROC_INDEXED
+};
+
+inline void set_bit(unsigned long long *bits, int number) {
+    bits[number / 64] |= 1ULL << (number % 64);
+}
+
+int find_interned_id(const ConditionTablePtr& table, const ConditionPtr& condition) {
+    if(condition.get_table() == table.get()) {
+        return condition.get_id();
+    } else {
+        return -1;
+    }
+}
+
+}
+
+/*
+ * A procedure can only be copied if both the old and the new table
+ * know it. Procedures that cannot be copied are indexed again.
+ */
+std::vector<ProcShift> SimplePkb::find_proc_shifts(SimpleRoot ast,
+        ConditionTablePtr table, const SimplePkb& previous,
+        const std::set<ProcAst*>& reused)
+{
+    std::vector<ProcShift> shifts;
+
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        ProcAst *proc = *it;
+        if(reused.count(proc) == 0) {
+            continue;
+        }
+
+        ProcShift shift;
+        shift.proc = proc;
+        shift.old_proc_id = find_interned_id(previous._table,
+                previous._table->get_proc_condition(proc));
+        shift.new_proc_id = find_interned_id(table,
+                table->get_proc_condition(proc));
+        shift.old_first = find_interned_id(previous._table,
+                previous._table->get_statement_condition(proc->get_statement()));
+        shift.new_first = find_interned_id(table,
+                table->get_statement_condition(proc->get_statement()));
+        shift.size = previous._cfg.get_proc_size(shift.old_first);
+
+        if(shift.old_proc_id != -1 && shift.new_proc_id != -1 &&
+           shift.old_first != -1 && shift.new_first != -1 && shift.size > 0)
+        {
+            shifts.push_back(shift);
+        }
+    }
+
+    return shifts;
+}
+
+void SimplePkb::copy_proc(const SimplePkb& previous, const ProcShift& shift,
+        int proc)
+{
+    int offset = shift.new_first - shift.old_first;
+
+    Word *variables = &_proc_variables[proc * 2 * _words];
+    copy_mapped_rows(previous, previous._modifies, _modifies,
+            shift.old_proc_id, shift.new_proc_id, variables);
+    copy_mapped_rows(previous, previous._uses, _uses,
+            shift.old_proc_id, shift.new_proc_id, variables + _words);
+    copy_mapped_rows(previous, previous._calls, _calls,
+            shift.old_proc_id, shift.new_proc_id, NULL);
+    _proc_state[proc] = PROC_INDEXED;
+
+    for(int id = shift.old_first; id < shift.old_first + shift.size; ++id) {
+        copy_rows(previous._follows, _follows, id, id + offset, offset);
+        copy_rows(previous._parent, _parent, id, id + offset, offset);
+        copy_mapped_rows(previous, previous._modifies, _modifies, 
+                id, id + offset, NULL);
+        copy_mapped_rows(previous, previous._uses, _uses, 
+                id, id + offset, NULL);
+    }
+}
+
+void SimplePkb::copy_rows(const RelationTable& from, RelationTable& to,
+        int old_id, int new_id, int offset)
+{
+    for(RelationTable::id_iterator it = from.right_begin(old_id);
+            it != from.right_end(old_id); ++it)
+    {
+        to.add_pair(new_id, *it + offset);
+    }
+}
+
+void SimplePkb::copy_mapped_rows(const SimplePkb& previous, 
+        const RelationTable& from, RelationTable& to, 
+        int old_id, int new_id, Word *variables)
+{
+    for(RelationTable::id_iterator it = from.right_begin(old_id);
+            it != from.right_end(old_id); ++it)
+    {
+        int id = map_id(previous, *it);
+        to.add_pair(new_id, id);
+
+        int number = id - _first_variable_id;
+        if(variables != NULL && _first_variable_id != -1 && number >= 0 &&
+           number < static_cast<int>(_variable_numbers.size()) &&
+           _variable_numbers[number] != -1)
+        {
+            set_bit(variables, _variable_numbers[number]);
+        }
+    }
+}
+
+/*
+ * Variables and procedures are found in the new table by their names.
+ */
+int SimplePkb::map_id(const SimplePkb& previous, int old_id) {
+    if(_id_map.empty()) {
+        _id_map.assign(previous._table->get_size(), -2);
+    }
+
+    int& id = _id_map[old_id];
+    if(id == -2) {
+        id = get_interned_id(_table->intern(
+                previous._table->get_condition(old_id)));
+    }
+    return id;
+}
+
+int SimplePkb::get_interned_id(const ConditionPtr& condition) {
+    if(condition.get_table() == _table.get()) {
+        return condition.get_id();
+    } else {
+        return -1;
+    }
+}
+
+int SimplePkb::get_statement_id(StatementAst *statement) {
+    return get_interned_id(_table->get_statement_condition(statement));
+}
+
+int SimplePkb::get_proc_id(ProcAst *proc) {
+    return get_interned_id(_table->get_proc_condition(proc));
+}
+
+int SimplePkb::get_variable_id(SimpleVariable *var) {
+    return get_interned_id(_table->get_variable_condition(var));
+}
+
+const RelationTable& SimplePkb::get_follows() const {
+    return _follows;
+}
+
+const RelationTable& SimplePkb::get_parent() const {
+    return _parent;
+}
+
+const RelationTable& SimplePkb::get_calls() const {
+    return _calls;
+}
+
+const RelationTable& SimplePkb::get_modifies() const {
+    return _modifies;
+}
+
+const RelationTable& SimplePkb::get_uses() const {
+    return _uses;
+}
+
+const ClosureTable& SimplePkb::get_ifollows() const {
+    return _ifollows;
+}
+
+const ClosureTable& SimplePkb::get_iparent() const {
+    return _iparent;
+}
+
+const ClosureTable& SimplePkb::get_icalls() const {
+    return _icalls;
+}
+
+const SimpleCfg& SimplePkb::get_cfg() const {
+    return _cfg;
+}
+
+const FlatAst& SimplePkb::get_flat_ast() const {
+    return _flat;
+}
+
+const ExprIndex& SimplePkb::get_expr_index() const {
+    return _expr_index;
+}
+
+/*
+ * Looks up the condition IDs of all statements, procedures and
+ * variables of the flat AST once.
+ */
+void SimplePkb::index_ids() {
+    _statement_ids.resize(_flat.get_statement_count());
+    for(int i = 0; i < _flat.get_statement_count(); ++i) {
+        _statement_ids[i] = get_statement_id(_flat.get_statement_ast(i));
+        add_range(_statement_ids[i], _statement_range);
+    }
+
+    _proc_ids.resize(_flat.get_proc_count());
+    for(int p = 0; p < _flat.get_proc_count(); ++p) {
+        _proc_ids[p] = get_proc_id(_flat.get_proc_ast(p));
+        add_range(_proc_ids[p], _proc_range);
+    }
+
+    std::pair<int, int> variable_range(-1, -1);
+    _variable_ids.resize(_flat.get_variable_count());
+    for(int v = 0; v < _flat.get_variable_count(); ++v) {
+        _variable_ids[v] = get_variable_id(_flat.get_variable_ast(v));
+        add_range(_variable_ids[v], variable_range);
+    }
+
+    _first_variable_id = variable_range.first;
+    if(variable_range.first != -1) {
+        _variable_numbers.assign(variable_range.second - variable_range.first + 1, -1);
+        for(int v = 0; v < _flat.get_variable_count(); ++v) {
+            if(_variable_ids[v] != -1) {
+                _variable_numbers[_variable_ids[v] - _first_variable_id] = v;
+            }
+        }
+    }
+
+    _words = (_flat.get_variable_count() + WORD_BITS - 1) / WORD_BITS;
+    _proc_state.assign(_flat.get_proc_count(), PROC_PENDING);
+    _proc_variables.assign(_flat.get_proc_count() * 2 * _words, 0);
+}
+
+/*
+ * Procedures are summarised once each, in reverse topological order of
+ * the call graph, so that every callee is summarised before its
+ * callers. The strongly connected components are found with Tarjan's
+ * algorithm without recursion, since call chains can be deep.
+ */
+void SimplePkb::index_procs() {
+    int proc_count = _flat.get_proc_count();
+
+    std::vector< std::vector<int> > callees(proc_count);
+    for(int i = 0; i < _flat.get_statement_count(); ++i) {
+        if(_flat.get_type(i) == FLAT_CALL && _flat.get_callee(i) != -1) {
+            callees[_flat.get_proc(i)].push_back(_flat.get_callee(i));
+        }
+    }
+
+    std::vector<int> number(proc_count, -1);
+    std::vector<int> low(proc_count, 0);
+    std::vector<char> on_stack(proc_count, 0);
+    std::vector<int> stack;
+    std::vector< std::pair<int, size_t> > frames;
+    int counter = 0;
+
+    for(int root = 0; root < proc_count; ++root) {
+        if(number[root] != -1) {
+            continue;
+        }
+
+        number[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = 1;
+        frames.push_back(std::make_pair(root, size_t(0)));
+
+        while(!frames.empty()) {
+            int v = frames.back().first;
+            size_t& edge = frames.back().second;
+
+            if(edge < callees[v].size()) {
+                int w = callees[v][edge++];
+                if(number[w] == -1) {
+                    number[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    on_stack[w] = 1;
+                    frames.push_back(std::make_pair(w, size_t(0)));
+                } else if(on_stack[w]) {
+                    low[v] = std::min(low[v], number[w]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if(!frames.empty()) {
+                int parent = frames.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+
+            if(low[v] == number[v]) {
+                std::vector<int> members;
+                int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = 0;
+                    members.push_back(w);
+                } while(w != v);
+
+                bool cyclic = members.size() > 1 || 
+                    std::find(callees[v].begin(), callees[v].end(), v) != callees[v].end();
+                index_component(members, cyclic);
+            }
+        }
+    }
+}
+
+/*
+ * The procedures of a cycle in the call graph call each other, so they
+ * all modify and use the same variables: everything their bodies and
+ * the procedures called from the cycle modify and use. That summary is
+ * found first, and the bodies are then indexed against it.
+ */
+void SimplePkb::index_component(const std::vector<int>& members, bool cyclic) {
+    if(cyclic) {
+        std::vector<Word> summary(2 * _words, 0);
+
+        for(size_t m = 0; m < members.size(); ++m) {
+            int proc = members[m];
+            if(_proc_state[proc] == PROC_INDEXED) {
+                continue;
+            }
+
+            std::vector<Word> variables(2 * _words, 0);
+            int begin = _flat.get_proc_begin(proc);
+            if(begin < _flat.get_proc_end(proc)) {
+                index_statement_list(begin, variables.data(), 0, false);
+            }
+            for(size_t k = 0; k < summary.size(); ++k) {
+                summary[k] |= variables[k];
+            }
+        }
+
+        for(size_t m = 0; m < members.size(); ++m) {
+            if(_proc_state[members[m]] != PROC_INDEXED) {
+                std::copy(summary.begin(), summary.end(), 
+                        _proc_variables.begin() + members[m] * 2 * _words);
+            }
+        }
+    }
+
+    for(size_t m = 0; m < members.size(); ++m) {
+        int proc = members[m];
+        if(_proc_state[proc] == PROC_INDEXED) {
+            continue;
+        }
+
+        Word *variables = &_proc_variables[proc * 2 * _words];
+        int begin = _flat.get_proc_begin(proc);
+        if(begin < _flat.get_proc_end(proc)) {
+            index_statement_list(begin, variables, 0, true);
+        }
+        add_variables(_proc_ids[proc], variables);
+
+        _proc_state[proc] = PROC_INDEXED;
+    }
+}
+
+/*
+ * Adds the variables of the statement list to the given bitset. Each
+ * nesting level has its own scratch bitset. The relations are only
+ * added when emit is set.
+ */
+void SimplePkb::index_statement_list(int statement, Word *result, int depth,
+        bool emit) 
+{
+    if(_scratch.size() <= static_cast<size_t>(depth)) {
+        _scratch.resize(depth + 1, std::vector<Word>(2 * _words));
+    }
+
+    for(int i = statement; i != -1; i = _flat.get_next(i)) {
+        Word *variables = _scratch[depth].data();
+        std::fill(variables, variables + 2 * _words, 0);
+
+        Word *modified = variables;
+        Word *used = variables + _words;
+
+        switch(_flat.get_type(i)) {
+            case FLAT_ASSIGNMENT:
+                set_bit(modified, _flat.get_variable(i));
+                for(int node = _flat.get_expr_begin(i); 
+                        node < _flat.get_expr_end(i); ++node) 
+                {
+                    if(_flat.get_expr_type(node) == FLAT_VARIABLE) {
+                        set_bit(used, _flat.get_expr_value(node));
+                    }
+                }
+            break;
+            case FLAT_CONDITIONAL:
+                set_bit(used, _flat.get_variable(i));
+                index_statement_list(_flat.get_first_child(i), variables, 
+                        depth + 1, emit);
+                index_statement_list(_flat.get_else_child(i), variables, 
+                        depth + 1, emit);
+            break;
+            case FLAT_WHILE:
+                set_bit(used, _flat.get_variable(i));
+                index_statement_list(_flat.get_first_child(i), variables, 
+                        depth + 1, emit);
+            break;
+            case FLAT_CALL:
+                if(_flat.get_callee(i) != -1) {
+                    int callee = _flat.get_callee(i);
+                    const Word *callee_variables = &_proc_variables[callee * 2 * _words];
+                    for(size_t k = 0; k < 2 * _words; ++k) {
+                        variables[k] |= callee_variables[k];
+                    }
+                    if(emit) {
+                        _calls.add_pair(_proc_ids[_flat.get_proc(i)], _proc_ids[callee]);
+                    }
+                }
+            break;
+        }
+
+        for(size_t k = 0; k < 2 * _words; ++k) {
+            result[k] |= variables[k];
+        }
+        if(!emit) {
+            continue;
+        }
+
+        int id = _statement_ids[i];
+        if(_flat.get_next(i) != -1) {
+            _follows.add_pair(id, _statement_ids[_flat.get_next(i)]);
+        }
+        if(_flat.get_parent(i) != -1) {
+            _parent.add_pair(_statement_ids[_flat.get_parent(i)], id);
+        }
+
+        add_variables(id, variables);
+    }
+}
+
+void SimplePkb::add_variables(int id, const Word *variables) {
+    for(size_t k = 0; k < _words; ++k) {
+        for(Word bits = variables[k]; bits != 0; bits &= bits - 1) {
+            int number = k * WORD_BITS + __builtin_ctzll(bits);
+            _modifies.add_pair(id, _variable_ids[number]);
+        }
+
+        for(Word bits = variables[_words + k]; bits != 0; bits &= bits - 1) {
+            int number = k * WORD_BITS + __builtin_ctzll(bits);
+            _uses.add_pair(id, _variable_ids[number]);
+        }
+    }
+}
+
+void SimplePkb::add_range(int id, std::pair<int, int>& range) {
+    if(id == -1) {
+        return;
+    }
+
+    if(range.first == -1) {
+        range = std::make_pair(id, id);
+    } else {
+        range.first = std::min(range.first, id);
+        range.second = std::max(range.second, id);
+    }
+}
+
+SimplePkb::~SimplePkb() { }
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,179 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "simple/ast.h"
+#include "simple/condition_set.h"
+#include "simple/condition_table.h"
+#include "impl/condition_table.h"
+#include "impl/relation_table.h"
+#include "impl/flat_ast.h"
+#include "impl/expr_index.h"
+#include "impl/cfg.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * SimplePkb is the program knowledge base. It is built once from the
+ * program AST after parsing and holds the Follows, Parent, Calls,
+ * Modifies and Uses relations keyed by the IDs of the shared condition
+ * table, so that solvers answer queries with table lookups instead of
+ * walking the AST.
+ */
+class SimplePkb {
+  public:
+    SimplePkb(SimpleRoot ast, ConditionTablePtr table, 
+            ClosureMode mode = CLOSURE_AUTO);
+
+    /*
+     * Loads the relations from a snapshot of a PKB built over the same
+     * program, with the same condition IDs.
+     */
+    SimplePkb(SimpleRoot ast, ConditionTablePtr table, SnapshotReader& in);
+
+    void save(SnapshotWriter& out) const;
+
+    /*
+     * Rebuilds the PKB after the program was edited. The relations of
+     * the reused procedures are copied from the previous PKB, which
+     * must have been built over the same procedure and statement
+     * nodes. A reused procedure may only call reused procedures, as
+     * its Modifies and Uses depend on its callees.
+     */
+    SimplePkb(SimpleRoot ast, ConditionTablePtr table,
+            const SimplePkb& previous, const std::set<ProcAst*>& reused,
+            ClosureMode mode = CLOSURE_AUTO);
+
+    ConditionTablePtr get_condition_table();
+
+    /*
+     * Returns -1 if the AST node is not part of the program.
+     */
+    int get_statement_id(StatementAst *statement);
+    int get_proc_id(ProcAst *proc);
+    int get_variable_id(SimpleVariable *var);
+
+    const RelationTable& get_follows() const;
+    const RelationTable& get_parent() const;
+    const RelationTable& get_calls() const;
+    const RelationTable& get_modifies() const;
+    const RelationTable& get_uses() const;
+
+    const ClosureTable& get_ifollows() const;
+    const ClosureTable& get_iparent() const;
+    const ClosureTable& get_icalls() const;
+
+    const SimpleCfg& get_cfg() const;
+    const FlatAst& get_flat_ast() const;
+    const ExprIndex& get_expr_index() const;
+
+    ~SimplePkb();
+
+  private:
+    typedef unsigned long long Word;
+    static const size_t WORD_BITS = 64;
+
+    SimplePkb(SimpleRoot ast, ConditionTablePtr table,
+            const SimplePkb& previous, const std::vector<ProcShift>& shifts,
+            ClosureMode mode);
+
+    static std::vector<ProcShift> find_proc_shifts(SimpleRoot ast,
+            ConditionTablePtr table, const SimplePkb& previous,
+            const std::set<ProcAst*>& reused);
+
+    void build_relations(ClosureMode mode);
+
+    void copy_proc(const SimplePkb& previous, const ProcShift& shift, int proc);
+    void copy_rows(const RelationTable& from, RelationTable& to,
+            int old_id, int new_id, int offset);
+    void copy_mapped_rows(const SimplePkb& previous, const RelationTable& from,
+            RelationTable& to, int old_id, int new_id, Word *variables);
+    int map_id(const SimplePkb& previous, int old_id);
+
+    int get_interned_id(const ConditionPtr& condition);
+
+    void index_ids();
+    void index_procs();
+    void index_component(const std::vector<int>& members, bool cyclic);
+    void index_statement_list(int statement, Word *variables, int depth,
+            bool emit);
+    void add_variables(int id, const Word *variables);
+    void add_range(int id, std::pair<int, int>& range);
+
+    SimpleRoot          _ast;
+    ConditionTablePtr   _table;
+
+    RelationTable   _follows;
+    RelationTable   _parent;
+    RelationTable   _calls;
+    RelationTable   _modifies;
+    RelationTable   _uses;
+
+    ClosureTable    _ifollows;
+    ClosureTable    _iparent;
+    ClosureTable    _icalls;
+
+    FlatAst         _flat;
+    SimpleCfg       _cfg;
+    ExprIndex       _expr_index;
+
+    /*
+     * Only used while the relations are being built. The variables of
+     * a statement are a bitset over the variable numbers of the flat
+     * AST, holding the modified variables followed by the used ones.
+     */
+    size_t              _words;
+    std::vector<int>    _statement_ids;
+    std::vector<int>    _proc_ids;
+    std::vector<int>    _variable_ids;
+    std::vector<int>    _variable_numbers;
+    int                 _first_variable_id;
+    std::vector<char>   _proc_state;
+    std::vector<Word>   _proc_variables;
+    std::vector< std::vector<Word> > _scratch;
+    std::pair<int, int> _statement_range;
+    std::pair<int, int> _proc_range;
+    std::vector<int>    _id_map;
+};
+
+typedef std::shared_ptr<SimplePkb> PkbPtr;
+
+/*
+ * Solvers share the PKB built by the front end, but build their own
+ * PKB when they are constructed on their own.
+ */
+inline PkbPtr make_pkb(SimpleRoot ast, PkbPtr pkb) {
+    if(pkb) {
+        return pkb;
+    } else {
+        return PkbPtr(new SimplePkb(ast, ConditionTablePtr(
+                        new SimpleConditionTable(ast))));
+    }
+}
+
+} // namespace impl
+} // namespace simple
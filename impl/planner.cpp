@@ -0,0 +1,230 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "impl/planner.h"
+#include "simple/util/query_utils.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+using namespace simple::util;
+
+/*
+ * Weights of each kind of term. Query variables that earlier clauses
+ * have already narrowed down count as partly bound.
+ */
+static const double CONDITION_WEIGHT = 0.01;
+static const double BOUND_QVAR_WEIGHT = 0.1;
+static const double WILDCARD_WEIGHT = 0.5;
+static const double FREE_QVAR_WEIGHT = 1.0;
+
+SimpleQueryPlanner::SimpleQueryPlanner(const RelationStatistics& statistics) :
+    _statistics(statistics), _default_size(1)
+{
+    // solvers without statistics are assumed to be the most expensive
+    for(RelationStatistics::iterator it = _statistics.begin();
+            it != _statistics.end(); ++it)
+    {
+        _default_size = std::max(_default_size, it->second);
+    }
+}
+
+QueryPlan SimpleQueryPlanner::plan(const ClauseSet& clauses) {
+    std::vector<ClauseInfo> infos;
+    for(ClauseSet::const_iterator it = clauses.begin(); it != clauses.end(); ++it) {
+        infos.push_back(get_clause_info(*it));
+    }
+
+    /*
+     * Find the connected groups by merging the groups of all query
+     * variables that appear in the same clause.
+     */
+    std::map<std::string, size_t> qvar_groups;
+    std::vector<size_t> group_of(infos.size());
+    std::vector<size_t> parent;
+
+    for(size_t i = 0; i < infos.size(); ++i) {
+        size_t group = parent.size();
+        parent.push_back(group);
+
+        for(size_t k = 0; k < infos[i].qvars.size(); ++k) {
+            const std::string& qvar = infos[i].qvars[k];
+            if(qvar_groups.count(qvar) == 0) {
+                qvar_groups[qvar] = group;
+                continue;
+            }
+
+            size_t other = qvar_groups[qvar];
+            while(parent[other] != other) {
+                other = parent[other];
+            }
+            parent[other] = group;
+        }
+        group_of[i] = group;
+    }
+
+    std::map<size_t, std::vector<ClauseInfo> > grouped;
+    std::vector<ClauseInfo> constant_clauses;
+
+    for(size_t i = 0; i < infos.size(); ++i) {
+        if(infos[i].qvars.empty()) {
+            constant_clauses.push_back(infos[i]);
+            continue;
+        }
+
+        size_t root = group_of[i];
+        while(parent[root] != root) {
+            root = parent[root];
+        }
+        grouped[root].push_back(infos[i]);
+    }
+
+    QueryPlan result;
+    if(!constant_clauses.empty()) {
+        ClauseGroup group;
+        group.clauses = order_group(constant_clauses);
+        result.push_back(group);
+    }
+
+    std::vector< std::pair<double, size_t> > costs;
+    std::vector<ClauseGroup> groups;
+
+    for(std::map<size_t, std::vector<ClauseInfo> >::iterator it = grouped.begin();
+            it != grouped.end(); ++it)
+    {
+        ClauseGroup group;
+        for(size_t i = 0; i < it->second.size(); ++i) {
+            group.qvars.insert(it->second[i].qvars.begin(), 
+                    it->second[i].qvars.end());
+        }
+        group.clauses = order_group(it->second);
+
+        costs.push_back(std::make_pair(estimate_cost(group.clauses.front().get(),
+                        std::set<std::string>()), groups.size()));
+        groups.push_back(group);
+    }
+
+    // the group with the cheapest first clause runs first
+    std::stable_sort(costs.begin(), costs.end());
+    for(size_t i = 0; i < costs.size(); ++i) {
+        result.push_back(groups[costs[i].second]);
+    }
+
+    return result;
+}
+
+/*
+ * Greedily pick the cheapest clause, preferring clauses that share a
+ * query variable with the clauses already picked so that the linker
+ * can use the narrowed down variables.
+ */
+ClauseList SimpleQueryPlanner::order_group(std::vector<ClauseInfo>& infos) {
+    ClauseList result;
+    std::set<std::string> bound_qvars;
+    std::vector<char> picked(infos.size(), 0);
+
+    for(size_t n = 0; n < infos.size(); ++n) {
+        int best = -1;
+        bool best_connected = false;
+        double best_cost = 0;
+
+        for(size_t i = 0; i < infos.size(); ++i) {
+            if(picked[i]) {
+                continue;
+            }
+
+            bool connected = false;
+            for(size_t k = 0; k < infos[i].qvars.size(); ++k) {
+                connected = connected || bound_qvars.count(infos[i].qvars[k]) > 0;
+            }
+
+            double cost = estimate_cost(infos[i].clause.get(), bound_qvars);
+            if(best == -1 || (connected && !best_connected) ||
+                    (connected == best_connected && cost < best_cost))
+            {
+                best = i;
+                best_connected = connected;
+                best_cost = cost;
+            }
+        }
+
+        picked[best] = 1;
+        result.push_back(infos[best].clause);
+        bound_qvars.insert(infos[best].qvars.begin(), infos[best].qvars.end());
+    }
+
+    return result;
+}
+
+double SimpleQueryPlanner::estimate_cost(PqlClause *clause,
+        const std::set<std::string>& bound_qvars)
+{
+    return get_relation_size(clause->get_solver()) * 
+        get_term_weight(clause->get_left_term(), bound_qvars) *
+        get_term_weight(clause->get_right_term(), bound_qvars);
+}
+
+SimpleQueryPlanner::ClauseInfo SimpleQueryPlanner::get_clause_info(
+        const ClausePtr& clause)
+{
+    ClauseInfo info(clause);
+
+    PqlTerm *terms[] = { clause->get_left_term(), clause->get_right_term() };
+    for(int i = 0; i < 2; ++i) {
+        PqlTermInfo term(terms[i]);
+
+        if(term.is_qvar() && 
+                std::find(info.qvars.begin(), info.qvars.end(), 
+                    term.get_qvar()) == info.qvars.end())
+        {
+            info.qvars.push_back(term.get_qvar());
+        }
+    }
+    return info;
+}
+
+double SimpleQueryPlanner::get_term_weight(PqlTerm *term,
+        const std::set<std::string>& bound_qvars)
+{
+    PqlTermInfo info(term);
+
+    if(info.is_condition()) {
+        return CONDITION_WEIGHT;
+    } else if(info.is_wildcard()) {
+        return WILDCARD_WEIGHT;
+    } else if(bound_qvars.count(info.get_qvar()) > 0) {
+        return BOUND_QVAR_WEIGHT;
+    } else {
+        return FREE_QVAR_WEIGHT;
+    }
+}
+
+size_t SimpleQueryPlanner::get_relation_size(QuerySolver *solver) {
+    RelationStatistics::iterator it = _statistics.find(solver);
+    if(it != _statistics.end()) {
+        // an empty relation is the cheapest, but still costs something
+        return std::max(it->second, size_t(1));
+    } else {
+        return _default_size;
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,90 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "simple/query.h"
+#include "simple/solver.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+typedef std::vector<ClausePtr> ClauseList;
+
+/*
+ * The clauses of a group are connected through their query variables,
+ * and no two groups share a query variable. Clauses without any query
+ * variable form a group of their own.
+ */
+struct ClauseGroup {
+  public:
+    std::set<std::string>   qvars;
+    ClauseList              clauses;
+};
+
+typedef std::vector<ClauseGroup> QueryPlan;
+
+/*
+ * The number of pairs in the relation of each solver.
+ */
+typedef std::map<QuerySolver*, size_t> RelationStatistics;
+
+/*
+ * SimpleQueryPlanner orders the clauses of a query before they are
+ * evaluated. The cost of a clause is the size of its relation scaled
+ * down by how bound its terms are, so that clauses with constants and
+ * small relations run first and narrow down the query variables used
+ * by the more expensive clauses.
+ */
+class SimpleQueryPlanner {
+  public:
+    SimpleQueryPlanner(const RelationStatistics& statistics);
+
+    QueryPlan plan(const ClauseSet& clauses);
+
+    double estimate_cost(PqlClause *clause, 
+            const std::set<std::string>& bound_qvars);
+
+  private:
+    class ClauseInfo {
+      public:
+        ClauseInfo(const ClausePtr& clause_) : clause(clause_) { }
+
+        ClausePtr                   clause;
+        std::vector<std::string>    qvars;
+    };
+
+    ClauseInfo get_clause_info(const ClausePtr& clause);
+    double get_term_weight(PqlTerm *term, 
+            const std::set<std::string>& bound_qvars);
+    size_t get_relation_size(QuerySolver *solver);
+
+    ClauseList order_group(std::vector<ClauseInfo>& infos);
+
+    RelationStatistics  _statistics;
+    size_t              _default_size;
+};
+
+} // namespace impl
+} // namespace simple
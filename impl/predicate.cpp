@@ -23,7 +23,15 @@ namespace impl {
 
 template <typename Predicate>
 PredicateGenerator<Predicate>::PredicateGenerator(SimpleRoot ast, Predicate *pred) : 
-    _ast(ast), _global_set(), _pred(pred)
+    _ast(ast), _table(new SimpleConditionTable(ast)), 
+    _global_set(), _pred(pred)
+{
+    create_global_set();
+}
+
+template <typename Predicate>
+PredicateGenerator<Predicate>::PredicateGenerator(SimpleRoot ast, ConditionTablePtr table) : 
+    _ast(ast), _table(table), _global_set(), _pred(new Predicate())
 {
     create_global_set();
 }
@@ -58,15 +66,15 @@ std::string PredicateGenerator<Predicate>::get_predicate_name() {
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_assignment(AssignmentAst *assign) {
     if(_pred->template evaluate<AssignmentAst>(assign)) {
-        _global_set.insert(new SimpleStatementCondition(assign));
+        _global_set.insert(_table->get_statement_condition(assign));
     }
 
     if(_pred->template evaluate<SimpleVariable>(assign->get_variable())) {
-        _global_set.insert(new SimpleVariableCondition(*assign->get_variable()));
+        _global_set.insert(_table->get_variable_condition(assign->get_variable()));
     }
 
     if(_pred->template evaluate<ExprAst>(assign->get_expr())) {
-        _global_set.insert(new SimplePatternCondition(assign->get_expr()->clone()));
+        _global_set.insert(_table->get_pattern_condition(assign->get_expr()));
     }
 
     assign->get_expr()->accept_expr_visitor(this);
@@ -75,11 +83,11 @@ void PredicateGenerator<Predicate>::visit_assignment(AssignmentAst *assign) {
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_conditional(ConditionalAst *condition) {
     if(_pred->template evaluate<ConditionalAst>(condition)) {
-        _global_set.insert(new SimpleStatementCondition(condition));
+        _global_set.insert(_table->get_statement_condition(condition));
     }
 
     if(_pred->template evaluate<SimpleVariable>(condition->get_variable())) {
-        _global_set.insert(new SimpleVariableCondition(*condition->get_variable()));
+        _global_set.insert(_table->get_variable_condition(condition->get_variable()));
     }
 
     filter_statement_list(condition->get_then_branch());
@@ -89,11 +97,11 @@ void PredicateGenerator<Predicate>::visit_conditional(ConditionalAst *condition)
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_while(WhileAst *loop) {
     if(_pred->template evaluate<WhileAst>(loop)) {
-        _global_set.insert(new SimpleStatementCondition(loop));
+        _global_set.insert(_table->get_statement_condition(loop));
     }
 
     if(_pred->template evaluate<SimpleVariable>(loop->get_variable())) {
-        _global_set.insert(new SimpleVariableCondition(*loop->get_variable()));
+        _global_set.insert(_table->get_variable_condition(loop->get_variable()));
     }
 
     filter_statement_list(loop->get_body());
@@ -102,21 +110,21 @@ void PredicateGenerator<Predicate>::visit_while(WhileAst *loop) {
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_call(CallAst *call) {
     if(_pred->template evaluate<CallAst>(call)) {
-        _global_set.insert(new SimpleStatementCondition(call));
+        _global_set.insert(_table->get_statement_condition(call));
     }
 }
 
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_variable(VariableAst *var) {
     if(_pred->template evaluate<SimpleVariable>(var->get_variable())) {
-        _global_set.insert(new SimpleVariableCondition(*var->get_variable()));
+        _global_set.insert(_table->get_variable_condition(var->get_variable()));
     }
 }
 
 template <typename Predicate>
 void PredicateGenerator<Predicate>::visit_const(ConstAst *constant) {
     if(_pred->template evaluate<SimpleConstant>(constant->get_constant())) {
-        _global_set.insert(new SimpleConstantCondition(*constant->get_constant()));
+        _global_set.insert(_table->get_constant_condition(constant->get_constant()));
     }
 }
 
@@ -133,7 +141,7 @@ void PredicateGenerator<Predicate>::create_global_set() {
     {
         ProcAst *proc = *it;
         if(_pred->template evaluate<ProcAst>(proc)) {
-            _global_set.insert(new SimpleProcCondition(proc));
+            _global_set.insert(_table->get_proc_condition(proc));
         }
 
         filter_statement_list(proc->get_statement());
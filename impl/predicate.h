@@ -23,6 +23,7 @@
 #include "simple/condition_set.h"
 #include "simple/predicate.h"
 #include "impl/condition.h"
+#include "impl/condition_table.h"
 
 namespace simple {
 namespace impl {
@@ -34,6 +35,7 @@ class PredicateGenerator :
 {
   public:
     PredicateGenerator(SimpleRoot ast, Predicate *pred = new Predicate());
+    PredicateGenerator(SimpleRoot ast, ConditionTablePtr table);
 
     const ConditionSet& global_set();
 
@@ -56,6 +58,7 @@ class PredicateGenerator :
     void filter_statement_list(StatementAst *statement);
 
     SimpleRoot _ast;
+    ConditionTablePtr _table;
     ConditionSet _global_set;
     std::unique_ptr<Predicate> _pred;
 };
@@ -16,6 +16,9 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
+#include <set>
+#include <unordered_set>
 #include "impl/processor.h"
 
 namespace simple {
@@ -38,6 +41,68 @@ class SolveClauseVisitorTraits {
     }
 };
 
+/*
+ * Membership test used to probe join partners. Interned conditions of
+ * a sparse set are hashed by their IDs, while dense sets are already
+ * bitsets keyed by the same IDs.
+ */
+class ConditionProbe {
+  public:
+    ConditionProbe(const ConditionSet& conditions) :
+        _conditions(conditions), _table(NULL), _hashed(false)
+    {
+        if(conditions.is_dense() || conditions.is_empty()) {
+            return;
+        }
+
+        _table = conditions.begin()->get_table();
+        _hashed = _table != NULL;
+
+        for(ConditionSet::iterator it = conditions.begin();
+                _hashed && it != conditions.end(); ++it)
+        {
+            _hashed = it->get_table() == _table;
+            _ids.insert(it->get_id());
+        }
+    }
+
+    bool has_element(const ConditionPtr& condition) const {
+        if(_hashed && condition.get_table() == _table) {
+            return _ids.count(condition.get_id()) != 0;
+        } else {
+            return _conditions.has_element(condition);
+        }
+    }
+
+  private:
+    const ConditionSet&         _conditions;
+    const ConditionTable        *_table;
+    bool                        _hashed;
+    std::unordered_set<int>     _ids;
+};
+
+/*
+ * Validates the pairs that the linker holds for two query variables
+ * that are already joined.
+ */
+class ValidateLinkFilter : public LinkFilter {
+  public:
+    ValidateLinkFilter(QuerySolver *solver, const QueryBudgetPtr& budget) :
+        _solver(solver), _budget(budget)
+    { }
+
+    bool is_linked(const ConditionPtr& condition1, 
+            const ConditionPtr& condition2) 
+    {
+        check_budget(_budget);
+        return _solver->validate(condition1, condition2);
+    }
+
+  private:
+    QuerySolver     *_solver;
+    QueryBudgetPtr  _budget;
+};
+
 void QueryProcessor::solve_clause(PqlClause *clause) {
     double_dispatch_pql_terms<QueryProcessor, SolveClauseVisitorTraits>(
             this, clause->get_left_term(), clause->get_right_term(),
@@ -77,28 +142,32 @@ void QueryProcessor::solve_clause<PqlVariableTerm, PqlVariableTerm>(
         for(ConditionSet::iterator cit = conditions.begin();
                 cit != conditions.end(); ++cit)
         {
+            check_budget(_budget);
             if(solver->validate(*cit, *cit)) {
                 new_conditions.insert(*cit);
             }
         }
         _linker->update_results(qvar1, new_conditions);
     } else {
+        // both qvars are joined already, so only their pairs are checked
+        ValidateLinkFilter filter(solver, _budget);
+        if(_linker->filter_links(qvar1, qvar2, &filter)) {
+            return;
+        }
+
         ConditionSet conditions1 = get_qvar(qvar1);
         ConditionSet conditions2 = get_qvar(qvar2);
 
         std::vector<ConditionPair> links;
 
-        for(ConditionSet::iterator cit1 = conditions1.begin();
-                cit1 != conditions1.end(); ++cit1)
-        {
-            for(ConditionSet::iterator cit2 = conditions2.begin();
-                    cit2 != conditions2.end(); ++cit2)
-            {
-                if(solver->validate(*cit1, *cit2)) {
-                    links.push_back(ConditionPair(*cit1, *cit2));
-                }
-            }
+        if(!solver->can_enumerate()) {
+            nested_loop_join(solver, conditions1, conditions2, links);
+        } else if(conditions1.get_size() <= conditions2.get_size()) {
+            hash_join_right(solver, conditions1, conditions2, links);
+        } else {
+            hash_join_left(solver, conditions1, conditions2, links);
         }
+
         _linker->update_links(qvar1, qvar2, links);
     }
 
@@ -112,10 +181,19 @@ void QueryProcessor::solve_clause<PqlWildcardTerm, PqlWildcardTerm>(
         QuerySolver *solver,
         PqlWildcardTerm *term1, PqlWildcardTerm *term2)
 {
+    const ConditionSet *domain = solver->get_domain();
+    if(domain != NULL) {
+        if(domain->is_empty()) {
+            _linker->invalidate_state();
+        }
+        return;
+    }
+
     ConditionSet left = _wildcard_pred->global_set();
     for(ConditionSet::iterator it = left.begin();
             it != left.end(); ++it)
     {
+        check_budget(_budget);
         if(!solver->solve_left(*it).is_empty()) {
             return;
         }
@@ -160,10 +238,18 @@ void QueryProcessor::solve_clause<PqlVariableTerm, PqlWildcardTerm>(
     std::string qvar = term1->get_query_variable();
     ConditionSet left_conditions = get_qvar(qvar);
 
+    const ConditionSet *domain = solver->get_domain();
+    if(domain != NULL) {
+        left_conditions.intersect_with(*domain);
+        set_qvar(qvar, left_conditions);
+        return;
+    }
+
     ConditionSet new_left;
     for(ConditionSet::iterator cit = left_conditions.begin();
             cit != left_conditions.end(); ++cit)
     {
+        check_budget(_budget);
         if(!solver->solve_right(*cit).is_empty()) {
             new_left.insert(*cit);
         }
@@ -183,10 +269,18 @@ void QueryProcessor::solve_clause<PqlWildcardTerm, PqlVariableTerm>(
     std::string qvar = term2->get_query_variable();
     ConditionSet right_conditions = get_qvar(qvar);
 
+    const ConditionSet *range = solver->get_range();
+    if(range != NULL) {
+        right_conditions.intersect_with(*range);
+        set_qvar(qvar, right_conditions);
+        return;
+    }
+
     ConditionSet new_right;
     for(ConditionSet::iterator cit = right_conditions.begin();
             cit != right_conditions.end(); ++cit)
     {
+        check_budget(_budget);
         if(!solver->solve_left(*cit).is_empty()) {
             new_right.insert(*cit);
         }
@@ -203,7 +297,12 @@ void QueryProcessor::solve_clause<PqlConditionTerm, PqlWildcardTerm>(
         QuerySolver *solver,
         PqlConditionTerm *term1, PqlWildcardTerm *term2)
 {
-    if(solver->solve_right(term1->get_condition()).is_empty()) {
+    const ConditionSet *domain = solver->get_domain();
+    bool has_right = domain != NULL ? 
+        domain->has_element(term1->get_condition()) :
+        !solver->solve_right(term1->get_condition()).is_empty();
+
+    if(!has_right) {
         _linker->invalidate_state();
     }
 }
@@ -216,11 +315,310 @@ void QueryProcessor::solve_clause<PqlWildcardTerm, PqlConditionTerm>(
         QuerySolver *solver,
         PqlWildcardTerm *term1, PqlConditionTerm *term2)
 {
-    if(solver->solve_left(term2->get_condition()).is_empty()) {
+    const ConditionSet *range = solver->get_range();
+    bool has_left = range != NULL ? 
+        range->has_element(term2->get_condition()) :
+        !solver->solve_left(term2->get_condition()).is_empty();
+
+    if(!has_left) {
         _linker->invalidate_state();
     }
 }
 
+void QueryProcessor::nested_loop_join(QuerySolver *solver,
+        const ConditionSet& conditions1, const ConditionSet& conditions2,
+        std::vector<ConditionPair>& links)
+{
+    for(ConditionSet::iterator cit1 = conditions1.begin();
+            cit1 != conditions1.end(); ++cit1)
+    {
+        for(ConditionSet::iterator cit2 = conditions2.begin();
+                cit2 != conditions2.end(); ++cit2)
+        {
+            check_budget(_budget);
+            if(solver->validate(*cit1, *cit2)) {
+                links.push_back(ConditionPair(*cit1, *cit2));
+            }
+        }
+    }
+}
+
+/*
+ * Enumerate the right partners of each left condition and keep the
+ * ones that are also in the right set.
+ */
+void QueryProcessor::hash_join_right(QuerySolver *solver,
+        const ConditionSet& conditions1, const ConditionSet& conditions2,
+        std::vector<ConditionPair>& links)
+{
+    ConditionProbe probe(conditions2);
+
+    for(ConditionSet::iterator cit1 = conditions1.begin();
+            cit1 != conditions1.end(); ++cit1)
+    {
+        check_budget(_budget);
+        ConditionSet partners = solver->solve_right(*cit1);
+        for(ConditionSet::iterator cit2 = partners.begin();
+                cit2 != partners.end(); ++cit2)
+        {
+            if(probe.has_element(*cit2)) {
+                links.push_back(ConditionPair(*cit1, *cit2));
+            }
+        }
+    }
+}
+
+void QueryProcessor::hash_join_left(QuerySolver *solver,
+        const ConditionSet& conditions1, const ConditionSet& conditions2,
+        std::vector<ConditionPair>& links)
+{
+    ConditionProbe probe(conditions1);
+
+    for(ConditionSet::iterator cit2 = conditions2.begin();
+            cit2 != conditions2.end(); ++cit2)
+    {
+        check_budget(_budget);
+        ConditionSet partners = solver->solve_left(*cit2);
+        for(ConditionSet::iterator cit1 = partners.begin();
+                cit1 != partners.end(); ++cit1)
+        {
+            if(probe.has_element(*cit1)) {
+                links.push_back(ConditionPair(*cit1, *cit2));
+            }
+        }
+    }
+}
+
+/*
+ * Depth-first search over the clauses in order, binding query variables
+ * to one condition at a time. Each failed search is remembered by the
+ * depth and the bindings that later clauses still depend on, so the
+ * same dead end is never explored twice.
+ */
+class SolutionSearch {
+  public:
+    SolutionSearch(QueryProcessor *processor, 
+            const std::vector<ClausePtr>& clauses) :
+        _processor(processor), _clauses(clauses), 
+        _budget(processor->get_budget())
+    {
+        std::set<std::string> seen;
+        for(size_t i = 0; i < _clauses.size(); ++i) {
+            _terms.push_back(std::make_pair(
+                        PqlTermInfo(_clauses[i]->get_left_term()),
+                        PqlTermInfo(_clauses[i]->get_right_term())));
+
+            std::set<std::string> live;
+            for(size_t j = i; j < _clauses.size(); ++j) {
+                PqlTermInfo left(_clauses[j]->get_left_term());
+                PqlTermInfo right(_clauses[j]->get_right_term());
+
+                if(left.is_qvar() && seen.count(left.get_qvar())) {
+                    live.insert(left.get_qvar());
+                }
+                if(right.is_qvar() && seen.count(right.get_qvar())) {
+                    live.insert(right.get_qvar());
+                }
+            }
+            _live_qvars.push_back(std::vector<std::string>(live.begin(), live.end()));
+
+            if(_terms.back().first.is_qvar()) {
+                seen.insert(_terms.back().first.get_qvar());
+            }
+            if(_terms.back().second.is_qvar()) {
+                seen.insert(_terms.back().second.get_qvar());
+            }
+        }
+    }
+
+    bool search(size_t depth) {
+        check_budget(_budget);
+        if(depth == _clauses.size()) {
+            return true;
+        }
+
+        std::pair<size_t, std::vector<ConditionPtr> > key(depth, 
+                std::vector<ConditionPtr>());
+        for(size_t i = 0; i < _live_qvars[depth].size(); ++i) {
+            key.second.push_back(_bindings.find(_live_qvars[depth][i])->second);
+        }
+
+        if(_failed.count(key) > 0) {
+            return false;
+        }
+
+        if(search_clause(depth)) {
+            return true;
+        } else {
+            _failed.insert(key);
+            return false;
+        }
+    }
+
+  private:
+    bool is_bound(const PqlTermInfo& term) {
+        return term.is_condition() || 
+            (term.is_qvar() && _bindings.count(term.get_qvar()) > 0);
+    }
+
+    ConditionPtr get_bound(const PqlTermInfo& term) {
+        if(term.is_condition()) {
+            return term.get_condition();
+        } else {
+            return _bindings.find(term.get_qvar())->second;
+        }
+    }
+
+    bool search_with(size_t depth, const std::string& qvar, 
+            const ConditionPtr& condition)
+    {
+        _bindings.insert(std::make_pair(qvar, condition));
+        bool result = search(depth + 1);
+        _bindings.erase(qvar);
+        return result;
+    }
+
+    ConditionSet solve_right(QuerySolver *solver, const ConditionPtr& left) {
+        if(solver->can_enumerate()) {
+            return solver->solve_right(left);
+        }
+
+        ConditionSet result;
+        const ConditionSet& candidates = _processor->get_wildcard_predicate()->global_set();
+        for(ConditionSet::iterator it = candidates.begin(); 
+                it != candidates.end(); ++it)
+        {
+            check_budget(_budget);
+            if(solver->validate(left, *it)) {
+                result.insert(*it);
+            }
+        }
+        return result;
+    }
+
+    ConditionSet solve_left(QuerySolver *solver, const ConditionPtr& right) {
+        if(solver->can_enumerate()) {
+            return solver->solve_left(right);
+        }
+
+        ConditionSet result;
+        const ConditionSet& candidates = _processor->get_wildcard_predicate()->global_set();
+        for(ConditionSet::iterator it = candidates.begin(); 
+                it != candidates.end(); ++it)
+        {
+            check_budget(_budget);
+            if(solver->validate(*it, right)) {
+                result.insert(*it);
+            }
+        }
+        return result;
+    }
+
+    bool search_partners(size_t depth, const ConditionSet& partners,
+            const std::string& qvar)
+    {
+        SimplePredicate *pred = _processor->get_predicate(qvar);
+        for(ConditionSet::iterator it = partners.begin(); 
+                it != partners.end(); ++it)
+        {
+            if(pred->validate(*it) && search_with(depth, qvar, *it)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool search_clause(size_t depth) {
+        QuerySolver *solver = _clauses[depth]->get_solver();
+        const PqlTermInfo& left = _terms[depth].first;
+        const PqlTermInfo& right = _terms[depth].second;
+
+        if(is_bound(left) && is_bound(right)) {
+            return solver->validate(get_bound(left), get_bound(right)) && 
+                search(depth + 1);
+        } else if(is_bound(left) && right.is_wildcard()) {
+            return !solve_right(solver, get_bound(left)).is_empty() && 
+                search(depth + 1);
+        } else if(left.is_wildcard() && is_bound(right)) {
+            return !solve_left(solver, get_bound(right)).is_empty() && 
+                search(depth + 1);
+        } else if(is_bound(left)) {
+            return search_partners(depth, 
+                    solve_right(solver, get_bound(left)), right.get_qvar());
+        } else if(is_bound(right)) {
+            return search_partners(depth, 
+                    solve_left(solver, get_bound(right)), left.get_qvar());
+        }
+
+        /*
+         * Neither side is bound, so try every candidate on the left.
+         */
+        const ConditionSet& candidates = left.is_wildcard() ? 
+            _processor->get_wildcard_predicate()->global_set() :
+            _processor->get_predicate(left.get_qvar())->global_set();
+
+        for(ConditionSet::iterator it = candidates.begin(); 
+                it != candidates.end(); ++it)
+        {
+            if(left.is_wildcard()) {
+                ConditionSet partners = solve_right(solver, *it);
+                if(right.is_wildcard() && !partners.is_empty()) {
+                    return search(depth + 1);
+                } else if(right.is_qvar() && 
+                        search_partners(depth, partners, right.get_qvar())) 
+                {
+                    return true;
+                }
+                continue;
+            }
+
+            const std::string& qvar = left.get_qvar();
+            if(right.is_wildcard()) {
+                if(!solve_right(solver, *it).is_empty() && 
+                        search_with(depth, qvar, *it)) 
+                {
+                    return true;
+                }
+            } else if(right.get_qvar() == qvar) {
+                if(solver->validate(*it, *it) && search_with(depth, qvar, *it)) {
+                    return true;
+                }
+            } else {
+                _bindings.insert(std::make_pair(qvar, *it));
+                bool result = search_partners(depth, 
+                        solve_right(solver, *it), right.get_qvar());
+                _bindings.erase(qvar);
+
+                if(result) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    QueryProcessor                  *_processor;
+    const std::vector<ClausePtr>&   _clauses;
+    std::vector< std::pair<PqlTermInfo, PqlTermInfo> >  _terms;
+    std::vector< std::vector<std::string> >             _live_qvars;
+    std::map<std::string, ConditionPtr>                 _bindings;
+    std::set< std::pair<size_t, std::vector<ConditionPtr> > > _failed;
+    QueryBudgetPtr                                      _budget;
+};
+
+bool QueryProcessor::has_solution(const std::vector<ClausePtr>& clauses) {
+    SolutionSearch search(this, clauses);
+    return search.search(0);
+}
+
+void QueryProcessor::set_budget(const QueryBudgetPtr& budget) {
+    _budget = budget;
+}
+
+QueryBudgetPtr QueryProcessor::get_budget() {
+    return _budget;
+}
+
 ConditionSet QueryProcessor::get_qvar(const std::string& qvar) {
     return _linker->get_conditions(qvar, get_predicate(qvar));
 }
@@ -236,6 +634,10 @@ void QueryProcessor::set_qvar(const std::string& qvar,
     _linker->update_results(qvar, conditions);
 }
 
+SimplePredicate* QueryProcessor::get_wildcard_predicate() {
+    return _wildcard_pred.get();
+}
+
 SimplePredicate* QueryProcessor::get_predicate(const std::string& qvar) 
 {
     if(_predicates.count(qvar) > 0) {
@@ -23,6 +23,7 @@
 #include "simple/query.h"
 #include "simple/linker.h"
 #include "simple/util/query_utils.h"
+#include "impl/budget.h"
 
 namespace simple {
 namespace impl {
@@ -43,6 +44,21 @@ class QueryProcessor {
 
     void solve_clause(PqlClause *clause);
 
+    /*
+     * Evaluation throws a QueryTimeoutError once the budget runs out.
+     */
+    void set_budget(const QueryBudgetPtr& budget);
+    QueryBudgetPtr get_budget();
+
+    /*
+     * Checks whether the clauses can all be satisfied at the same time
+     * without materializing the query variables in the linker. The
+     * search stops at the first assignment that satisfies every clause,
+     * so it is used for clause groups none of whose query variables
+     * are selected.
+     */
+    bool has_solution(const std::vector<ClausePtr>& clauses);
+
     template <typename Term1, typename Term2>
     void solve_clause(QuerySolver *solver, Term1 *term1, Term2 *term2) {
 
@@ -53,11 +69,30 @@ class QueryProcessor {
     void set_qvar(const std::string& qvar, const ConditionSet& conditions);
 
     SimplePredicate* get_predicate(const std::string& qvar);
+    SimplePredicate* get_wildcard_predicate();
 
   private:
+    /*
+     * Strategies to find the linked pairs of a clause with two
+     * different query variables. The hash joins only enumerate the
+     * partners of the smaller set.
+     */
+    void nested_loop_join(QuerySolver *solver,
+            const ConditionSet& conditions1, const ConditionSet& conditions2,
+            std::vector<ConditionPair>& links);
+
+    void hash_join_right(QuerySolver *solver,
+            const ConditionSet& conditions1, const ConditionSet& conditions2,
+            std::vector<ConditionPair>& links);
+
+    void hash_join_left(QuerySolver *solver,
+            const ConditionSet& conditions1, const ConditionSet& conditions2,
+            std::vector<ConditionPair>& links);
+
     std::shared_ptr<QueryLinker>        _linker;
     std::map<std::string, PredicatePtr> _predicates;
     PredicatePtr    _wildcard_pred;
+    QueryBudgetPtr  _budget;
 };
 
 /*
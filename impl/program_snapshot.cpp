@@ -0,0 +1,368 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <vector>
+#include <fstream>
+#include "impl/program_snapshot.h"
+
+namespace simple {
+namespace impl {
+
+namespace {
+
+const uint64_t SNAPSHOT_MAGIC = 0x50414e53504b4253ULL; // "SBKPSNAP"
+const uint64_t SNAPSHOT_VERSION = 1;
+const uint64_t SNAPSHOT_BYTE_ORDER = 0x0102030405060708ULL;
+const size_t SNAPSHOT_HEADER_SIZE = 6 * sizeof(uint64_t);
+
+enum SnapshotNodeKind {
+    NODE_ASSIGNMENT,
+    NODE_CONDITIONAL,
+    NODE_WHILE,
+    NODE_CALL,
+    NODE_VARIABLE,
+    NODE_CONSTANT,
+    NODE_BINARY_OP
+};
+
+/*
+ * Writes statement lists in pre-order. Called procedures are written
+ * as their position in the SimpleRoot, which is ordered by name.
+ */
+class AstSnapshotWriter : public StatementVisitor, public ExprVisitor {
+  public:
+    AstSnapshotWriter(SnapshotWriter& out,
+            const std::map<ProcAst*, int>& proc_index) :
+        _out(out), _proc_index(proc_index)
+    { }
+
+    void write_statement_list(StatementAst *statement) {
+        int count = 0;
+        for(StatementAst *it = statement; it != NULL; it = it->next()) {
+            ++count;
+        }
+
+        _out.write_int(count);
+        for(; statement != NULL; statement = statement->next()) {
+            statement->accept_statement_visitor(this);
+        }
+    }
+
+    void visit_assignment(AssignmentAst *assign) {
+        write_header(NODE_ASSIGNMENT, assign);
+        _out.write_string(assign->get_variable()->get_name());
+        assign->get_expr()->accept_expr_visitor(this);
+    }
+
+    void visit_conditional(ConditionalAst *condition) {
+        write_header(NODE_CONDITIONAL, condition);
+        _out.write_string(condition->get_variable()->get_name());
+        write_statement_list(condition->get_then_branch());
+        write_statement_list(condition->get_else_branch());
+    }
+
+    void visit_while(WhileAst *loop) {
+        write_header(NODE_WHILE, loop);
+        _out.write_string(loop->get_variable()->get_name());
+        write_statement_list(loop->get_body());
+    }
+
+    void visit_call(CallAst *call) {
+        write_header(NODE_CALL, call);
+        _out.write_int(_proc_index.at(call->get_proc_called()));
+    }
+
+    void visit_variable(VariableAst *var) {
+        _out.write_u8(NODE_VARIABLE);
+        _out.write_string(var->get_variable()->get_name());
+    }
+
+    void visit_const(ConstAst *constant) {
+        _out.write_u8(NODE_CONSTANT);
+        _out.write_int(constant->get_constant()->get_int());
+    }
+
+    void visit_binary_op(BinaryOpAst *bin) {
+        _out.write_u8(NODE_BINARY_OP);
+        _out.write_u8(bin->get_op());
+        bin->get_lhs()->accept_expr_visitor(this);
+        bin->get_rhs()->accept_expr_visitor(this);
+    }
+
+  private:
+    void write_header(SnapshotNodeKind kind, StatementAst *statement) {
+        _out.write_u8(kind);
+        _out.write_int(statement->get_line());
+    }
+
+    SnapshotWriter&                 _out;
+    const std::map<ProcAst*, int>&  _proc_index;
+};
+
+class AstSnapshotReader {
+  public:
+    AstSnapshotReader(SnapshotReader& in,
+            const std::vector<SimpleProcAst*>& procs,
+            LineTable& line_table) :
+        _in(in), _procs(procs), _line_table(line_table)
+    { }
+
+    StatementAst* read_statement_list(ProcAst *proc, ContainerAst *container) {
+        int count = _in.read_int();
+        if(count <= 0) {
+            throw SnapshotError("empty statement list in snapshot");
+        }
+
+        SimpleStatementAst *first = read_statement(proc, container);
+        SimpleStatementAst *current = first;
+
+        for(int i = 1; i < count; ++i) {
+            SimpleStatementAst *next = read_statement(proc, container);
+            current->set_next(next->as_ast());
+            next->set_prev(current->as_ast());
+            current = next;
+        }
+
+        return first->as_ast();
+    }
+
+  private:
+    SimpleStatementAst* read_statement(ProcAst *proc, ContainerAst *container) {
+        unsigned char kind = _in.read_u8();
+        int line = _in.read_int();
+        SimpleStatementAst *statement;
+
+        if(kind == NODE_ASSIGNMENT) {
+            SimpleAssignmentAst *assign = new SimpleAssignmentAst();
+            statement = assign;
+            assign->set_variable(SimpleVariable(_in.read_string()));
+            assign->set_expr(read_expr());
+        } else if(kind == NODE_CONDITIONAL) {
+            SimpleConditionalAst *condition = new SimpleConditionalAst();
+            statement = condition;
+            condition->set_variable(SimpleVariable(_in.read_string()));
+            condition->set_then_branch(read_statement_list(proc, condition));
+            condition->set_else_branch(read_statement_list(proc, condition));
+        } else if(kind == NODE_WHILE) {
+            SimpleWhileAst *loop = new SimpleWhileAst();
+            statement = loop;
+            loop->set_variable(SimpleVariable(_in.read_string()));
+            loop->set_body(read_statement_list(proc, loop));
+        } else if(kind == NODE_CALL) {
+            int index = _in.read_int();
+            if(index < 0 || index >= static_cast<int>(_procs.size())) {
+                throw SnapshotError("invalid procedure in snapshot");
+            }
+            statement = new SimpleCallAst(_procs[index]);
+        } else {
+            throw SnapshotError("invalid statement in snapshot");
+        }
+
+        statement->set_proc(proc);
+        statement->set_container(container);
+        statement->set_line(line);
+        _line_table[line] = statement->as_ast();
+
+        return statement;
+    }
+
+    ExprAst* read_expr() {
+        unsigned char kind = _in.read_u8();
+
+        if(kind == NODE_VARIABLE) {
+            return new SimpleVariableAst(SimpleVariable(_in.read_string()));
+        } else if(kind == NODE_CONSTANT) {
+            return new SimpleConstAst(_in.read_int());
+        } else if(kind == NODE_BINARY_OP) {
+            char op = _in.read_u8();
+            std::unique_ptr<ExprAst> lhs(read_expr());
+            ExprAst *rhs = read_expr();
+            return new SimpleBinaryOpAst(op, lhs.release(), rhs);
+        } else {
+            throw SnapshotError("invalid expression in snapshot");
+        }
+    }
+
+    SnapshotReader&                     _in;
+    const std::vector<SimpleProcAst*>&  _procs;
+    LineTable&                          _line_table;
+};
+
+void collect_statement_ids(StatementAst *statement, ConditionTable *table,
+        std::vector<int>& ids)
+{
+    for(; statement != NULL; statement = statement->next()) {
+        ids.push_back(table->get_statement_condition(statement).get_id());
+
+        if(ConditionalAst *condition = dynamic_cast<ConditionalAst*>(statement)) {
+            collect_statement_ids(condition->get_then_branch(), table, ids);
+            collect_statement_ids(condition->get_else_branch(), table, ids);
+        } else if(WhileAst *loop = dynamic_cast<WhileAst*>(statement)) {
+            collect_statement_ids(loop->get_body(), table, ids);
+        }
+    }
+}
+
+/*
+ * The relations are keyed by condition IDs, so the snapshot is only
+ * usable if the condition table numbers the loaded program exactly
+ * the way it numbered the program the snapshot was taken from.
+ */
+std::vector<int> collect_condition_ids(SimpleRoot ast, ConditionTable *table) {
+    std::vector<int> ids;
+    ids.push_back(table->get_size());
+
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        collect_statement_ids((*it)->get_statement(), table, ids);
+    }
+
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        ids.push_back(table->get_proc_condition(*it).get_id());
+    }
+
+    return ids;
+}
+
+} // anonymous namespace
+
+ProgramSnapshot::ProgramSnapshot(const std::string& path,
+        uint64_t source_checksum) :
+    _file(), _reader()
+{
+    try {
+        _file.reset(new MappedFile(path));
+    } catch(FileError& e) {
+        throw SnapshotError("cannot open snapshot");
+    }
+
+    if(_file->get_size() < SNAPSHOT_HEADER_SIZE) {
+        throw SnapshotError("truncated snapshot");
+    }
+
+    SnapshotReader header(_file->get_data(), SNAPSHOT_HEADER_SIZE);
+    if(header.read_u64() != SNAPSHOT_MAGIC) {
+        throw SnapshotError("not a snapshot file");
+    }
+    if(header.read_u64() != SNAPSHOT_VERSION) {
+        throw SnapshotError("unsupported snapshot version");
+    }
+    if(header.read_u64() != SNAPSHOT_BYTE_ORDER) {
+        throw SnapshotError("snapshot has a different byte order");
+    }
+    if(header.read_u64() != source_checksum) {
+        throw SnapshotError("snapshot was taken from a different source");
+    }
+
+    uint64_t payload_size = header.read_u64();
+    uint64_t payload_checksum = header.read_u64();
+    const char *payload = _file->get_data() + SNAPSHOT_HEADER_SIZE;
+
+    if(payload_size != _file->get_size() - SNAPSHOT_HEADER_SIZE) {
+        throw SnapshotError("truncated snapshot");
+    }
+    if(snapshot_checksum(payload, payload_size) != payload_checksum) {
+        throw SnapshotError("corrupted snapshot");
+    }
+
+    _reader.reset(new SnapshotReader(payload, payload_size));
+}
+
+SimpleRoot ProgramSnapshot::load_program(LineTable& line_table) {
+    int proc_count = _reader->read_int();
+    if(proc_count <= 0) {
+        throw SnapshotError("invalid procedure count in snapshot");
+    }
+
+    std::vector<SimpleProcAst*> procs;
+    for(int i = 0; i < proc_count; ++i) {
+        procs.push_back(new SimpleProcAst(_reader->read_string()));
+    }
+    SimpleRoot ast(procs.begin(), procs.end());
+
+    AstSnapshotReader reader(*_reader, procs, line_table);
+    for(int i = 0; i < proc_count; ++i) {
+        procs[i]->set_first_statement(
+                reader.read_statement_list(procs[i], NULL));
+    }
+
+    return ast;
+}
+
+PkbPtr ProgramSnapshot::load_pkb(SimpleRoot ast, ConditionTablePtr table) {
+    std::vector<int> expected;
+    _reader->read_array(expected);
+
+    if(expected != collect_condition_ids(ast, table.get())) {
+        throw SnapshotError("snapshot condition IDs do not match");
+    }
+
+    PkbPtr pkb(new SimplePkb(ast, table, *_reader));
+    if(!_reader->at_end()) {
+        throw SnapshotError("trailing data in snapshot");
+    }
+    return pkb;
+}
+
+void ProgramSnapshot::save(const std::string& path, uint64_t source_checksum,
+        SimpleRoot ast, SimplePkb& pkb)
+{
+    SnapshotWriter payload;
+    std::map<ProcAst*, int> proc_index;
+
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        int index = proc_index.size();
+        proc_index[*it] = index;
+    }
+
+    payload.write_int(proc_index.size());
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        payload.write_string((*it)->get_name());
+    }
+
+    AstSnapshotWriter writer(payload, proc_index);
+    for(SimpleRoot::iterator it = ast.begin(); it != ast.end(); ++it) {
+        writer.write_statement_list((*it)->get_statement());
+    }
+
+    payload.write_array(collect_condition_ids(ast,
+            pkb.get_condition_table().get()));
+    pkb.save(payload);
+
+    const std::string& data = payload.get_data();
+    SnapshotWriter header;
+    header.write_u64(SNAPSHOT_MAGIC);
+    header.write_u64(SNAPSHOT_VERSION);
+    header.write_u64(SNAPSHOT_BYTE_ORDER);
+    header.write_u64(source_checksum);
+    header.write_u64(data.size());
+    header.write_u64(snapshot_checksum(data.data(), data.size()));
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) {
+        throw SnapshotError("cannot write snapshot");
+    }
+    file.write(header.get_data().data(), header.get_data().size());
+    file.write(data.data(), data.size());
+    if(!file) {
+        throw SnapshotError("cannot write snapshot");
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,70 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <stdint.h>
+#include "simple/ast.h"
+#include "impl/ast.h"
+#include "impl/pkb.h"
+#include "impl/snapshot.h"
+
+namespace simple {
+namespace impl {
+
+/*
+ * A program snapshot holds a parsed program and the PKB built from it,
+ * so that the program can be loaded without parsing the source or
+ * computing the relations again. The file starts with a header
+ *
+ *   magic, version, byte order mark, source checksum,
+ *   payload size, payload checksum
+ *
+ * followed by the payload: the procedures and their statements in
+ * pre-order with the expression trees, the condition IDs of all
+ * statements and procedures, and the PKB relations.
+ */
+class ProgramSnapshot {
+  public:
+    /*
+     * Throws a SnapshotError if the file is missing, corrupted, of
+     * another version or taken from a different source.
+     */
+    ProgramSnapshot(const std::string& path, uint64_t source_checksum);
+
+    /*
+     * The program has to be loaded before the PKB, and the PKB must use
+     * a condition table built from the loaded program. A SnapshotError
+     * is thrown if the table assigns different condition IDs than the
+     * table the snapshot was taken with.
+     */
+    SimpleRoot load_program(LineTable& line_table);
+    PkbPtr load_pkb(SimpleRoot ast, ConditionTablePtr table);
+
+    static void save(const std::string& path, uint64_t source_checksum,
+            SimpleRoot ast, SimplePkb& pkb);
+
+  private:
+    std::unique_ptr<MappedFile> _file;
+    std::unique_ptr<SnapshotReader> _reader;
+};
+
+} // namespace impl
+} // namespace simple
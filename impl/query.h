@@ -146,6 +146,10 @@ class SimplePqlTupleSelector : public PqlTupleSelector {
         _tuples.push_back(qvar_name);
     }
 
+    void accept_pql_selector_visitor(PqlSelectorVisitor *visitor) {
+        visitor->visit_tuple(this);
+    }
+
   private:
     std::vector<std::string> _tuples;
 };
@@ -0,0 +1,553 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "impl/relation_table.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+RelationTable::RelationTable() :
+    _universe(), _pairs(), _right(), _left(), _size(0), _domain(), _range()
+{ }
+
+void RelationTable::add_pair(int left, int right) {
+    if(left != -1 && right != -1) {
+        _pairs.push_back(std::make_pair(left, right));
+    }
+}
+
+void RelationTable::build(ConditionUniversePtr universe) {
+    _universe = universe;
+
+    std::sort(_pairs.begin(), _pairs.end());
+    _pairs.erase(std::unique(_pairs.begin(), _pairs.end()), _pairs.end());
+    _size = _pairs.size();
+
+    _right.build(_pairs, _universe->get_size());
+
+    for(size_t i = 0; i < _pairs.size(); ++i) {
+        std::swap(_pairs[i].first, _pairs[i].second);
+    }
+    std::sort(_pairs.begin(), _pairs.end());
+    _left.build(_pairs, _universe->get_size());
+
+    std::vector< std::pair<int, int> >().swap(_pairs);
+
+    _domain = _right.get_sources(_universe);
+    _range = _left.get_sources(_universe);
+}
+
+void RelationTable::save(SnapshotWriter& out) const {
+    out.write_u64(_size);
+    _right.save(out);
+    _left.save(out);
+}
+
+void RelationTable::load(SnapshotReader& in, ConditionUniversePtr universe) {
+    _universe = universe;
+    _size = in.read_u64();
+    _right.load(in);
+    _left.load(in);
+
+    _domain = _right.get_sources(_universe);
+    _range = _left.get_sources(_universe);
+}
+
+bool RelationTable::validate(int left, int right) const {
+    return _right.has_target(left, right);
+}
+
+ConditionSet RelationTable::solve_right(int left) const {
+    return _right.get_targets(left, _universe);
+}
+
+ConditionSet RelationTable::solve_left(int right) const {
+    return _left.get_targets(right, _universe);
+}
+
+bool RelationTable::has_right(int left) const {
+    return _right.has_targets(left);
+}
+
+bool RelationTable::has_left(int right) const {
+    return _left.has_targets(right);
+}
+
+const ConditionSet& RelationTable::get_domain() const {
+    return _domain;
+}
+
+const ConditionSet& RelationTable::get_range() const {
+    return _range;
+}
+
+size_t RelationTable::get_size() const {
+    return _size;
+}
+
+RelationTable::id_iterator RelationTable::right_begin(int left) const {
+    return _right.begin(left);
+}
+
+RelationTable::id_iterator RelationTable::right_end(int left) const {
+    return _right.end(left);
+}
+
+RelationTable::id_iterator RelationTable::left_begin(int right) const {
+    return _left.begin(right);
+}
+
+RelationTable::id_iterator RelationTable::left_end(int right) const {
+    return _left.end(right);
+}
+
+/*
+ * The pairs must be sorted by their source ID.
+ */
+void RelationTable::Adjacency::build(
+        std::vector< std::pair<int, int> >& pairs, size_t size)
+{
+    _offsets.assign(size + 1, 0);
+    _targets.resize(pairs.size());
+
+    for(size_t i = 0; i < pairs.size(); ++i) {
+        ++_offsets[pairs[i].first + 1];
+        _targets[i] = pairs[i].second;
+    }
+
+    for(size_t i = 0; i < size; ++i) {
+        _offsets[i + 1] += _offsets[i];
+    }
+}
+
+void RelationTable::Adjacency::save(SnapshotWriter& out) const {
+    out.write_array(_offsets);
+    out.write_array(_targets);
+}
+
+void RelationTable::Adjacency::load(SnapshotReader& in) {
+    in.read_array(_offsets);
+    in.read_array(_targets);
+}
+
+bool RelationTable::Adjacency::has_target(int source, int target) const {
+    if(source < 0 || size_t(source) + 1 >= _offsets.size()) {
+        return false;
+    }
+
+    return std::binary_search(
+            _targets.begin() + _offsets[source],
+            _targets.begin() + _offsets[source + 1], target);
+}
+
+bool RelationTable::Adjacency::has_targets(int source) const {
+    if(source < 0 || size_t(source) + 1 >= _offsets.size()) {
+        return false;
+    }
+
+    return _offsets[source] != _offsets[source + 1];
+}
+
+RelationTable::id_iterator RelationTable::Adjacency::begin(int source) const {
+    if(!has_targets(source)) {
+        return _targets.end();
+    }
+    return _targets.begin() + _offsets[source];
+}
+
+RelationTable::id_iterator RelationTable::Adjacency::end(int source) const {
+    if(!has_targets(source)) {
+        return _targets.end();
+    }
+    return _targets.begin() + _offsets[source + 1];
+}
+
+ConditionSet RelationTable::Adjacency::get_targets(int source,
+        const ConditionUniversePtr& universe) const
+{
+    if(!has_targets(source)) {
+        return ConditionSet();
+    }
+
+    std::set<ConditionPtr> result;
+    for(int i = _offsets[source]; i < _offsets[source + 1]; ++i) {
+        result.insert(result.end(), universe->get_condition(_targets[i]));
+    }
+    return ConditionSet(std::move(result));
+}
+
+ConditionSet RelationTable::Adjacency::get_sources(
+        const ConditionUniversePtr& universe) const
+{
+    std::set<ConditionPtr> result;
+    for(size_t source = 0; source + 1 < _offsets.size(); ++source) {
+        if(_offsets[source] != _offsets[source + 1]) {
+            result.insert(result.end(), universe->get_condition(source));
+        }
+    }
+    return ConditionSet(std::move(result));
+}
+
+ClosureTable::ClosureTable() :
+    _universe(), _first(0), _count(0), _interval(false), _size(0), _words(0)
+{ }
+
+void ClosureTable::build(const RelationTable& relation, 
+        ConditionUniversePtr universe, int first, int count, ClosureMode mode)
+{
+    _universe = universe;
+    _first = first;
+    _count = count;
+
+    /*
+     * Interval labels cannot represent a relation with shared
+     * descendants, so such relations always use the bit matrix.
+     */
+    bool forest = mode != CLOSURE_MATRIX && is_forest(relation);
+    _interval = forest && (mode == CLOSURE_INTERVAL || 
+            size_t(_count) > MATRIX_LIMIT);
+
+    if(_interval) {
+        build_interval(relation);
+    } else {
+        build_matrix(relation);
+    }
+}
+
+bool ClosureTable::is_forest(const RelationTable& relation) const {
+    std::vector<char> has_parent(_count, 0);
+
+    for(int i = 0; i < _count; ++i) {
+        for(RelationTable::id_iterator it = relation.right_begin(_first + i);
+                it != relation.right_end(_first + i); ++it)
+        {
+            int child = get_index(*it);
+            if(child == -1) {
+                continue;
+            }
+
+            if(has_parent[child]) {
+                return false;
+            }
+            has_parent[child] = 1;
+        }
+    }
+    return true;
+}
+
+/*
+ * The rows are filled in reverse topological order so that each row is
+ * the union of the rows of its direct successors, one word at a time.
+ * Cyclic relations such as recursive calls fall back to Warshall's
+ * algorithm.
+ */
+void ClosureTable::build_matrix(const RelationTable& relation) {
+    _words = (_count + WORD_BITS - 1) / WORD_BITS;
+    _rows.assign(_words * _count, 0);
+
+    std::vector< std::vector<int> > successors(_count);
+    std::vector<int> in_degree(_count, 0);
+
+    for(int i = 0; i < _count; ++i) {
+        for(RelationTable::id_iterator it = relation.right_begin(_first + i);
+                it != relation.right_end(_first + i); ++it)
+        {
+            int j = get_index(*it);
+            if(j != -1) {
+                successors[i].push_back(j);
+                ++in_degree[j];
+            }
+        }
+    }
+
+    std::vector<int> order;
+    order.reserve(_count);
+    for(int i = 0; i < _count; ++i) {
+        if(in_degree[i] == 0) {
+            order.push_back(i);
+        }
+    }
+
+    for(size_t k = 0; k < order.size(); ++k) {
+        std::vector<int>& next = successors[order[k]];
+        for(size_t j = 0; j < next.size(); ++j) {
+            if(--in_degree[next[j]] == 0) {
+                order.push_back(next[j]);
+            }
+        }
+    }
+
+    if(order.size() == size_t(_count)) {
+        for(int k = _count - 1; k >= 0; --k) {
+            int i = order[k];
+            Word *row = &_rows[i * _words];
+
+            for(size_t s = 0; s < successors[i].size(); ++s) {
+                int j = successors[i][s];
+                const Word *other = &_rows[j * _words];
+
+                row[j / WORD_BITS] |= Word(1) << (j % WORD_BITS);
+                for(size_t w = 0; w < _words; ++w) {
+                    row[w] |= other[w];
+                }
+            }
+        }
+    } else {
+        for(int i = 0; i < _count; ++i) {
+            for(size_t s = 0; s < successors[i].size(); ++s) {
+                int j = successors[i][s];
+                _rows[i * _words + j / WORD_BITS] |= Word(1) << (j % WORD_BITS);
+            }
+        }
+
+        for(int k = 0; k < _count; ++k) {
+            const Word *other = &_rows[k * _words];
+
+            for(int i = 0; i < _count; ++i) {
+                if(!test_bit(i, k)) {
+                    continue;
+                }
+
+                Word *row = &_rows[i * _words];
+                for(size_t w = 0; w < _words; ++w) {
+                    row[w] |= other[w];
+                }
+            }
+        }
+    }
+
+    _size = 0;
+    for(size_t w = 0; w < _rows.size(); ++w) {
+        _size += __builtin_popcountll(_rows[w]);
+    }
+
+    _has_left.assign(_count, 0);
+    for(int i = 0; i < _count; ++i) {
+        for(int j = 0; j < _count; ++j) {
+            if(test_bit(i, j)) {
+                _has_left[j] = 1;
+            }
+        }
+    }
+}
+
+/*
+ * Walks the forest in pre-order without recursion, since a long
+ * statement list forms a single deep chain in Follows.
+ */
+void ClosureTable::build_interval(const RelationTable& relation) {
+    _parent.assign(_count, -1);
+    _begin.assign(_count, 0);
+    _end.assign(_count, 0);
+    _order.clear();
+    _order.reserve(_count);
+
+    for(int i = 0; i < _count; ++i) {
+        for(RelationTable::id_iterator it = relation.right_begin(_first + i);
+                it != relation.right_end(_first + i); ++it)
+        {
+            int j = get_index(*it);
+            if(j != -1) {
+                _parent[j] = i;
+            }
+        }
+    }
+
+    std::vector<int> stack;
+    for(int root = 0; root < _count; ++root) {
+        if(_parent[root] != -1) {
+            continue;
+        }
+
+        stack.push_back(root);
+        while(!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+
+            _begin[i] = _order.size();
+            _order.push_back(i);
+
+            RelationTable::id_iterator begin = relation.right_begin(_first + i);
+            RelationTable::id_iterator it = relation.right_end(_first + i);
+            while(it != begin) {
+                int j = get_index(*--it);
+                if(j != -1) {
+                    stack.push_back(j);
+                }
+            }
+        }
+    }
+
+    // children always come after their parent in pre-order
+    std::vector<int> size(_count, 1);
+    _size = 0;
+    for(int k = _count - 1; k >= 0; --k) {
+        int i = _order[k];
+        _end[i] = _begin[i] + size[i];
+        _size += size[i] - 1;
+        if(_parent[i] != -1) {
+            size[_parent[i]] += size[i];
+        }
+    }
+}
+
+int ClosureTable::get_index(int id) const {
+    if(id < _first || id >= _first + _count) {
+        return -1;
+    }
+    return id - _first;
+}
+
+bool ClosureTable::test_bit(int row, int column) const {
+    return (_rows[row * _words + column / WORD_BITS] >> 
+            (column % WORD_BITS)) & 1;
+}
+
+void ClosureTable::save(SnapshotWriter& out) const {
+    out.write_int(_first);
+    out.write_int(_count);
+    out.write_u8(_interval);
+    out.write_u64(_size);
+    out.write_u64(_words);
+    out.write_array(_rows);
+    out.write_array(_has_left);
+    out.write_array(_begin);
+    out.write_array(_end);
+    out.write_array(_order);
+    out.write_array(_parent);
+}
+
+void ClosureTable::load(SnapshotReader& in, ConditionUniversePtr universe) {
+    _universe = universe;
+    _first = in.read_int();
+    _count = in.read_int();
+    _interval = in.read_u8() != 0;
+    _size = in.read_u64();
+    _words = in.read_u64();
+    in.read_array(_rows);
+    in.read_array(_has_left);
+    in.read_array(_begin);
+    in.read_array(_end);
+    in.read_array(_order);
+    in.read_array(_parent);
+}
+
+bool ClosureTable::validate(int left, int right) const {
+    int i = get_index(left), j = get_index(right);
+    if(i == -1 || j == -1) {
+        return false;
+    }
+
+    if(_interval) {
+        return _begin[i] < _begin[j] && _begin[j] < _end[i];
+    } else {
+        return test_bit(i, j);
+    }
+}
+
+ConditionSet ClosureTable::solve_right(int left) const {
+    int i = get_index(left);
+    if(i == -1) {
+        return ConditionSet();
+    }
+
+    std::set<ConditionPtr> result;
+    if(_interval) {
+        for(int k = _begin[i] + 1; k < _end[i]; ++k) {
+            result.insert(_universe->get_condition(_first + _order[k]));
+        }
+    } else {
+        const Word *row = &_rows[i * _words];
+        for(size_t w = 0; w < _words; ++w) {
+            Word bits = row[w];
+            while(bits != 0) {
+                int j = w * WORD_BITS + __builtin_ctzll(bits);
+                result.insert(result.end(), _universe->get_condition(_first + j));
+                bits &= bits - 1;
+            }
+        }
+    }
+    return ConditionSet(std::move(result));
+}
+
+ConditionSet ClosureTable::solve_left(int right) const {
+    int j = get_index(right);
+    if(j == -1) {
+        return ConditionSet();
+    }
+
+    std::set<ConditionPtr> result;
+    if(_interval) {
+        for(int i = _parent[j]; i != -1; i = _parent[i]) {
+            result.insert(_universe->get_condition(_first + i));
+        }
+    } else {
+        for(int i = 0; i < _count; ++i) {
+            if(test_bit(i, j)) {
+                result.insert(result.end(), _universe->get_condition(_first + i));
+            }
+        }
+    }
+    return ConditionSet(std::move(result));
+}
+
+bool ClosureTable::has_right(int left) const {
+    int i = get_index(left);
+    if(i == -1) {
+        return false;
+    }
+
+    if(_interval) {
+        return _end[i] > _begin[i] + 1;
+    }
+
+    const Word *row = &_rows[i * _words];
+    for(size_t w = 0; w < _words; ++w) {
+        if(row[w] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ClosureTable::has_left(int right) const {
+    int j = get_index(right);
+    if(j == -1) {
+        return false;
+    }
+
+    if(_interval) {
+        return _parent[j] != -1;
+    } else {
+        return _has_left[j] != 0;
+    }
+}
+
+size_t ClosureTable::get_size() const {
+    return _size;
+}
+
+bool ClosureTable::is_interval() const {
+    return _interval;
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,187 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include "simple/condition_set.h"
+#include "impl/snapshot.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * RelationTable stores a binary relation between interned conditions
+ * as a pair of compressed adjacency arrays, one indexed by the ID of
+ * the left condition and one indexed by the ID of the right condition.
+ * Each row lists the related IDs in ascending order.
+ */
+class RelationTable {
+  public:
+    RelationTable();
+
+    /*
+     * Pairs can only be added before the table is built.
+     */
+    void add_pair(int left, int right);
+    void build(ConditionUniversePtr universe);
+
+    /*
+     * A loaded table replaces build() and is read from a snapshot of a
+     * table built over the same universe.
+     */
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in, ConditionUniversePtr universe);
+
+    bool validate(int left, int right) const;
+    ConditionSet solve_right(int left) const;
+    ConditionSet solve_left(int right) const;
+
+    bool has_right(int left) const;
+    bool has_left(int right) const;
+
+    /*
+     * The conditions with at least one right partner and the ones
+     * with at least one left partner.
+     */
+    const ConditionSet& get_domain() const;
+    const ConditionSet& get_range() const;
+
+    size_t get_size() const;
+
+    /*
+     * Iterates the IDs related to the given ID in ascending order.
+     */
+    typedef std::vector<int>::const_iterator id_iterator;
+    id_iterator right_begin(int left) const;
+    id_iterator right_end(int left) const;
+    id_iterator left_begin(int right) const;
+    id_iterator left_end(int right) const;
+
+  private:
+    class Adjacency {
+      public:
+        void build(std::vector< std::pair<int, int> >& pairs, size_t size);
+
+        void save(SnapshotWriter& out) const;
+        void load(SnapshotReader& in);
+
+        bool has_target(int source, int target) const;
+        bool has_targets(int source) const;
+
+        id_iterator begin(int source) const;
+        id_iterator end(int source) const;
+
+        ConditionSet get_targets(int source,
+                const ConditionUniversePtr& universe) const;
+        ConditionSet get_sources(const ConditionUniversePtr& universe) const;
+
+      private:
+        std::vector<int> _offsets;
+        std::vector<int> _targets;
+    };
+
+    ConditionUniversePtr                _universe;
+    std::vector< std::pair<int, int> >  _pairs;
+    Adjacency   _right;
+    Adjacency   _left;
+    size_t      _size;
+
+    ConditionSet _domain;
+    ConditionSet _range;
+};
+
+/*
+ * ClosureTable stores the transitive closure of a RelationTable over a
+ * contiguous range of condition IDs, such as all statements or all
+ * procedures.
+ *
+ * CLOSURE_MATRIX keeps one bit per pair of IDs in the range, so a
+ * validate() is a single bit test. CLOSURE_INTERVAL only needs linear
+ * memory but requires each ID to have at most one left partner, as in
+ * Parent and Follows: every ID is labeled with the interval of its
+ * descendants in a pre-order walk of the forest. CLOSURE_AUTO picks
+ * the interval labels for forests larger than MATRIX_LIMIT.
+ */
+enum ClosureMode {
+    CLOSURE_AUTO,
+    CLOSURE_MATRIX,
+    CLOSURE_INTERVAL
+};
+
+class ClosureTable {
+  public:
+    ClosureTable();
+
+    void build(const RelationTable& relation, ConditionUniversePtr universe,
+            int first, int count, ClosureMode mode);
+
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in, ConditionUniversePtr universe);
+
+    bool validate(int left, int right) const;
+    ConditionSet solve_right(int left) const;
+    ConditionSet solve_left(int right) const;
+
+    bool has_right(int left) const;
+    bool has_left(int right) const;
+
+    size_t get_size() const;
+    bool is_interval() const;
+
+    static const size_t MATRIX_LIMIT = 4096;
+
+  private:
+    typedef unsigned long long Word;
+    static const size_t WORD_BITS = 64;
+
+    bool is_forest(const RelationTable& relation) const;
+    void build_matrix(const RelationTable& relation);
+    void build_interval(const RelationTable& relation);
+
+    int get_index(int id) const;
+    bool test_bit(int row, int column) const;
+
+    ConditionUniversePtr _universe;
+    int         _first;
+    int         _count;
+    bool        _interval;
+    size_t      _size;
+
+    /*
+     * Bit matrix, one row of _words words per ID in the range.
+     */
+    size_t              _words;
+    std::vector<Word>   _rows;
+    std::vector<char>   _has_left;
+
+    /*
+     * Interval labels. The descendants of index i are found at
+     * _order[_begin[i] + 1] up to _order[_end[i] - 1].
+     */
+    std::vector<int>    _begin;
+    std::vector<int>    _end;
+    std::vector<int>    _order;
+    std::vector<int>    _parent;
+};
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,605 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "simple/condition_table.h"
+#include "impl/result_table.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+ConditionDictionary::ConditionDictionary() : _table(NULL) { }
+
+int ConditionDictionary::get_id(const ConditionPtr& condition) {
+    int id = find_id(condition);
+    if(id != -1) {
+        return id;
+    }
+
+    id = _conditions.size();
+    _conditions.push_back(condition);
+
+    if(_table == NULL && condition.get_table() != NULL) {
+        _table = condition.get_table();
+    }
+
+    if(condition.get_table() != NULL && condition.get_table() == _table) {
+        _interned_ids[condition.get_id()] = id;
+    } else {
+        _other_ids[condition] = id;
+    }
+    return id;
+}
+
+/*
+ * A condition from another table may still be equal to one from the
+ * first table, so it is looked up in that table by value as well.
+ */
+int ConditionDictionary::find_id(const ConditionPtr& condition) const {
+    int interned_id = -1;
+    if(condition.get_table() != NULL && condition.get_table() == _table) {
+        interned_id = condition.get_id();
+    } else {
+        std::map<ConditionPtr, int>::const_iterator it = 
+            _other_ids.find(condition);
+        if(it != _other_ids.end()) {
+            return it->second;
+        }
+
+        if(_table != NULL) {
+            interned_id = _table->get_universe()->find_id(condition);
+        }
+    }
+
+    std::unordered_map<int, int>::const_iterator it = 
+        _interned_ids.find(interned_id);
+    return it != _interned_ids.end() ? it->second : -1;
+}
+
+const ConditionPtr& ConditionDictionary::get_condition(int id) const {
+    return _conditions[id];
+}
+
+size_t ConditionDictionary::get_size() const {
+    return _conditions.size();
+}
+
+ResultTable::ResultTable() : _rows(0) { }
+
+ResultTable::ResultTable(const std::string& qvar, const Column& values) :
+    _qvars(1, qvar), _columns(1, values), _rows(values.size())
+{ }
+
+size_t ResultTable::get_row_count() const {
+    return _rows;
+}
+
+size_t ResultTable::get_column_count() const {
+    return _columns.size();
+}
+
+int ResultTable::find_column(const std::string& qvar) const {
+    std::vector<std::string>::const_iterator it = 
+        std::find(_qvars.begin(), _qvars.end(), qvar);
+    return it != _qvars.end() ? it - _qvars.begin() : -1;
+}
+
+const std::vector<std::string>& ResultTable::get_qvars() const {
+    return _qvars;
+}
+
+const ResultTable::Column& ResultTable::get_column(size_t column) const {
+    return _columns[column];
+}
+
+void ResultTable::semi_join(size_t column, const ValueSet& values,
+        const QueryBudgetPtr& budget)
+{
+    std::vector<size_t> rows;
+    const Column& target = _columns[column];
+
+    for(size_t row = 0; row < _rows; ++row) {
+        check_budget(budget);
+        if(values.count(target[row]) > 0) {
+            rows.push_back(row);
+        }
+    }
+
+    if(rows.size() != _rows) {
+        keep_rows(rows);
+    }
+}
+
+void ResultTable::semi_join(size_t column1, size_t column2, 
+        const PairSet& pairs, const QueryBudgetPtr& budget)
+{
+    std::vector<size_t> rows;
+    const Column& target1 = _columns[column1];
+    const Column& target2 = _columns[column2];
+
+    for(size_t row = 0; row < _rows; ++row) {
+        check_budget(budget);
+        if(pairs.count(make_pair_key(target1[row], target2[row])) > 0) {
+            rows.push_back(row);
+        }
+    }
+
+    if(rows.size() != _rows) {
+        keep_rows(rows);
+    }
+}
+
+ResultTable ResultTable::hash_join(
+        const ResultTable& left, size_t left_column,
+        const ResultTable& right, size_t right_column,
+        const LinkMap& links, const QueryBudgetPtr& budget)
+{
+    // index the rows of the right table by their join value
+    std::unordered_map<int, std::vector<size_t> > right_rows;
+    const Column& right_values = right._columns[right_column];
+    for(size_t row = 0; row < right._rows; ++row) {
+        right_rows[right_values[row]].push_back(row);
+    }
+
+    std::vector<size_t> left_matches;
+    std::vector<size_t> right_matches;
+    const Column& left_values = left._columns[left_column];
+
+    for(size_t row = 0; row < left._rows; ++row) {
+        LinkMap::const_iterator partners = links.find(left_values[row]);
+        if(partners == links.end()) {
+            continue;
+        }
+
+        for(size_t i = 0; i < partners->second.size(); ++i) {
+            std::unordered_map<int, std::vector<size_t> >::const_iterator 
+                matches = right_rows.find(partners->second[i]);
+            if(matches == right_rows.end()) {
+                continue;
+            }
+
+            for(size_t j = 0; j < matches->second.size(); ++j) {
+                check_budget(budget);
+                left_matches.push_back(row);
+                right_matches.push_back(matches->second[j]);
+            }
+        }
+    }
+
+    ResultTable result;
+    result._rows = left_matches.size();
+    result._qvars = left._qvars;
+    result._qvars.insert(result._qvars.end(), 
+            right._qvars.begin(), right._qvars.end());
+
+    for(size_t c = 0; c < left._columns.size(); ++c) {
+        Column column(result._rows);
+        for(size_t row = 0; row < result._rows; ++row) {
+            column[row] = left._columns[c][left_matches[row]];
+        }
+        result._columns.push_back(std::move(column));
+    }
+
+    for(size_t c = 0; c < right._columns.size(); ++c) {
+        Column column(result._rows);
+        for(size_t row = 0; row < result._rows; ++row) {
+            column[row] = right._columns[c][right_matches[row]];
+        }
+        result._columns.push_back(std::move(column));
+    }
+
+    return result;
+}
+
+ResultTable ResultTable::project(const std::vector<size_t>& columns) const {
+    ResultTable result;
+    result._rows = _rows;
+
+    for(size_t i = 0; i < columns.size(); ++i) {
+        result._qvars.push_back(_qvars[columns[i]]);
+        result._columns.push_back(_columns[columns[i]]);
+    }
+
+    result.remove_duplicates();
+    return result;
+}
+
+void ResultTable::drop_column(size_t column) {
+    _qvars.erase(_qvars.begin() + column);
+    _columns.erase(_columns.begin() + column);
+    remove_duplicates();
+}
+
+unsigned long long ResultTable::make_pair_key(int value1, int value2) {
+    return (static_cast<unsigned long long>(static_cast<unsigned>(value1)) << 32) |
+        static_cast<unsigned>(value2);
+}
+
+void ResultTable::keep_rows(const std::vector<size_t>& rows) {
+    for(size_t c = 0; c < _columns.size(); ++c) {
+        Column column(rows.size());
+        for(size_t i = 0; i < rows.size(); ++i) {
+            column[i] = _columns[c][rows[i]];
+        }
+        _columns[c].swap(column);
+    }
+    _rows = rows.size();
+}
+
+/*
+ * Rows are sorted by their values before the duplicates are dropped,
+ * so no row needs to be hashed as a whole.
+ */
+void ResultTable::remove_duplicates() {
+    if(_columns.empty()) {
+        _rows = std::min(_rows, size_t(1));
+        return;
+    }
+
+    std::vector<size_t> order(_rows);
+    for(size_t row = 0; row < _rows; ++row) {
+        order[row] = row;
+    }
+
+    const std::vector<Column>& columns = _columns;
+    auto less = [&columns](size_t row1, size_t row2) {
+        for(size_t c = 0; c < columns.size(); ++c) {
+            if(columns[c][row1] != columns[c][row2]) {
+                return columns[c][row1] < columns[c][row2];
+            }
+        }
+        return false;
+    };
+
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<size_t> rows;
+    for(size_t i = 0; i < order.size(); ++i) {
+        if(i == 0 || less(order[i - 1], order[i])) {
+            rows.push_back(order[i]);
+        }
+    }
+
+    if(rows.size() != _rows) {
+        keep_rows(rows);
+    }
+}
+
+ColumnarQueryLinker::ColumnarQueryLinker() : _valid_state(true) { }
+
+void ColumnarQueryLinker::update_links(
+        const std::string& qvar1, const std::string& qvar2, 
+        const std::vector<ConditionPair>& links)
+{
+    if(!is_initialized(qvar1) || !is_initialized(qvar2)) {
+        throw QueryLinkerError();
+    }
+
+    size_t index1 = _qvar_tables[qvar1];
+    size_t index2 = _qvar_tables[qvar2];
+
+    if(index1 == index2) {
+        ResultTable& table = _tables[index1];
+
+        ResultTable::PairSet pairs;
+        for(std::vector<ConditionPair>::const_iterator it = links.begin();
+                it != links.end(); ++it)
+        {
+            int id1 = _dictionary.find_id(it->first);
+            int id2 = _dictionary.find_id(it->second);
+            if(id1 != -1 && id2 != -1) {
+                pairs.insert(ResultTable::make_pair_key(id1, id2));
+            }
+        }
+
+        table.semi_join(table.find_column(qvar1), table.find_column(qvar2),
+                pairs, _budget);
+        check_empty(table);
+        return;
+    }
+
+    ResultTable::LinkMap link_map;
+    for(std::vector<ConditionPair>::const_iterator it = links.begin();
+            it != links.end(); ++it)
+    {
+        int id1 = _dictionary.find_id(it->first);
+        int id2 = _dictionary.find_id(it->second);
+        if(id1 != -1 && id2 != -1) {
+            link_map[id1].push_back(id2);
+        }
+    }
+
+    ResultTable& table1 = _tables[index1];
+    ResultTable& table2 = _tables[index2];
+
+    ResultTable joined = ResultTable::hash_join(
+            table1, table1.find_column(qvar1),
+            table2, table2.find_column(qvar2), link_map, _budget);
+
+    _tables[index1] = std::move(joined);
+
+    for(std::map<std::string, size_t>::iterator it = _qvar_tables.begin();
+            it != _qvar_tables.end(); ++it)
+    {
+        if(it->second == index2) {
+            it->second = index1;
+        }
+    }
+    remove_table(index2);
+    check_empty(get_table(qvar1));
+}
+
+/*
+ * Each distinct pair of values is passed to the filter only once,
+ * however many rows it appears in.
+ */
+bool ColumnarQueryLinker::filter_links(
+        const std::string& qvar1, const std::string& qvar2,
+        LinkFilter *filter)
+{
+    if(!is_initialized(qvar1) || !is_initialized(qvar2) ||
+            _qvar_tables[qvar1] != _qvar_tables[qvar2])
+    {
+        return false;
+    }
+
+    ResultTable& table = get_table(qvar1);
+    size_t column1 = table.find_column(qvar1);
+    size_t column2 = table.find_column(qvar2);
+    const ResultTable::Column& values1 = table.get_column(column1);
+    const ResultTable::Column& values2 = table.get_column(column2);
+
+    ResultTable::PairSet checked;
+    ResultTable::PairSet pairs;
+    for(size_t row = 0; row < table.get_row_count(); ++row) {
+        check_budget(_budget);
+
+        unsigned long long key = ResultTable::make_pair_key(
+                values1[row], values2[row]);
+        if(checked.insert(key).second && filter->is_linked(
+                    _dictionary.get_condition(values1[row]),
+                    _dictionary.get_condition(values2[row])))
+        {
+            pairs.insert(key);
+        }
+    }
+
+    table.semi_join(column1, column2, pairs, _budget);
+    check_empty(table);
+    return true;
+}
+
+void ColumnarQueryLinker::update_results(const std::string& qvar, 
+        const ConditionSet& conditions)
+{
+    if(!is_initialized(qvar)) {
+        ResultTable::Column values;
+        for(ConditionSet::iterator it = conditions.begin(); 
+                it != conditions.end(); ++it)
+        {
+            check_budget(_budget);
+            values.push_back(_dictionary.get_id(*it));
+        }
+
+        _qvar_tables[qvar] = _tables.size();
+        _tables.push_back(ResultTable(qvar, values));
+        check_empty(_tables.back());
+        return;
+    }
+
+    ResultTable::ValueSet values;
+    for(ConditionSet::iterator it = conditions.begin(); 
+            it != conditions.end(); ++it)
+    {
+        check_budget(_budget);
+        int id = _dictionary.find_id(*it);
+        if(id != -1) {
+            values.insert(id);
+        }
+    }
+
+    ResultTable& table = get_table(qvar);
+    table.semi_join(table.find_column(qvar), values, _budget);
+    check_empty(table);
+}
+
+TupleList ColumnarQueryLinker::make_tuples(
+        const std::vector<std::string>& variables) 
+{
+    TupleCollector collector;
+    enumerate_tuples(variables, &collector);
+    return collector.result;
+}
+
+/*
+ * The tuples are the cross product of the projections of every table
+ * that holds one of the variables.
+ */
+void ColumnarQueryLinker::enumerate_tuples(
+        const std::vector<std::string>& variables, TupleVisitor *visitor)
+{
+    for(size_t i = 0; i < variables.size(); ++i) {
+        if(!is_initialized(variables[i])) {
+            throw QueryLinkerError();
+        }
+    }
+
+    if(!_valid_state || variables.empty()) {
+        return;
+    }
+
+    // the position of each variable in the projection of its table
+    std::vector<size_t> table_indices;
+    std::vector<ResultTable> projections;
+    std::vector< std::pair<size_t, size_t> > positions;
+
+    for(size_t i = 0; i < variables.size(); ++i) {
+        size_t index = _qvar_tables[variables[i]];
+        size_t slot = std::find(table_indices.begin(), table_indices.end(), 
+                index) - table_indices.begin();
+
+        if(slot == table_indices.size()) {
+            table_indices.push_back(index);
+        }
+        positions.push_back(std::make_pair(slot, 0));
+    }
+
+    for(size_t slot = 0; slot < table_indices.size(); ++slot) {
+        const ResultTable& table = _tables[table_indices[slot]];
+        std::vector<size_t> columns;
+
+        for(size_t i = 0; i < variables.size(); ++i) {
+            if(positions[i].first != slot) {
+                continue;
+            }
+
+            size_t column = table.find_column(variables[i]);
+            std::vector<size_t>::iterator it = 
+                std::find(columns.begin(), columns.end(), column);
+
+            positions[i].second = it - columns.begin();
+            if(it == columns.end()) {
+                columns.push_back(column);
+            }
+        }
+
+        projections.push_back(table.project(columns));
+    }
+
+    std::vector<size_t> rows(projections.size(), 0);
+    std::vector<ConditionPtr> row;
+    row.reserve(variables.size());
+
+    while(true) {
+        check_budget(_budget);
+
+        row.clear();
+        for(size_t i = 0; i < variables.size(); ++i) {
+            const ResultTable& projection = projections[positions[i].first];
+            row.push_back(_dictionary.get_condition(projection.get_column(
+                        positions[i].second)[rows[positions[i].first]]));
+        }
+        visitor->visit_tuple(row);
+
+        // advance to the next combination of rows
+        size_t slot = 0;
+        while(slot < rows.size() && 
+                ++rows[slot] == projections[slot].get_row_count()) 
+        {
+            rows[slot++] = 0;
+        }
+
+        if(slot == rows.size()) {
+            break;
+        }
+    }
+}
+
+bool ColumnarQueryLinker::is_valid_state() {
+    return _valid_state;
+}
+
+void ColumnarQueryLinker::invalidate_state() {
+    _valid_state = false;
+}
+
+bool ColumnarQueryLinker::is_initialized(const std::string& qvar) {
+    return _qvar_tables.count(qvar) > 0;
+}
+
+ConditionSet ColumnarQueryLinker::get_conditions(const std::string& qvar,
+        SimplePredicate *pred)
+{
+    ensure_initialized(qvar, pred);
+    return get_conditions(qvar);
+}
+
+void ColumnarQueryLinker::ensure_initialized(const std::string& qvar,
+        SimplePredicate *pred)
+{
+    if(!is_initialized(qvar)) {
+        update_results(qvar, pred->global_set());
+    }
+}
+
+ConditionSet ColumnarQueryLinker::get_conditions(const std::string& qvar) {
+    ConditionSet result;
+    if(!is_initialized(qvar)) {
+        return result;
+    }
+
+    const ResultTable& table = get_table(qvar);
+    const ResultTable::Column& column = table.get_column(
+            table.find_column(qvar));
+
+    std::vector<bool> seen(_dictionary.get_size(), false);
+    for(size_t row = 0; row < column.size(); ++row) {
+        if(!seen[column[row]]) {
+            seen[column[row]] = true;
+            result.insert(_dictionary.get_condition(column[row]));
+        }
+    }
+    return result;
+}
+
+void ColumnarQueryLinker::drop_qvar(const std::string& qvar) {
+    if(!is_initialized(qvar)) {
+        return;
+    }
+
+    size_t index = _qvar_tables[qvar];
+    ResultTable& table = _tables[index];
+
+    table.drop_column(table.find_column(qvar));
+    _qvar_tables.erase(qvar);
+
+    if(table.get_column_count() == 0) {
+        remove_table(index);
+    }
+}
+
+void ColumnarQueryLinker::set_budget(const QueryBudgetPtr& budget) {
+    _budget = budget;
+}
+
+ResultTable& ColumnarQueryLinker::get_table(const std::string& qvar) {
+    return _tables[_qvar_tables[qvar]];
+}
+
+void ColumnarQueryLinker::remove_table(size_t index) {
+    _tables.erase(_tables.begin() + index);
+
+    for(std::map<std::string, size_t>::iterator it = _qvar_tables.begin();
+            it != _qvar_tables.end(); ++it)
+    {
+        if(it->second > index) {
+            --it->second;
+        }
+    }
+}
+
+void ColumnarQueryLinker::check_empty(const ResultTable& table) {
+    if(table.get_row_count() == 0) {
+        invalidate_state();
+    }
+}
+
+} // namespace impl
+} // namespace simple
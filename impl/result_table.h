@@ -0,0 +1,194 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "simple/linker.h"
+#include "simple/condition_set.h"
+#include "impl/linker.h"
+#include "impl/budget.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * ConditionDictionary gives the conditions stored in a result table
+ * dense local IDs. Conditions interned in a condition table are
+ * looked up by their interned ID, the others by value.
+ */
+class ConditionDictionary {
+  public:
+    ConditionDictionary();
+
+    /*
+     * Returns the ID of the condition, adding it if it is new.
+     */
+    int get_id(const ConditionPtr& condition);
+
+    /*
+     * Returns -1 if the condition has never been added.
+     */
+    int find_id(const ConditionPtr& condition) const;
+
+    const ConditionPtr& get_condition(int id) const;
+
+    size_t get_size() const;
+
+  private:
+    const ConditionTable            *_table;
+    std::unordered_map<int, int>    _interned_ids;
+    std::map<ConditionPtr, int>     _other_ids;
+    std::vector<ConditionPtr>       _conditions;
+};
+
+/*
+ * ResultTable holds the joined results of a set of connected query
+ * variables, with one column of condition IDs per query variable.
+ * Every row is one combination of conditions that satisfies all
+ * clauses solved on these variables so far.
+ */
+class ResultTable {
+  public:
+    typedef std::vector<int> Column;
+    typedef std::unordered_set<int> ValueSet;
+    typedef std::unordered_set<unsigned long long> PairSet;
+    typedef std::unordered_map<int, std::vector<int> > LinkMap;
+
+    ResultTable();
+    ResultTable(const std::string& qvar, const Column& values);
+
+    size_t get_row_count() const;
+    size_t get_column_count() const;
+
+    /*
+     * Returns -1 if the query variable has no column in the table.
+     */
+    int find_column(const std::string& qvar) const;
+    const std::vector<std::string>& get_qvars() const;
+    const Column& get_column(size_t column) const;
+
+    /*
+     * Semi-joins keep the rows whose value in a column, or whose pair
+     * of values in two columns, is in the given set.
+     */
+    void semi_join(size_t column, const ValueSet& values,
+            const QueryBudgetPtr& budget = QueryBudgetPtr());
+
+    void semi_join(size_t column1, size_t column2, const PairSet& pairs,
+            const QueryBudgetPtr& budget = QueryBudgetPtr());
+
+    /*
+     * Joins the rows of both tables whose values in the join columns
+     * are linked, with the columns of left followed by those of right.
+     */
+    static ResultTable hash_join(
+            const ResultTable& left, size_t left_column,
+            const ResultTable& right, size_t right_column,
+            const LinkMap& links, 
+            const QueryBudgetPtr& budget = QueryBudgetPtr());
+
+    /*
+     * Returns the distinct rows of the given columns.
+     */
+    ResultTable project(const std::vector<size_t>& columns) const;
+
+    void drop_column(size_t column);
+
+    static unsigned long long make_pair_key(int value1, int value2);
+
+  private:
+    void keep_rows(const std::vector<size_t>& rows);
+    void remove_duplicates();
+
+    std::vector<std::string>    _qvars;
+    std::vector<Column>         _columns;
+    size_t                      _rows;
+};
+
+/*
+ * ColumnarQueryLinker keeps the results of connected query variables
+ * in a ResultTable. Single variable results are semi-joined into the
+ * table, and links between variables in two different tables
+ * hash-join them into one. Tuples are projections of the tables with
+ * the duplicates removed, instead of being expanded link by link.
+ */
+class ColumnarQueryLinker : public QueryLinker {
+  public:
+    ColumnarQueryLinker();
+
+    void update_links(const std::string& qvar1, 
+                   const std::string& qvar2, 
+                   const std::vector<ConditionPair>& links);
+
+    /*
+     * Filters the rows of the table that holds both query variables.
+     */
+    bool filter_links(const std::string& qvar1,
+                   const std::string& qvar2,
+                   LinkFilter *filter);
+
+    void update_results(const std::string& qvar,
+                       const ConditionSet& conditions);
+
+    TupleList make_tuples(const std::vector<std::string>& variables);
+
+    void enumerate_tuples(const std::vector<std::string>& variables,
+            TupleVisitor *visitor);
+
+    bool is_valid_state();
+    void invalidate_state();
+
+    bool is_initialized(const std::string& qvar);
+
+    ConditionSet get_conditions(const std::string& qvar,
+            SimplePredicate *pred);
+
+    ConditionSet get_conditions(const std::string& qvar);
+
+    void ensure_initialized(const std::string& qvar, SimplePredicate *pred);
+
+    /*
+     * Projects the query variable out of its table once no clause
+     * needs it anymore, which keeps the tables from growing with
+     * variables that are neither selected nor joined on again.
+     */
+    void drop_qvar(const std::string& qvar);
+
+    void set_budget(const QueryBudgetPtr& budget);
+
+  private:
+    ResultTable& get_table(const std::string& qvar);
+    void remove_table(size_t index);
+    void check_empty(const ResultTable& table);
+
+    std::vector<ResultTable>        _tables;
+    std::map<std::string, size_t>   _qvar_tables;
+    ConditionDictionary             _dictionary;
+    bool                            _valid_state;
+    QueryBudgetPtr                  _budget;
+};
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,148 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "simple/condition_set.h"
+#include "simple/tuple.h"
+#include "simple/util/condition_utils.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+using namespace simple::util;
+
+/*
+ * ResultWriter formats query results into a buffer that is reused for
+ * the whole result and copied to the output iterator in large chunks.
+ * Conditions are appended in place, so writing a result element does
+ * not allocate.
+ */
+template <typename OutputIterator>
+class ResultWriter {
+  public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    ResultWriter(OutputIterator& out, size_t chunk_size = CHUNK_SIZE) :
+        _out(out), _chunk_size(chunk_size), _first(true)
+    {
+        _buffer.reserve(chunk_size + 256);
+    }
+
+    void write(const std::string& text) {
+        _buffer += text;
+        flush_if_full();
+    }
+
+    void write(const char *text) {
+        _buffer += text;
+        flush_if_full();
+    }
+
+    void write_int(long value) {
+        append_int(value, _buffer);
+        flush_if_full();
+    }
+
+    void write_condition(SimpleCondition *condition) {
+        append_condition(condition, _buffer);
+        flush_if_full();
+    }
+
+    /*
+     * Writes the conditions separated by ", ".
+     */
+    void write_element(SimpleCondition *condition) {
+        write_separator();
+        write_condition(condition);
+    }
+
+    void write_elements(const ConditionSet& conditions) {
+        for(ConditionSet::iterator it = conditions.begin(); 
+                it != conditions.end(); ++it)
+        {
+            write_element(it->get());
+        }
+    }
+
+    /*
+     * Writes a row of a tuple as one element, with its conditions
+     * separated by spaces.
+     */
+    void write_tuple(const std::vector<ConditionPtr>& row) {
+        write_separator();
+        for(size_t i = 0; i < row.size(); ++i) {
+            if(i != 0) {
+                _buffer += ' ';
+            }
+            append_condition(row[i].get(), _buffer);
+        }
+        flush_if_full();
+    }
+
+    void flush() {
+        std::copy(_buffer.begin(), _buffer.end(), _out);
+        _buffer.clear();
+    }
+
+    ~ResultWriter() {
+        flush();
+    }
+
+  private:
+    void write_separator() {
+        if(!_first) {
+            _buffer += ", ";
+        }
+        _first = false;
+    }
+
+    void flush_if_full() {
+        if(_buffer.size() >= _chunk_size) {
+            flush();
+        }
+    }
+
+    OutputIterator&     _out;
+    size_t              _chunk_size;
+    std::string         _buffer;
+    bool                _first;
+};
+
+/*
+ * Writes each enumerated tuple row as it arrives.
+ */
+template <typename OutputIterator>
+class TupleWriter : public TupleVisitor {
+  public:
+    TupleWriter(ResultWriter<OutputIterator>& writer) : _writer(writer) { }
+
+    void visit_tuple(const std::vector<ConditionPtr>& row) {
+        _writer.write_tuple(row);
+    }
+
+  private:
+    ResultWriter<OutputIterator>& _writer;
+};
+
+} // namespace impl
+} // namespace simple
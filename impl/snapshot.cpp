@@ -0,0 +1,151 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "impl/snapshot.h"
+
+namespace simple {
+namespace impl {
+
+uint64_t snapshot_checksum(const char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void SnapshotWriter::write_u8(unsigned char value) {
+    write_bytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::write_int(int value) {
+    write_bytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::write_u64(uint64_t value) {
+    write_bytes(&value, sizeof(value));
+}
+
+void SnapshotWriter::write_string(const std::string& value) {
+    write_u64(value.size());
+    write_bytes(value.data(), value.size());
+}
+
+const std::string& SnapshotWriter::get_data() const {
+    return _data;
+}
+
+void SnapshotWriter::write_bytes(const void *data, size_t size) {
+    _data.append(static_cast<const char*>(data), size);
+}
+
+SnapshotReader::SnapshotReader(const char *data, size_t size) :
+    _data(data), _size(size), _offset(0)
+{ }
+
+unsigned char SnapshotReader::read_u8() {
+    unsigned char value;
+    read_bytes(&value, sizeof(value));
+    return value;
+}
+
+int SnapshotReader::read_int() {
+    int value;
+    read_bytes(&value, sizeof(value));
+    return value;
+}
+
+uint64_t SnapshotReader::read_u64() {
+    uint64_t value;
+    read_bytes(&value, sizeof(value));
+    return value;
+}
+
+std::string SnapshotReader::read_string() {
+    uint64_t size = read_u64();
+    if(size > _size - _offset) {
+        throw SnapshotError("truncated snapshot");
+    }
+
+    std::string value(_data + _offset, size);
+    _offset += size;
+    return value;
+}
+
+bool SnapshotReader::at_end() const {
+    return _offset == _size;
+}
+
+void SnapshotReader::read_bytes(void *data, size_t size) {
+    if(size > _size - _offset) {
+        throw SnapshotError("truncated snapshot");
+    }
+
+    if(size != 0) {
+        memcpy(data, _data + _offset, size);
+    }
+    _offset += size;
+}
+
+MappedFile::MappedFile(const std::string& path) :
+    _data(NULL), _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1) {
+        throw FileError("cannot open file");
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        close(fd);
+        throw FileError("cannot open file");
+    }
+
+    _size = info.st_size;
+    if(_size != 0) {
+        _data = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if(_data == MAP_FAILED) {
+        _data = NULL;
+        throw FileError("cannot map file");
+    }
+}
+
+const char* MappedFile::get_data() const {
+    return static_cast<const char*>(_data);
+}
+
+size_t MappedFile::get_size() const {
+    return _size;
+}
+
+MappedFile::~MappedFile() {
+    if(_data != NULL) {
+        munmap(_data, _size);
+    }
+}
+
+} // namespace impl
+} // namespace simple
@@ -0,0 +1,147 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <exception>
+#include <stdint.h>
+
+namespace simple {
+namespace impl {
+
+class SnapshotError : public std::exception {
+  public:
+    SnapshotError(const char *message) : _message(message) { }
+
+    const char* what() const throw() {
+        return _message;
+    }
+
+  private:
+    const char *_message;
+};
+
+/*
+ * Thrown when a file cannot be opened or mapped.
+ */
+class FileError : public std::exception {
+  public:
+    FileError(const char *message) : _message(message) { }
+
+    const char* what() const throw() {
+        return _message;
+    }
+
+  private:
+    const char *_message;
+};
+
+/*
+ * 64-bit FNV-1a hash, used to tell whether a snapshot was taken from
+ * the same source and whether its contents are intact.
+ */
+uint64_t snapshot_checksum(const char *data, size_t size);
+
+/*
+ * SnapshotWriter appends values in the native byte order. Arrays are
+ * written as their size followed by their raw elements, so the element
+ * type must be trivially copyable.
+ */
+class SnapshotWriter {
+  public:
+    void write_u8(unsigned char value);
+    void write_int(int value);
+    void write_u64(uint64_t value);
+    void write_string(const std::string& value);
+
+    template <typename T>
+    void write_array(const std::vector<T>& values) {
+        write_u64(values.size());
+        write_bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    const std::string& get_data() const;
+
+  private:
+    void write_bytes(const void *data, size_t size);
+
+    std::string _data;
+};
+
+/*
+ * SnapshotReader reads the values written by a SnapshotWriter back
+ * from a memory range, such as a mapped file. Arrays are filled with a
+ * single copy from the range. Reading past the end throws a
+ * SnapshotError.
+ */
+class SnapshotReader {
+  public:
+    SnapshotReader(const char *data, size_t size);
+
+    unsigned char read_u8();
+    int read_int();
+    uint64_t read_u64();
+    std::string read_string();
+
+    template <typename T>
+    void read_array(std::vector<T>& values) {
+        uint64_t count = read_u64();
+        if(count > (_size - _offset) / sizeof(T)) {
+            throw SnapshotError("truncated snapshot");
+        }
+
+        values.resize(count);
+        read_bytes(values.data(), count * sizeof(T));
+    }
+
+    bool at_end() const;
+
+  private:
+    void read_bytes(void *data, size_t size);
+
+    const char  *_data;
+    size_t      _size;
+    size_t      _offset;
+};
+
+/*
+ * MappedFile maps a whole file read-only into memory. Throws a
+ * FileError if the file cannot be opened or mapped.
+ */
+class MappedFile {
+  public:
+    MappedFile(const std::string& path);
+
+    const char* get_data() const;
+    size_t get_size() const;
+
+    ~MappedFile();
+
+  private:
+    MappedFile(const MappedFile& other);
+    MappedFile& operator =(const MappedFile& other);
+
+    void    *_data;
+    size_t  _size;
+};
+
+} // namespace impl
+} // namespace simple
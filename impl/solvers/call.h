@@ -18,11 +18,10 @@
 
 #pragma once
 
-#include <map>
-#include <set>
 #include "simple/ast.h"
 #include "simple/condition.h"
 #include "simple/solver.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -32,7 +31,9 @@ using namespace simple::impl;
 
 class CallSolver {
   public:
-    CallSolver(SimpleRoot ast);
+    CallSolver(SimpleRoot ast, PkbPtr pkb = PkbPtr()) :
+        _ast(ast), _pkb(make_pkb(ast, pkb))
+    { }
 
     /*
      * SOLVE RIGHT PART
@@ -52,17 +53,9 @@ class CallSolver {
         return false;
     }
 
-    template <typename Condition>
-    void index_calls(Condition *condition) {
-        // no-op
-    }
-
-
   private:
-    typedef std::map<ProcAst*, std::set<ProcAst*> > ProcIndex;
     SimpleRoot _ast;
-    ProcIndex _calls_table;
-    ProcIndex _called_table;
+    PkbPtr _pkb;
 };
 
 template <>
@@ -74,24 +67,6 @@ ConditionSet CallSolver::solve_left<ProcAst>(ProcAst *proc);
 template <>
 bool CallSolver::validate<ProcAst, ProcAst>(ProcAst *proc1, ProcAst *proc2);
 
-template <>
-void CallSolver::index_calls<StatementAst>(StatementAst *statement);
-
-template <>
-void CallSolver::index_calls<ProcAst>(ProcAst *proc);
-
-template <>
-void CallSolver::index_calls<CallAst>(CallAst *call);
-
-template <>
-void CallSolver::index_calls<WhileAst>(WhileAst *loop);
-
-template <>
-void CallSolver::index_calls<ConditionalAst>(ConditionalAst *condition);
-
-
-
-
 
 } // namespace impl
 } // namespace simple
@@ -28,32 +28,21 @@ using namespace simple::util;
 
 template <>
 ConditionSet FollowSolver::solve_right<StatementAst>(StatementAst *ast) {
-    ConditionSet result;
-
-    if(ast->next()) {
-        result.insert(new SimpleStatementCondition(ast->next()));
-    }
-    return result;
+    return _pkb->get_follows().solve_right(_pkb->get_statement_id(ast));
 }
     
 template <>
 ConditionSet FollowSolver::solve_left<StatementAst>(StatementAst *ast) {
-    ConditionSet result;
-
-    if(ast->prev()) {
-        result.insert(new SimpleStatementCondition(ast->prev()));
-    }
-    return result;
+    return _pkb->get_follows().solve_left(_pkb->get_statement_id(ast));
 }
 
 template <>
 bool FollowSolver::validate<StatementAst, StatementAst>(
         StatementAst *left, StatementAst *right)
 {
-    return left->next() == right;
+    return _pkb->get_follows().validate(
+            _pkb->get_statement_id(left), _pkb->get_statement_id(right));
 }
 
-
-
 }
 }
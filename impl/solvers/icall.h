@@ -18,11 +18,11 @@
 
 #pragma once
 
-#include <map>
-#include <set>
 #include "simple/ast.h"
 #include "simple/condition.h"
 #include "simple/solver.h"
+#include "impl/condition.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -31,7 +31,9 @@ using namespace simple;
 
 class ICallSolver {
   public:
-    ICallSolver(SimpleRoot ast);
+    ICallSolver(SimpleRoot ast, PkbPtr pkb = PkbPtr()) : 
+        _ast(ast), _pkb(make_pkb(ast, pkb)) 
+    { }
 
     /*
      * SOLVE RIGHT PART
@@ -51,16 +53,9 @@ class ICallSolver {
         return false;
     }
 
-    template <typename Condition>
-    void index_calls(Condition *condition) {
-        // no-op
-    }
-
   private:
-    typedef std::map<ProcAst*, std::set<ProcAst*> > ProcIndex;
     SimpleRoot _ast;
-    ProcIndex _calls_table;
-    ProcIndex _called_table;
+    PkbPtr _pkb;
 };
 
 template <>
@@ -70,25 +65,8 @@ template <>
 ConditionSet ICallSolver::solve_left<ProcAst>(ProcAst *proc);
 
 template <>
-bool ICallSolver::validate<ProcAst, ProcAst>(ProcAst *proc1, ProcAst *proc2);
-
-template <>
-void ICallSolver::index_calls<StatementAst>(StatementAst *statement);
-
-template <>
-void ICallSolver::index_calls<ProcAst>(ProcAst *proc);
-
-template <>
-void ICallSolver::index_calls<CallAst>(CallAst *call);
-
-template <>
-void ICallSolver::index_calls<WhileAst>(WhileAst *loop);
-
-template <>
-void ICallSolver::index_calls<ConditionalAst>(ConditionalAst *condition);
-
-
-
+bool ICallSolver::validate<ProcAst, ProcAst>(
+        ProcAst *left, ProcAst *right);
 
 
 } // namespace impl
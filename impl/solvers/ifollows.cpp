@@ -25,45 +25,21 @@ using namespace simple;
 
 template <>
 ConditionSet IFollowSolver::solve_right<StatementAst>(StatementAst *statement) {
-    ConditionSet result;
-
-    if(statement->next()) {
-        while(statement->next() != NULL) {
-            result.insert(new SimpleStatementCondition(statement->next()));
-            statement = statement->next();
-        }
-    }
-    return result;
+    return _pkb->get_ifollows().solve_right(_pkb->get_statement_id(statement));
 }
-    
+
 template <>
 ConditionSet IFollowSolver::solve_left<StatementAst>(StatementAst *statement) {
-    ConditionSet result;
-
-    if(statement->prev()) {
-        while(statement->prev() != NULL) {
-            result.insert(new SimpleStatementCondition(statement->prev()));
-            statement = statement->prev();
-        }
-    }
-    return result;
+    return _pkb->get_ifollows().solve_left(_pkb->get_statement_id(statement));
 }
 
 template <>
 bool IFollowSolver::validate<StatementAst, StatementAst>(
         StatementAst *left, StatementAst *right)
 {
-    while(left->next() != NULL) {
-        if(left->next() == right) {
-            return true;
-        }
-        left = left->next();
-    }
-    return false;
+    return _pkb->get_ifollows().validate(
+            _pkb->get_statement_id(left), _pkb->get_statement_id(right));
 }
 
-
-
-
-}
-}
+} // namespace impl
+} // namespace simple
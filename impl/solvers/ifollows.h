@@ -22,6 +22,7 @@
 #include "simple/condition.h"
 #include "simple/solver.h"
 #include "impl/condition.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -30,7 +31,9 @@ using namespace simple;
 
 class IFollowSolver {
   public:
-    IFollowSolver(SimpleRoot ast) : _ast(ast) { }
+    IFollowSolver(SimpleRoot ast, PkbPtr pkb = PkbPtr()) : 
+        _ast(ast), _pkb(make_pkb(ast, pkb)) 
+    { }
 
     /*
      * SOLVE RIGHT PART
@@ -52,6 +55,7 @@ class IFollowSolver {
 
   private:
     SimpleRoot _ast;
+    PkbPtr _pkb;
 };
 
 template <>
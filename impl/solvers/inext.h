@@ -18,23 +18,27 @@
 
 #pragma once
 
-#include <map>
+#include "simple/ast.h"
+#include "simple/condition.h"
+#include "simple/condition_set.h"
 #include "simple/solver.h"
+#include "simple/util/set_utils.h"
+#include "impl/condition.h"
+#include "impl/pkb.h"
 #include "impl/solvers/next.h"
-#include "simple/condition_set.h"
-#include "simple/ast.h"
 
 namespace simple {
 namespace impl {
 
 using namespace simple;
 
+/*
+ * Next* shares the control flow graph of the PKB used by Next.
+ */
 class INextSolver {
   public:
-    typedef std::map<StatementAst*, StatementSet>  INextTable;
-
-    INextSolver(SimpleRoot ast, std::shared_ptr<NextQuerySolver> solver) :
-        _ast(ast), _next_solver(solver)
+    INextSolver(SimpleRoot ast, std::shared_ptr<NextSolver> solver) :
+        _ast(ast), _pkb(solver->get_pkb())
     { }
 
     template <typename Condition>
@@ -57,22 +61,18 @@ class INextSolver {
 
   private:
     SimpleRoot _ast;
-    std::shared_ptr<NextQuerySolver> _next_solver;
-    INextTable _inext_cache;
-    INextTable _iprev_cache;
-    INextTable _inext_partial_cache;
-    INextTable _iprev_partial_cache;
+    PkbPtr _pkb;
 };
 
-template <>
-bool INextSolver::validate<StatementAst, StatementAst>(
-        StatementAst *statement1, StatementAst *statement2);
-
 template <>
 ConditionSet INextSolver::solve_right<StatementAst>(StatementAst *statement);
 
 template <>
 ConditionSet INextSolver::solve_left<StatementAst>(StatementAst *statement);
 
-}
-}
+template <>
+bool INextSolver::validate<StatementAst, StatementAst>(
+        StatementAst *left, StatementAst *right);
+
+} // namespace impl
+} // namespace simple
@@ -22,16 +22,18 @@
 #include "simple/condition.h"
 #include "simple/solver.h"
 #include "impl/condition.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
 
 using namespace simple;
-using namespace simple::impl;
 
 class IParentSolver {
   public:
-    IParentSolver(SimpleRoot ast) : _ast(ast) { }
+    IParentSolver(SimpleRoot ast, PkbPtr pkb = PkbPtr()) : 
+        _ast(ast), _pkb(make_pkb(ast, pkb)) 
+    { }
 
     /*
      * SOLVE RIGHT PART
@@ -53,18 +55,12 @@ class IParentSolver {
 
   private:
     SimpleRoot _ast;
+    PkbPtr _pkb;
 };
 
-
 template <>
 ConditionSet IParentSolver::solve_right<StatementAst>(StatementAst *statement);
 
-template <>
-ConditionSet IParentSolver::solve_right<WhileAst>(WhileAst *loop);
-
-template <>
-ConditionSet IParentSolver::solve_right<ConditionalAst>(ConditionalAst *condition);
-    
 template <>
 ConditionSet IParentSolver::solve_left<StatementAst>(StatementAst *statement);
 
@@ -72,18 +68,6 @@ template <>
 bool IParentSolver::validate<StatementAst, StatementAst>(
         StatementAst *left, StatementAst *right);
 
-template <>
-bool IParentSolver::validate<ContainerAst, StatementAst>(
-        ContainerAst *container, StatementAst *statement);
-
-template <>
-bool IParentSolver::validate<ConditionalAst, StatementAst>(
-        ConditionalAst *condition, StatementAst *statement);
-
-template <>
-bool IParentSolver::validate<WhileAst, StatementAst>(
-        WhileAst *loop, StatementAst *statement);
-
 
 } // namespace impl
 } // namespace simple
@@ -24,7 +24,7 @@
 #include "simple/condition.h"
 #include "simple/condition_set.h"
 #include "simple/solver.h"
-#include "simple/util/statement_visitor_generator.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -41,7 +41,7 @@ class ModifiesQuerySolver {
 
 class ModifiesSolver {
   public:
-    ModifiesSolver(const SimpleRoot& ast);
+    ModifiesSolver(const SimpleRoot& ast, PkbPtr pkb = PkbPtr());
 
     template <typename Condition1, typename Condition2>
     bool validate(Condition1 *condition1, Condition2 *condition2);
@@ -52,18 +52,10 @@ class ModifiesSolver {
     template <typename Condition>
     ConditionSet solve_left(Condition *condition);
 
-    template <typename Condition>
-    ConditionSet solve_variable(Condition *condition, SimpleVariable *variable);
-
-    template <typename Condition>
-    std::set<SimpleVariable> index_variables(Condition *condition);
-
     ~ModifiesSolver() { }
   private:
     SimpleRoot _ast;
-    std::map<SimpleVariable, ConditionSet> _var_index;
-
-    void index_statement_list(StatementAst *statement, ConditionPtr condition, std::set<SimpleVariable>& result);
+    PkbPtr _pkb;
 };
 
 /*
@@ -80,21 +72,11 @@ ConditionSet ModifiesSolver::solve_right(Condition *condition) {
     return ConditionSet(); // empty set
 }
 
-template <typename Condition>
-ConditionSet ModifiesSolver::solve_variable(Condition *condition, SimpleVariable *variable) {
-    return ConditionSet(); // empty set
-}
-
 template <typename Condition>
 ConditionSet ModifiesSolver::solve_left(Condition *condition) {
     return ConditionSet(); // empty set
 }
 
-template <typename Condition>
-std::set<SimpleVariable> ModifiesSolver::index_variables(Condition *condition) {
-    return ConditionSet();
-}
-
 
 template <>
 bool ModifiesSolver::validate<StatementAst, SimpleVariable>(
@@ -110,7 +92,7 @@ bool ModifiesSolver::validate<AssignmentAst, SimpleVariable>(
 
 template <>
 bool ModifiesSolver::validate<ConditionalAst, SimpleVariable>(
-        ConditionalAst *ast, SimpleVariable *var); 
+        ConditionalAst *ast, SimpleVariable *var);
 
 template <>
 bool ModifiesSolver::validate<WhileAst, SimpleVariable>(
@@ -123,12 +105,6 @@ bool ModifiesSolver::validate<CallAst, SimpleVariable>(
 template <>
 ConditionSet ModifiesSolver::solve_right<StatementAst>(StatementAst *ast);
 
-template <>
-ConditionSet ModifiesSolver::solve_right<ConditionalAst>(ConditionalAst *ast);
-
-template <>
-ConditionSet ModifiesSolver::solve_right<WhileAst>(WhileAst *ast);
-
 template <>
 ConditionSet ModifiesSolver::solve_right<ProcAst>(ProcAst *ast);
 
@@ -136,43 +112,17 @@ template <>
 ConditionSet ModifiesSolver::solve_right<AssignmentAst>(AssignmentAst *ast);
 
 template <>
-ConditionSet ModifiesSolver::solve_right<CallAst>(CallAst *ast);
-
-template <>
-ConditionSet ModifiesSolver::solve_variable<AssignmentAst>(
-        AssignmentAst *ast, SimpleVariable *variable);
-
-template <>
-ConditionSet ModifiesSolver::solve_variable<CallAst>(CallAst *ast, SimpleVariable *variable);
+ConditionSet ModifiesSolver::solve_right<ConditionalAst>(ConditionalAst *ast);
 
 template <>
-ConditionSet ModifiesSolver::solve_variable<ProcAst>(ProcAst *ast, SimpleVariable *variable);
+ConditionSet ModifiesSolver::solve_right<WhileAst>(WhileAst *ast);
 
 template <>
-ConditionSet ModifiesSolver::solve_variable<StatementAst>(
-        StatementAst *ast, SimpleVariable *variable);
+ConditionSet ModifiesSolver::solve_right<CallAst>(CallAst *ast);
 
 template <>
 ConditionSet ModifiesSolver::solve_left<SimpleVariable>(SimpleVariable *variable);
 
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<ProcAst>(ProcAst *proc);
-
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<AssignmentAst>(AssignmentAst *assign);
-
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<WhileAst>(WhileAst *ast);
-
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<ConditionalAst>(ConditionalAst *ast);
-
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<CallAst>(CallAst *ast);
-
-template <>
-std::set<SimpleVariable> ModifiesSolver::index_variables<StatementAst>(StatementAst *statement);
-
 
 } // namespace impl
 } // namespace simple
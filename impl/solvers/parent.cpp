@@ -17,7 +17,6 @@
  */
 
 #include "impl/solvers/parent.h"
-#include "simple/util/statement_visitor_generator.h"
 
 namespace simple {
 namespace impl {
@@ -26,79 +25,21 @@ using namespace simple;
 
 template <>
 ConditionSet ParentSolver::solve_right<StatementAst>(StatementAst *statement) {
-    StatementVisitorGenerator<ParentSolver, 
-        SolveRightVisitorTraits<ParentSolver> > visitor(this);
-    statement->accept_statement_visitor(&visitor);
-    return visitor.return_result();
-}
-
-template <>
-ConditionSet ParentSolver::solve_right<WhileAst>(WhileAst *loop) {
-    ConditionSet result;
-    StatementAst *body = loop->get_body();
-
-    while(body != NULL) {
-        result.insert(new SimpleStatementCondition(body));
-        body = body->next();
-    }
-
-    return result;
-}
-
-template <>
-ConditionSet ParentSolver::solve_right<ConditionalAst>(ConditionalAst *condition) {
-    ConditionSet result;
-    StatementAst *then_branch = condition->get_then_branch();
-    StatementAst *else_branch = condition->get_else_branch();
-
-    while(then_branch != NULL) {
-        result.insert(new SimpleStatementCondition(then_branch));
-        then_branch = then_branch->next();
-    }
-
-    while(else_branch != NULL) {
-        result.insert(new SimpleStatementCondition(else_branch));
-        else_branch = else_branch->next();
-    }
-
-    return result;
+    return _pkb->get_parent().solve_right(_pkb->get_statement_id(statement));
 }
     
 template <>
 ConditionSet ParentSolver::solve_left<StatementAst>(StatementAst *ast) {
-    ConditionSet result;
-
-    if(ast->get_parent()) {
-        result.insert(new SimpleStatementCondition(ast->get_parent()));
-    }
-    return result;
+    return _pkb->get_parent().solve_left(_pkb->get_statement_id(ast));
 }
 
 template <>
 bool ParentSolver::validate<StatementAst, StatementAst>(
         StatementAst *left, StatementAst *right)
 {
-    StatementVisitorGenerator<ParentSolver, 
-        PartialValidateVisitorTraits<ParentSolver> > visitor(this, right);
-    left->accept_statement_visitor(&visitor);
-    return visitor.return_result();
-}
-
-template <>
-bool ParentSolver::validate<ConditionalAst, StatementAst>(
-        ConditionalAst *condition, StatementAst *statement)
-{
-    return statement->get_parent() == static_cast<ContainerAst*>(condition);
+    return _pkb->get_parent().validate(
+            _pkb->get_statement_id(left), _pkb->get_statement_id(right));
 }
 
-template <>
-bool ParentSolver::validate<WhileAst, StatementAst>(
-        WhileAst *loop, StatementAst *statement)
-{
-    return statement->get_parent() == static_cast<ContainerAst*>(loop);
-}
-
-
-
 }
 }
@@ -22,6 +22,7 @@
 #include "simple/condition.h"
 #include "simple/solver.h"
 #include "impl/condition.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -30,7 +31,9 @@ using namespace simple;
 
 class ParentSolver {
   public:
-    ParentSolver(SimpleRoot ast) : _ast(ast) { }
+    ParentSolver(SimpleRoot ast, PkbPtr pkb = PkbPtr()) : 
+        _ast(ast), _pkb(make_pkb(ast, pkb)) 
+    { }
 
     /*
      * SOLVE RIGHT PART
@@ -52,18 +55,13 @@ class ParentSolver {
 
   private:
     SimpleRoot _ast;
+    PkbPtr _pkb;
 };
 
 
 template <>
 ConditionSet ParentSolver::solve_right<StatementAst>(StatementAst *statement);
 
-template <>
-ConditionSet ParentSolver::solve_right<WhileAst>(WhileAst *loop);
-
-template <>
-ConditionSet ParentSolver::solve_right<ConditionalAst>(ConditionalAst *condition);
-
 template <>
 ConditionSet ParentSolver::solve_left<StatementAst>(StatementAst *ast);
 
@@ -71,15 +69,6 @@ template <>
 bool ParentSolver::validate<StatementAst, StatementAst>(
         StatementAst *left, StatementAst *right);
 
-template <>
-bool ParentSolver::validate<ConditionalAst, StatementAst>(
-        ConditionalAst *condition, StatementAst *statement);
-
-template <>
-bool ParentSolver::validate<WhileAst, StatementAst>(
-        WhileAst *loop, StatementAst *statement);
-
-
 
 } // namespace impl
 } // namespace simple
@@ -0,0 +1,105 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "impl/solvers/pattern.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+PatternSolver::PatternSolver(const SimpleRoot& ast, PkbPtr pkb,
+        ExprAst *expr, PatternType type) :
+    _ast(ast), _pkb(make_pkb(ast, pkb))
+{
+    const FlatAst& flat = _pkb->get_flat_ast();
+
+    if(type == PATTERN_ANY) {
+        for(int statement = 0; statement < flat.get_statement_count(); ++statement) {
+            if(flat.get_type(statement) == FLAT_ASSIGNMENT) {
+                add_match(statement);
+            }
+        }
+        return;
+    }
+
+    const ExprIndex& index = _pkb->get_expr_index();
+    ExprPattern pattern;
+    if(!index.make_pattern(expr, pattern)) {
+        return;
+    }
+
+    std::vector<int> statements = (type == PATTERN_EXACT) ?
+        index.find_exact(pattern) : index.find_subexpr(pattern);
+
+    for(size_t i = 0; i < statements.size(); ++i) {
+        add_match(statements[i]);
+    }
+}
+
+void PatternSolver::add_match(int statement) {
+    AssignmentAst *assign = static_cast<AssignmentAst*>(
+            _pkb->get_flat_ast().get_statement_ast(statement));
+    SimpleVariable *var = assign->get_variable();
+
+    _matches[assign] = var;
+
+    if(var->get_symbol() >= static_cast<int>(_assignments.size())) {
+        _assignments.resize(var->get_symbol() + 1);
+    }
+    _assignments[var->get_symbol()].insert(
+            _pkb->get_condition_table()->get_statement_condition(assign));
+}
+
+size_t PatternSolver::get_size() {
+    return _matches.size();
+}
+
+template <>
+bool PatternSolver::validate<StatementAst, SimpleVariable>(
+        StatementAst *ast, SimpleVariable *var) 
+{
+    std::unordered_map<StatementAst*, SimpleVariable*>::const_iterator it =
+        _matches.find(ast);
+
+    return it != _matches.end() && it->second->equals(*var);
+}
+
+template <>
+ConditionSet PatternSolver::solve_right<StatementAst>(StatementAst *ast) {
+    ConditionSet result;
+    std::unordered_map<StatementAst*, SimpleVariable*>::const_iterator it =
+        _matches.find(ast);
+
+    if(it != _matches.end()) {
+        result.insert(_pkb->get_condition_table()->get_variable_condition(it->second));
+    }
+    return result;
+}
+
+template <>
+ConditionSet PatternSolver::solve_left<SimpleVariable>(SimpleVariable *variable) {
+    if(variable->get_symbol() < static_cast<int>(_assignments.size())) {
+        return _assignments[variable->get_symbol()];
+    } else {
+        return ConditionSet();
+    }
+}
+
+} // namespace impl
+} // namespace simple
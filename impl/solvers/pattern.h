@@ -0,0 +1,113 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "simple/ast.h"
+#include "simple/condition.h"
+#include "simple/condition_set.h"
+#include "simple/solver.h"
+#include "impl/pkb.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+enum PatternType {
+    PATTERN_ANY,        // a(v, _)
+    PATTERN_EXACT,      // a(v, "expr")
+    PATTERN_SUBEXPR     // a(v, _"expr"_)
+};
+
+/*
+ * PatternSolver answers a single pattern clause a(v, ...). It relates
+ * the assignments whose expression fits the pattern to the variable
+ * they modify. The matching assignments are looked up in the
+ * expression index of the PKB once, when the solver is created.
+ */
+class PatternSolver {
+  public:
+    /*
+     * The expression is only read during construction, and is ignored
+     * for PATTERN_ANY.
+     */
+    PatternSolver(const SimpleRoot& ast, PkbPtr pkb, 
+            ExprAst *expr, PatternType type);
+
+    template <typename Condition1, typename Condition2>
+    bool validate(Condition1 *condition1, Condition2 *condition2);
+
+    template <typename Condition>
+    ConditionSet solve_right(Condition *condition);
+
+    template <typename Condition>
+    ConditionSet solve_left(Condition *condition);
+
+    /*
+     * The number of matching assignments.
+     */
+    size_t get_size();
+
+    ~PatternSolver() { }
+  private:
+    void add_match(int statement);
+
+    SimpleRoot _ast;
+    PkbPtr _pkb;
+
+    // the variable modified by each matching assignment
+    std::unordered_map<StatementAst*, SimpleVariable*> _matches;
+
+    // indexed by the symbol of the modified variable
+    std::vector<ConditionSet> _assignments;
+};
+
+/*
+ * Template declarations
+ */
+
+template <typename Condition1, typename Condition2>
+bool PatternSolver::validate(Condition1 *condition1, Condition2 *condition2) {
+    return false;
+}
+
+template <typename Condition>
+ConditionSet PatternSolver::solve_right(Condition *condition) {
+    return ConditionSet(); // empty set
+}
+
+template <typename Condition>
+ConditionSet PatternSolver::solve_left(Condition *condition) {
+    return ConditionSet(); // empty set
+}
+
+template <>
+bool PatternSolver::validate<StatementAst, SimpleVariable>(
+        StatementAst *ast, SimpleVariable *var);
+
+template <>
+ConditionSet PatternSolver::solve_right<StatementAst>(StatementAst *ast);
+
+template <>
+ConditionSet PatternSolver::solve_left<SimpleVariable>(SimpleVariable *variable);
+
+} // namespace impl
+} // namespace simple
@@ -71,13 +71,13 @@ class SameNameExprVisitor : public ExprVisitor{
     SameNameSolver *_solver;
 };
 
-class GetNameVisitorTraits {
+class GetSymbolVisitorTraits {
   public:
-    typedef std::string ResultType;
+    typedef int ResultType;
 
     template <typename Condition>
-    static std::string visit(SameNameSolver *solver, Condition *condition) {
-        return solver->get_name<Condition>(condition);
+    static int visit(SameNameSolver *solver, Condition *condition) {
+        return solver->get_symbol<Condition>(condition);
     }
 };
 
@@ -104,12 +104,24 @@ class SolveNameVisitorTraits {
 
 template <>
 ConditionSet SameNameSolver::solve_name<ProcAst>(ProcAst *proc) {
-    return _name_table[proc->get_name()];
+    return find_symbol(proc->get_symbol());
 }
 
 template <>
 ConditionSet SameNameSolver::solve_name<SimpleVariable>(SimpleVariable *var) {
-    return _name_table[var->get_name()];
+    return find_symbol(var->get_symbol());
+}
+
+/*
+ * Looking up a name must not insert it, since queries share the solver
+ * across threads.
+ */
+ConditionSet SameNameSolver::find_symbol(int symbol) const {
+    if(symbol < static_cast<int>(_name_table.size())) {
+        return _name_table[symbol];
+    } else {
+        return ConditionSet();
+    }
 }
 
 template <>
@@ -124,13 +136,19 @@ ConditionSet SameNameSolver::solve_name<SimpleCondition>(SimpleCondition *condit
 
 template <>
 void SameNameSolver::index_name<ProcAst>(ProcAst *proc) {
-    _name_table[proc->get_name()].insert(new SimpleProcCondition(proc));
+    if(proc->get_symbol() >= static_cast<int>(_name_table.size())) {
+        _name_table.resize(proc->get_symbol() + 1);
+    }
+    _name_table[proc->get_symbol()].insert(_table->get_proc_condition(proc));
     index_statement_list(proc->get_statement());
 }
 
 template <>
 void SameNameSolver::index_name<SimpleVariable>(SimpleVariable *var) {
-    _name_table[var->get_name()].insert(new SimpleVariableCondition(*var));
+    if(var->get_symbol() >= static_cast<int>(_name_table.size())) {
+        _name_table.resize(var->get_symbol() + 1);
+    }
+    _name_table[var->get_symbol()].insert(_table->get_variable_condition(var));
 }
 
 template <>
@@ -177,18 +195,18 @@ void SameNameSolver::index_statement_list(StatementAst *statement) {
 }
 
 template <>
-std::string SameNameSolver::get_name<ProcAst>(ProcAst *proc) {
-    return proc->get_name();
+int SameNameSolver::get_symbol<ProcAst>(ProcAst *proc) {
+    return proc->get_symbol();
 }
 
 template <>
-std::string SameNameSolver::get_name<SimpleVariable>(SimpleVariable *var) {
-    return var->get_name();
+int SameNameSolver::get_symbol<SimpleVariable>(SimpleVariable *var) {
+    return var->get_symbol();
 }
 
 template <>
-std::string SameNameSolver::get_name<SimpleCondition>(SimpleCondition *condition) {
-    ConditionVisitorGenerator<SameNameSolver, GetNameVisitorTraits>
+int SameNameSolver::get_symbol<SimpleCondition>(SimpleCondition *condition) {
+    ConditionVisitorGenerator<SameNameSolver, GetSymbolVisitorTraits>
     visitor(this);
 
     condition->accept_condition_visitor(&visitor);
@@ -18,9 +18,10 @@
 
 #pragma once
 
-#include <string>
+#include <vector>
 #include "simple/ast.h"
 #include "impl/condition.h"
+#include "impl/condition_table.h"
 
 namespace simple {
 namespace impl {
@@ -29,7 +30,9 @@ using namespace simple;
 
 class SameNameSolver {
   public:
-    SameNameSolver(SimpleRoot ast) : _ast(ast) { }
+    SameNameSolver(SimpleRoot ast, ConditionTablePtr table = ConditionTablePtr()) : 
+        _ast(ast), _table(make_condition_table(ast, table)) 
+    { }
 
     template <typename Condition>
     ConditionSet solve_right(Condition *condition) {
@@ -44,7 +47,7 @@ class SameNameSolver {
     template <typename Condition1, typename Condition2>
     bool validate(Condition1 *condition1, Condition2 *condition2) {
         if(has_name<Condition1>(condition1) && has_name<Condition2>(condition2)) {
-            return get_name<Condition1>(condition1) == get_name<Condition2>(condition2);
+            return get_symbol<Condition1>(condition1) == get_symbol<Condition2>(condition2);
         } else {
             return false;
         }
@@ -62,9 +65,11 @@ class SameNameSolver {
 
     void index_statement_list(StatementAst *statement);
 
+    ConditionSet find_symbol(int symbol) const;
+
     template <typename Condition>
-    std::string get_name(Condition *condition) {
-        return "";
+    int get_symbol(Condition *condition) {
+        return -1;
     }
 
     template <typename Condition>
@@ -73,8 +78,10 @@ class SameNameSolver {
     }
 
   private:
-    std::map<std::string, ConditionSet> _name_table;
+    // indexed by the symbol of the name
+    std::vector<ConditionSet> _name_table;
     SimpleRoot _ast;
+    ConditionTablePtr _table;
 };
 
 
@@ -113,13 +120,13 @@ template <>
 void SameNameSolver::index_name<ExprAst>(ExprAst *expr);
 
 template <>
-std::string SameNameSolver::get_name<ProcAst>(ProcAst *proc);
+int SameNameSolver::get_symbol<ProcAst>(ProcAst *proc);
 
 template <>
-std::string SameNameSolver::get_name<SimpleVariable>(SimpleVariable *var);
+int SameNameSolver::get_symbol<SimpleVariable>(SimpleVariable *var);
 
 template <>
-std::string SameNameSolver::get_name<SimpleCondition>(SimpleCondition *condition);
+int SameNameSolver::get_symbol<SimpleCondition>(SimpleCondition *condition);
 
 template <>
 bool SameNameSolver::has_name<ProcAst>(ProcAst *proc);
@@ -1,8 +1,6 @@
 /*
  * CS3201 Simple Static Analyzer
  * Copyright (C) 2011 Soares Chen Ruo Fei
- *  Contributor(s):
- *    Daniel Le <GreenRecycleBin@gmail.com>
  *
  *  This program is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License as published by
@@ -18,85 +16,16 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-
-#include "simple/util/statement_visitor_generator.h"
 #include "impl/solvers/uses.h"
-#include "impl/condition.h"
 
 namespace simple {
 namespace impl {
 
 using namespace simple;
 
-/*
- * Helper classes
- */
-class UsesValidateStatementVisitor : public StatementVisitor {
-  public:
-    UsesValidateStatementVisitor(
-        UsesSolver *solver, SimpleVariable *var) : 
-        _solver(solver), _var(var) { }
-
-    void visit_conditional(ConditionalAst *ast) {
-        _result = _solver->validate<ConditionalAst, SimpleVariable>(ast, _var);
-    }
-
-    void visit_while(WhileAst *ast) {
-        _result = _solver->validate<WhileAst, SimpleVariable>(ast, _var);
-    }
-
-    void visit_assignment(AssignmentAst *ast) {
-        _result = _solver->validate<AssignmentAst, SimpleVariable>(ast, _var);
-    }
-
-    void visit_call(CallAst *ast) {
-        _result = _solver->validate<CallAst, SimpleVariable>(ast, _var);
-    }
-
-    bool return_result() {
-        return _result;
-    }
-
-  private:
-    UsesSolver *_solver;
-    SimpleVariable *_var;
-    bool _result;
-};
-
-class UsesValidateExprVisitor : public ExprVisitor {
-  public:
-    UsesValidateExprVisitor(UsesSolver *solver, SimpleVariable *var) :
-    _solver(solver), _var(var) { }
-
-    void visit_const(ConstAst* ast) {
-      _result = _solver->validate<ConstAst, SimpleVariable>(ast, _var);
-    }
-
-    void visit_variable(VariableAst* ast) {
-      _result = _solver->validate<VariableAst, SimpleVariable>(ast, _var);
-    }
-
-    void visit_binary_op(BinaryOpAst* ast) {
-      _result = _solver->validate<BinaryOpAst, SimpleVariable>(ast, _var);
-    }
-
-    bool return_result() {
-      return _result;
-    }
-
-  private:
-    UsesSolver *_solver;
-    SimpleVariable *_var;
-    bool _result;
-};
-
-UsesSolver::UsesSolver(const SimpleRoot& ast) : 
-    _ast(ast) 
-{
-   for(SimpleRoot::iterator it = _ast.begin(); it != _ast.end(); ++it) {
-       index_variables<ProcAst>(*it);
-   } 
-}
+UsesSolver::UsesSolver(const SimpleRoot& ast, PkbPtr pkb) : 
+    _ast(ast), _pkb(make_pkb(ast, pkb))
+{ }
 
 /*
  * validate() definitions
@@ -105,123 +34,44 @@ template <>
 bool UsesSolver::validate<StatementAst, SimpleVariable>(
         StatementAst *ast, SimpleVariable *var) 
 {
-    UsesValidateStatementVisitor visitor(this, var);
-    ast->accept_statement_visitor(&visitor);
-    return visitor.return_result();
+    return _pkb->get_uses().validate(
+            _pkb->get_statement_id(ast), _pkb->get_variable_id(var));
 }
 
 template <>
 bool UsesSolver::validate<ProcAst, SimpleVariable>(
         ProcAst *ast, SimpleVariable *var)
 {
-    StatementAst *body = ast->get_statement();
-    while(body != NULL) {
-        if(validate<StatementAst, SimpleVariable>(body, var)) {
-            return true;
-        }
-        body = body->next();
-    }
-
-    return false;
+    return _pkb->get_uses().validate(
+            _pkb->get_proc_id(ast), _pkb->get_variable_id(var));
 }
 
 template <>
 bool UsesSolver::validate<AssignmentAst, SimpleVariable>(
         AssignmentAst *ast, SimpleVariable *var) 
 {
-    return validate<ExprAst, SimpleVariable>(ast->get_expr(), var);
-}
-
-template <>
-bool UsesSolver::validate<ExprAst, SimpleVariable>(
-        ExprAst *ast, SimpleVariable *var)
-{
-    UsesValidateExprVisitor visitor(this, var);
-    ast->accept_expr_visitor(&visitor);
-  
-    return visitor.return_result();
-}
-
-template <>
-bool UsesSolver::validate<VariableAst, SimpleVariable>(
-        VariableAst *ast, SimpleVariable *var) 
-{
-    return *ast->get_variable() == *var;
-}
-
-template <>
-bool UsesSolver::validate<ConstAst, SimpleVariable>(
-        ConstAst *ast, SimpleVariable *var)
-{
-    return false;
-}
-
-template <>
-bool UsesSolver::validate<BinaryOpAst, SimpleVariable>(
-        BinaryOpAst *ast, SimpleVariable *var) 
-{
-    if (validate<ExprAst, SimpleVariable>(ast->get_lhs(), var)) {
-      return true;
-    }
-
-    if (validate<ExprAst, SimpleVariable>(ast->get_rhs(), var)) {
-      return true;
-    }
-
-    return false;
+    return validate<StatementAst, SimpleVariable>(ast, var);
 }
 
 template <>
 bool UsesSolver::validate<ConditionalAst, SimpleVariable>(
         ConditionalAst *ast, SimpleVariable *var) 
 {
-    if (ast->get_variable()->equals(*var)) {
-      return true;
-    }
-
-    StatementAst *then_branch = ast->get_then_branch();
-    while(then_branch != NULL) {
-        if(validate<StatementAst, SimpleVariable>(then_branch, var)) {
-            return true;
-        }
-        then_branch = then_branch->next();
-    }
-
-    StatementAst *else_branch = ast->get_else_branch();
-    while(else_branch != NULL) {
-        if(validate<StatementAst, SimpleVariable>(else_branch, var)) {
-            return true;
-        }
-        else_branch = else_branch->next();
-    }
-
-    return false;
+    return validate<StatementAst, SimpleVariable>(ast, var);
 }
 
 template <>
 bool UsesSolver::validate<WhileAst, SimpleVariable>(
-        WhileAst *ast, SimpleVariable *var)
+        WhileAst *ast, SimpleVariable *var) 
 {
-    if (ast->get_variable()->equals(*var)) {
-      return true;
-    }
-
-    StatementAst *body = ast->get_body();
-    while(body != NULL) {
-        if(validate<StatementAst, SimpleVariable>(body, var)) {
-            return true;
-        }
-        body = body->next();
-    }
-
-    return false;
+    return validate<StatementAst, SimpleVariable>(ast, var);
 }
 
 template <>
 bool UsesSolver::validate<CallAst, SimpleVariable>(
-        CallAst *ast, SimpleVariable *var)
+        CallAst *ast, SimpleVariable *var) 
 {
-    return validate<ProcAst, SimpleVariable>(ast->get_proc_called(), var);
+    return validate<StatementAst, SimpleVariable>(ast, var);
 }
 
 
@@ -230,105 +80,41 @@ bool UsesSolver::validate<CallAst, SimpleVariable>(
  */
 template <>
 ConditionSet UsesSolver::solve_right<StatementAst>(StatementAst *ast) {
-    StatementVisitorGenerator<UsesSolver, 
-        SolveRightVisitorTraits<UsesSolver> > visitor(this);
-
-    ast->accept_statement_visitor(&visitor);
-
-    return visitor.return_result();
-}
-
-template <>
-ConditionSet UsesSolver::solve_right<ConditionalAst>(ConditionalAst *ast) {
-    ConditionSet result;
-    result.insert(new SimpleVariableCondition(*ast->get_variable()));
-    
-    StatementAst *then = ast->get_then_branch();
-    while(then != NULL) {
-        result.union_with(solve_right<StatementAst>(then));
-        then = then->next();
-    }
-
-    StatementAst *el = ast->get_else_branch();
-    while(el != NULL) {
-        result.union_with(solve_right<StatementAst>(el));
-        el = el->next();
-    }
-
-    return result;
-}
-
-template <>
-ConditionSet UsesSolver::solve_right<WhileAst>(WhileAst *ast) {
-    ConditionSet result;
-    result.insert(new SimpleVariableCondition(*ast->get_variable()));
-
-    StatementAst *body = ast->get_body();
-    while(body != NULL) {
-        result.union_with(solve_right<StatementAst>(body));
-        body = body->next();
-    }
-
-    return result;
+    return _pkb->get_uses().solve_right(_pkb->get_statement_id(ast));
 }
 
 template <>
 ConditionSet UsesSolver::solve_right<ProcAst>(ProcAst *ast) {
-    ConditionSet result;
-    
-    StatementAst *body = ast->get_statement();
-    while(body != NULL) {
-        result.union_with(solve_right<StatementAst>(body));
-        body = body->next();
-    }
-
-    return result;
+    return _pkb->get_uses().solve_right(_pkb->get_proc_id(ast));
 }
 
 template <>
 ConditionSet UsesSolver::solve_right<AssignmentAst>(AssignmentAst *ast) {
-    return solve_right<ExprAst>(ast->get_expr());
+    return solve_right<StatementAst>(ast);
 }
 
 template <>
-ConditionSet UsesSolver::solve_right<ExprAst>(ExprAst *ast) {
-    ExprVisitorGenerator<UsesSolver, 
-        SolveRightVisitorTraits<UsesSolver> > visitor(this);
-
-    ast->accept_expr_visitor(&visitor);
-
-    return visitor.return_result();  
+ConditionSet UsesSolver::solve_right<ConditionalAst>(ConditionalAst *ast) {
+    return solve_right<StatementAst>(ast);
 }
 
 template <>
-ConditionSet UsesSolver::solve_right<VariableAst>(VariableAst *ast) {
-    ConditionSet result;
-    result.insert(new SimpleVariableCondition(
-            *(ast->get_variable())));
-
-    return result;
+ConditionSet UsesSolver::solve_right<WhileAst>(WhileAst *ast) {
+    return solve_right<StatementAst>(ast);
 }
 
 template <>
-ConditionSet UsesSolver::solve_right<ConstAst>(ConstAst *ast) {
-    ConditionSet result;
-
-    return result;
+ConditionSet UsesSolver::solve_right<CallAst>(CallAst *ast) {
+    return solve_right<StatementAst>(ast);
 }
 
-template <>
-ConditionSet UsesSolver::solve_right<BinaryOpAst>(BinaryOpAst *ast) {
-    ConditionSet result;
-
-    result.union_with(solve_right<ExprAst>(ast->get_lhs()));
-    result.union_with(solve_right<ExprAst>(ast->get_rhs()));
-
-    return result;
-}
 
+/*
+ * solve_left() definitions
+ */
 template <>
-ConditionSet UsesSolver::solve_right<CallAst>(CallAst *ast) {
-    return solve_right<ProcAst>(ast->get_proc_called());
+ConditionSet UsesSolver::solve_left<SimpleVariable>(SimpleVariable *variable) {
+    return _pkb->get_uses().solve_left(_pkb->get_variable_id(variable));
 }
 
 } // namespace impl
@@ -27,7 +27,7 @@
 #include "simple/condition_set.h"
 #include "simple/solver.h"
 #include "simple/util/set_utils.h"
-#include "simple/util/statement_visitor_generator.h"
+#include "impl/pkb.h"
 
 namespace simple {
 namespace impl {
@@ -44,7 +44,7 @@ class UsesQuerySolver {
 
 class UsesSolver {
   public:
-    UsesSolver(const SimpleRoot& ast);
+    UsesSolver(const SimpleRoot& ast, PkbPtr pkb = PkbPtr());
 
     template <typename Condition1, typename Condition2>
     bool validate(Condition1 *condition1, Condition2 *condition2);
@@ -55,18 +55,10 @@ class UsesSolver {
     template <typename Condition>
     ConditionSet solve_left(Condition *condition);
 
-    template <typename Condition>
-    ConditionSet solve_variable(Condition *condition, SimpleVariable *variable);
-
-    template <typename Condition>
-    std::set<SimpleVariable> index_variables(Condition *condition);
-
     ~UsesSolver() { }
   private:
     SimpleRoot _ast;
-    std::map<SimpleVariable, ConditionSet> _var_index;
-
-    void index_statement_list(StatementAst *statement, ConditionPtr condition, std::set<SimpleVariable>& result);
+    PkbPtr _pkb;
 };
 
 /*
@@ -83,20 +75,11 @@ ConditionSet UsesSolver::solve_right(Condition *condition) {
     return ConditionSet(); // empty set
 }
 
-template <typename Condition>
-ConditionSet UsesSolver::solve_variable(Condition *condition, SimpleVariable *variable) {
-    return ConditionSet(); // empty set
-}
-
 template <typename Condition>
 ConditionSet UsesSolver::solve_left(Condition *condition) {
     return ConditionSet(); // empty set
 }
 
-template <typename Condition>
-std::set<SimpleVariable> UsesSolver::index_variables(Condition *condition) {
-    return VariableSet();
-}
 
 template <>
 bool UsesSolver::validate<StatementAst, SimpleVariable>(
@@ -110,25 +93,9 @@ template <>
 bool UsesSolver::validate<AssignmentAst, SimpleVariable>(
         AssignmentAst *ast, SimpleVariable *var);
 
-template <>
-bool UsesSolver::validate<ExprAst, SimpleVariable>(
-        ExprAst *ast, SimpleVariable *var);
-
-template <>
-bool UsesSolver::validate<VariableAst, SimpleVariable>(
-        VariableAst *ast, SimpleVariable *var);
-
-template <>
-bool UsesSolver::validate<ConstAst, SimpleVariable>(
-        ConstAst *ast, SimpleVariable *var);
-
-template <>
-bool UsesSolver::validate<BinaryOpAst, SimpleVariable>(
-        BinaryOpAst *ast, SimpleVariable *var);
-
 template <>
 bool UsesSolver::validate<ConditionalAst, SimpleVariable>(
-        ConditionalAst *ast, SimpleVariable *var); 
+        ConditionalAst *ast, SimpleVariable *var);
 
 template <>
 bool UsesSolver::validate<WhileAst, SimpleVariable>(
@@ -141,12 +108,6 @@ bool UsesSolver::validate<CallAst, SimpleVariable>(
 template <>
 ConditionSet UsesSolver::solve_right<StatementAst>(StatementAst *ast);
 
-template <>
-ConditionSet UsesSolver::solve_right<ConditionalAst>(ConditionalAst *ast);
-
-template <>
-ConditionSet UsesSolver::solve_right<WhileAst>(WhileAst *ast);
-
 template <>
 ConditionSet UsesSolver::solve_right<ProcAst>(ProcAst *ast);
 
@@ -154,19 +115,17 @@ template <>
 ConditionSet UsesSolver::solve_right<AssignmentAst>(AssignmentAst *ast);
 
 template <>
-ConditionSet UsesSolver::solve_right<ExprAst>(ExprAst *ast);
+ConditionSet UsesSolver::solve_right<ConditionalAst>(ConditionalAst *ast);
 
 template <>
-ConditionSet UsesSolver::solve_right<VariableAst>(VariableAst *ast);
+ConditionSet UsesSolver::solve_right<WhileAst>(WhileAst *ast);
 
 template <>
-ConditionSet UsesSolver::solve_right<ConstAst>(ConstAst *ast);
+ConditionSet UsesSolver::solve_right<CallAst>(CallAst *ast);
 
 template <>
-ConditionSet UsesSolver::solve_right<BinaryOpAst>(BinaryOpAst *ast);
+ConditionSet UsesSolver::solve_left<SimpleVariable>(SimpleVariable *variable);
 
-template <>
-ConditionSet UsesSolver::solve_right<CallAst>(CallAst *ast);
 
 } // namespace impl
 } // namespace simple
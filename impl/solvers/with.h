@@ -0,0 +1,80 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simple/ast.h"
+#include "simple/condition_set.h"
+#include "impl/attribute_index.h"
+
+namespace simple {
+namespace impl {
+
+using namespace simple;
+
+/*
+ * WithSolver answers a single with clause, which relates conditions
+ * whose attributes are equal. Both directions are a lookup in the
+ * attribute index, so a clause with two query variables becomes a
+ * hash join.
+ */
+class WithSolver {
+  public:
+    WithSolver(AttributeIndexPtr index, Attribute left, Attribute right) :
+        _index(index), _left(left), _right(right)
+    { }
+
+    template <typename Condition1, typename Condition2>
+    bool validate(Condition1 *condition1, Condition2 *condition2) {
+        int key1, key2;
+        return _index->get_key(_left, condition1, key1) &&
+            _index->get_key(_right, condition2, key2) && key1 == key2;
+    }
+
+    template <typename Condition>
+    ConditionSet solve_right(Condition *condition) {
+        int key;
+        if(_index->get_key(_left, condition, key)) {
+            return _index->find(_right, key);
+        } else {
+            return ConditionSet();
+        }
+    }
+
+    template <typename Condition>
+    ConditionSet solve_left(Condition *condition) {
+        int key;
+        if(_index->get_key(_right, condition, key)) {
+            return _index->find(_left, key);
+        } else {
+            return ConditionSet();
+        }
+    }
+
+    size_t get_size() {
+        return _index->count_pairs(_left, _right);
+    }
+
+  private:
+    AttributeIndexPtr _index;
+    Attribute _left;
+    Attribute _right;
+};
+
+} // namespace impl
+} // namespace simple
@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include "simple/symbol.h"
 
 namespace simple {
 
@@ -46,38 +47,47 @@ class InconsistentAstError : public std::exception { };
 /*
  * SimpleVariable is just a convenient class to indicate in function
  * parameters that it is accepting a simple variable instead of a string 
- * that can mean anything.
+ * that can mean anything. It holds the interned symbol of the name, so
+ * copying and comparing variables does not touch the string.
  */
 class SimpleVariable {
   public:
-    SimpleVariable() : _name() { }
-    SimpleVariable(const std::string& name) : _name(name) { }
-    SimpleVariable(const SimpleVariable& other) : _name(other._name) { }
+    SimpleVariable() : _symbol(SymbolTable::empty()) { }
+    SimpleVariable(const std::string& name) : _symbol(SymbolTable::intern(name)) { }
+    SimpleVariable(const SimpleVariable& other) : _symbol(other._symbol) { }
 
-    std::string get_name() {
-        return _name;
+    const std::string& get_name() const {
+        return _symbol->get_name();
+    }
+
+    int get_symbol() const {
+        return _symbol->get_id();
     }
 
     bool equals(const SimpleVariable& other) const {
-        return _name == other._name;
+        return _symbol == other._symbol;
     }
 
     bool operator ==(const SimpleVariable& other) const {
         return equals(other);
     }
 
+    /*
+     * Variables are still ordered by name, which is the order results
+     * are printed in.
+     */
     bool operator <(const SimpleVariable& other) const {
-        return _name < other._name;
+        return _symbol != other._symbol && get_name() < other.get_name();
     }
 
     bool operator >(const SimpleVariable& other) const {
-        return _name > other._name;
+        return other < *this;
     }
 
     ~SimpleVariable() { }
 
   private:
-    std::string _name;
+    const Symbol *_symbol;
 };
 
 class SimpleConstant {
@@ -110,6 +120,11 @@ class ProcAst {
      */
     virtual std::string get_name() = 0;
 
+    /**
+     * Get the interned symbol of the procedure name.
+     */
+    virtual int get_symbol() = 0;
+
     /**
      * Get the first statement node in the given procedure.
      */
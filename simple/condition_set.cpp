@@ -17,7 +17,9 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include "simple/condition_set.h"
+#include "simple/condition_table.h"
 #include "simple/util/condition_utils.h"
 
 namespace simple {
@@ -35,56 +37,274 @@ using simple::util::condition_to_string;
 	return os;
 }
 
+ConditionUniverse::ConditionUniverse(const ConditionTable *table) :
+    _table(table), _conditions()
+{ }
+
+void ConditionUniverse::add_condition(const ConditionPtr& condition) {
+    _conditions.push_back(condition);
+}
+
+const ConditionTable* ConditionUniverse::get_table() const {
+    return _table;
+}
+
+const ConditionPtr& ConditionUniverse::get_condition(int id) const {
+    return _conditions[id];
+}
+
+size_t ConditionUniverse::get_size() const {
+    return _conditions.size();
+}
+
+int ConditionUniverse::find_id(const ConditionPtr& condition) const {
+    if(condition.get_table() == _table) {
+        return condition.get_id();
+    }
+
+    std::vector<ConditionPtr>::const_iterator it = std::lower_bound(
+            _conditions.begin(), _conditions.end(), condition);
+
+    if(it != _conditions.end() && *it == condition) {
+        return it->get_id();
+    } else {
+        return -1;
+    }
+}
+
+ConditionSet::iterator::iterator() :
+    _set(NULL), _index(0), _it()
+{ }
+
+ConditionSet::iterator::iterator(std::set<ConditionPtr>::const_iterator it) :
+    _set(NULL), _index(0), _it(it)
+{ }
+
+ConditionSet::iterator::iterator(const ConditionSet *set, size_t index) :
+    _set(set), _index(index), _it()
+{ }
+
+const ConditionPtr& ConditionSet::iterator::operator *() const {
+    if(_set) {
+        return _set->_universe->get_condition(_index);
+    } else {
+        return *_it;
+    }
+}
+
+const ConditionPtr* ConditionSet::iterator::operator ->() const {
+    return &(operator *());
+}
+
+ConditionSet::iterator& ConditionSet::iterator::operator ++() {
+    if(_set) {
+        _index = _set->next_index(_index + 1);
+    } else {
+        ++_it;
+    }
+    return *this;
+}
+
+ConditionSet::iterator ConditionSet::iterator::operator ++(int) {
+    iterator old = *this;
+    ++(*this);
+    return old;
+}
+
+bool ConditionSet::iterator::operator ==(const iterator& other) const {
+    if(_set != other._set) {
+        return false;
+    } else if(_set) {
+        return _index == other._index;
+    } else {
+        return _it == other._it;
+    }
+}
+
+bool ConditionSet::iterator::operator !=(const iterator& other) const {
+    return !(*this == other);
+}
+
 ConditionSet::ConditionSet() : 
-    _set() 
+    _set(), _universe(), _bits(), _dense_size(0)
 { }
 
 ConditionSet::ConditionSet(const ConditionSet& other) : 
-    _set(other._set) 
+    _set(other._set), _universe(other._universe), 
+    _bits(other._bits), _dense_size(other._dense_size)
 { }
 
 ConditionSet::ConditionSet(ConditionSet& other) :
-    _set(other._set)
+    _set(other._set), _universe(other._universe), 
+    _bits(other._bits), _dense_size(other._dense_size)
 { }
 
 ConditionSet::ConditionSet(ConditionSet&& other) : 
-    _set(std::move(other._set)) 
-{ }
+    _set(std::move(other._set)), _universe(std::move(other._universe)),
+    _bits(std::move(other._bits)), _dense_size(other._dense_size)
+{ 
+    other._dense_size = 0;
+}
 
 ConditionSet::ConditionSet(ConditionPtr condition) :
-    _set()
+    _set(), _universe(), _bits(), _dense_size(0)
 {
     insert(condition);
 }
 
 ConditionSet::ConditionSet(std::set<ConditionPtr>&& set) :
-    _set(std::forward< std::set<ConditionPtr> >(set))
-{ }
+    _set(std::forward< std::set<ConditionPtr> >(set)),
+    _universe(), _bits(), _dense_size(0)
+{ 
+    update_representation();
+}
+
+ConditionSet::ConditionSet(const ConditionUniversePtr& universe, 
+        const std::vector<int>& ids) :
+    _set(), _universe(), _bits(), _dense_size(0)
+{
+    if(ids.empty()) {
+        return;
+    }
+
+    _universe = universe;
+    _bits.assign((universe->get_size() + WORD_BITS - 1) / WORD_BITS, 0);
+
+    for(std::vector<int>::const_iterator it = ids.begin(); 
+            it != ids.end(); ++it)
+    {
+        Word mask = Word(1) << (*it % WORD_BITS);
+        if(!(_bits[*it / WORD_BITS] & mask)) {
+            _bits[*it / WORD_BITS] |= mask;
+            ++_dense_size;
+        }
+    }
+    update_representation();
+}
 
 void ConditionSet::insert(ConditionPtr condition) {
+    if(is_dense()) {
+        int id = find_id(condition);
+        if(id == -1) {
+            make_sparse();
+        } else {
+            Word mask = Word(1) << (id % WORD_BITS);
+            if(!(_bits[id / WORD_BITS] & mask)) {
+                _bits[id / WORD_BITS] |= mask;
+                ++_dense_size;
+            }
+            return;
+        }
+    }
+
     _set.insert(condition);
+
+    /*
+     * Only check for the dense threshold when the set has doubled in
+     * size, so that growing a set one condition at a time stays cheap.
+     */
+    size_t size = _set.size();
+    if(size >= DENSE_MIN_SIZE && (size & (size - 1)) == 0) {
+        update_representation();
+    }
 }
 
 void ConditionSet::insert(SimpleCondition *condition) {
-    _set.insert(ConditionPtr(condition));
+    insert(ConditionPtr(condition));
 }
 
 void ConditionSet::remove(ConditionPtr condition) {
-    _set.erase(condition);
+    if(is_dense()) {
+        int id = find_id(condition);
+        if(id == -1) {
+            return;
+        }
+
+        Word mask = Word(1) << (id % WORD_BITS);
+        if(_bits[id / WORD_BITS] & mask) {
+            _bits[id / WORD_BITS] &= ~mask;
+            --_dense_size;
+            update_representation();
+        }
+    } else {
+        _set.erase(condition);
+    }
 }
 
 void ConditionSet::union_with(const ConditionSet& other) {
-    union_set(_set, other._set);
+    if(other.is_empty()) {
+        return;
+    }
+
+    if(!is_dense() && other.is_dense()) {
+        /*
+         * Start from a copy of the dense set, which falls back to the
+         * sparse form by itself if any of our conditions is not in 
+         * its universe.
+         */
+        ConditionSet result(other);
+        for(std::set<ConditionPtr>::iterator it = _set.begin();
+                it != _set.end(); ++it)
+        {
+            result.insert(*it);
+        }
+        *this = std::move(result);
+        return;
+    }
+
+    if(is_same_universe(other)) {
+        size_t size = 0;
+        for(size_t i = 0; i < _bits.size(); ++i) {
+            _bits[i] |= other._bits[i];
+            size += __builtin_popcountll(_bits[i]);
+        }
+        _dense_size = size;
+        return;
+    }
+
+    if(!is_dense() && !other.is_dense()) {
+        union_set(_set, other._set);
+        update_representation();
+        return;
+    }
+
+    for(iterator it = other.begin(); it != other.end(); ++it) {
+        insert(*it);
+    }
 }
 
 void ConditionSet::intersect_with(const ConditionSet& other) {
     if(other.is_empty()) {
         // we are intersecting with empty set, and so
         // the result is also an empty set.
-        _set.clear();
+        clear();
         return; 
     }
 
+    if(is_same_universe(other)) {
+        size_t size = 0;
+        for(size_t i = 0; i < _bits.size(); ++i) {
+            _bits[i] &= other._bits[i];
+            size += __builtin_popcountll(_bits[i]);
+        }
+        _dense_size = size;
+        update_representation();
+        return;
+    }
+
+    if(is_dense()) {
+        for(size_t i = next_index(0); i < _universe->get_size(); 
+                i = next_index(i + 1)) 
+        {
+            if(!other.has_element(_universe->get_condition(i))) {
+                _bits[i / WORD_BITS] &= ~(Word(1) << (i % WORD_BITS));
+                --_dense_size;
+            }
+        }
+        update_representation();
+        return;
+    }
+
     std::set<ConditionPtr>::iterator it = _set.begin();
     while(it != _set.end()) {
         if(!other.has_element(*it)) {
@@ -97,23 +317,76 @@ void ConditionSet::intersect_with(const ConditionSet& other) {
 }
 
 ConditionSet ConditionSet::difference_with(const ConditionSet& other) {
-    return ConditionSet(difference_set(_set, other._set));
+    if(is_same_universe(other)) {
+        ConditionSet result(*this);
+        size_t size = 0;
+        for(size_t i = 0; i < result._bits.size(); ++i) {
+            result._bits[i] &= ~other._bits[i];
+            size += __builtin_popcountll(result._bits[i]);
+        }
+        result._dense_size = size;
+        result.update_representation();
+        return result;
+    }
+
+    if(!is_dense() && !other.is_dense()) {
+        return ConditionSet(difference_set(_set, other._set));
+    }
+
+    if(is_dense()) {
+        ConditionSet result(*this);
+        for(iterator it = other.begin(); it != other.end(); ++it) {
+            result.remove(*it);
+        }
+        return result;
+    }
+
+    ConditionSet result;
+    for(iterator it = begin(); it != end(); ++it) {
+        if(!other.has_element(*it)) {
+            result.insert(*it);
+        }
+    }
+    return result;
 }
 
 void ConditionSet::clear() {
     _set.clear();
+    _universe.reset();
+    _bits.clear();
+    _dense_size = 0;
 }
 
 bool ConditionSet::is_empty() const {
-    return _set.empty();
+    if(is_dense()) {
+        return _dense_size == 0;
+    } else {
+        return _set.empty();
+    }
+}
+
+bool ConditionSet::is_dense() const {
+    return _universe != NULL;
 }
 
 bool ConditionSet::equals(const ConditionSet& other) const {
-    return _set == other._set;
+    if(is_same_universe(other)) {
+        return _bits == other._bits;
+    } else if(!is_dense() && !other.is_dense()) {
+        return _set == other._set;
+    } else {
+        return get_size() == other.get_size() && 
+            std::equal(begin(), end(), other.begin());
+    }
 }
 
 bool ConditionSet::equals(const std::set<ConditionPtr>& other) const {
-    return _set == other;
+    if(is_dense()) {
+        return get_size() == other.size() && 
+            std::equal(begin(), end(), other.begin());
+    } else {
+        return _set == other;
+    }
 }
 
 bool ConditionSet::operator ==(const ConditionSet& other) const {
@@ -126,51 +399,198 @@ bool ConditionSet::operator !=(const ConditionSet& other) const {
 
 ConditionSet& ConditionSet::operator =(const ConditionSet& other) {
     _set = other._set;
+    _universe = other._universe;
+    _bits = other._bits;
+    _dense_size = other._dense_size;
+    return *this;
+}
+
+ConditionSet& ConditionSet::operator =(ConditionSet&& other) {
+    _set = std::move(other._set);
+    _universe = std::move(other._universe);
+    _bits = std::move(other._bits);
+    _dense_size = other._dense_size;
+    other._dense_size = 0;
     return *this;
 }
 
 bool ConditionSet::has_element(const ConditionPtr& other) const {
-    return _set.count(other) != 0;
+    if(is_dense()) {
+        int id = find_id(other);
+        return id != -1 && 
+            (_bits[id / WORD_BITS] & (Word(1) << (id % WORD_BITS)));
+    } else {
+        return _set.count(other) != 0;
+    }
 }
 
 size_t ConditionSet::get_size() const {
-    return _set.size();
+    if(is_dense()) {
+        return _dense_size;
+    } else {
+        return _set.size();
+    }
+}
+
+ConditionSet::iterator ConditionSet::begin() const {
+    if(is_dense()) {
+        return iterator(this, next_index(0));
+    } else {
+        return iterator(_set.begin());
+    }
+}
+
+ConditionSet::iterator ConditionSet::end() const {
+    if(is_dense()) {
+        return iterator(this, _universe->get_size());
+    } else {
+        return iterator(_set.end());
+    }
+}
+
+bool ConditionSet::is_same_universe(const ConditionSet& other) const {
+    return is_dense() && _universe == other._universe;
+}
+
+int ConditionSet::find_id(const ConditionPtr& condition) const {
+    return _universe->find_id(condition);
+}
+
+/*
+ * Find the first set bit starting from index, skipping empty words
+ * as a whole. Returns the universe size if there is none.
+ */
+size_t ConditionSet::next_index(size_t index) const {
+    size_t size = _universe->get_size();
+    if(index >= size) {
+        return size;
+    }
+
+    size_t word = index / WORD_BITS;
+    Word bits = _bits[word] & (~Word(0) << (index % WORD_BITS));
+
+    while(bits == 0) {
+        if(++word == _bits.size()) {
+            return size;
+        }
+        bits = _bits[word];
+    }
+
+    return word * WORD_BITS + __builtin_ctzll(bits);
+}
+
+/*
+ * Convert the set into its dense form if all of its conditions are
+ * interned in the same table.
+ */
+bool ConditionSet::try_make_dense() {
+    if(is_dense()) {
+        return true;
+    }
+
+    if(_set.empty() || !_set.begin()->is_interned()) {
+        return false;
+    }
+
+    const ConditionTable *table = _set.begin()->get_table();
+    for(std::set<ConditionPtr>::iterator it = _set.begin();
+            it != _set.end(); ++it)
+    {
+        if(it->get_table() != table) {
+            return false;
+        }
+    }
+
+    make_dense(table->get_universe());
+    return true;
 }
 
-std::set<ConditionPtr>::const_iterator ConditionSet::begin() const {
-    return _set.begin();
+void ConditionSet::make_dense(const ConditionUniversePtr& universe) {
+    _universe = universe;
+    _bits.assign((universe->get_size() + WORD_BITS - 1) / WORD_BITS, 0);
+    _dense_size = _set.size();
+
+    for(std::set<ConditionPtr>::iterator it = _set.begin();
+            it != _set.end(); ++it)
+    {
+        int id = it->get_id();
+        _bits[id / WORD_BITS] |= Word(1) << (id % WORD_BITS);
+    }
+    _set.clear();
 }
 
-std::set<ConditionPtr>::const_iterator ConditionSet::end() const {
-    return _set.end();
+void ConditionSet::make_sparse() {
+    std::set<ConditionPtr> result;
+    for(iterator it = begin(); it != end(); ++it) {
+        result.insert(result.end(), *it);
+    }
+
+    _universe.reset();
+    _bits.clear();
+    _dense_size = 0;
+    _set = std::move(result);
+}
+
+void ConditionSet::update_representation() {
+    if(is_dense()) {
+        if(_dense_size * DENSE_RATIO * 4 < _universe->get_size()) {
+            make_sparse();
+        }
+    } else if(_set.size() >= DENSE_MIN_SIZE && _set.begin()->is_interned() &&
+        _set.size() * DENSE_RATIO >= 
+            size_t(_set.begin()->get_table()->get_universe()->get_size()))
+    {
+        try_make_dense();
+    }
 }
 
 ConditionSet::~ConditionSet() { }
 
 ConditionPtr::ConditionPtr(SimpleCondition *condition) : 
-    _ptr(condition) 
+    _ptr(condition), _table(NULL), _id(-1)
 { }
 
 ConditionPtr::ConditionPtr(const std::shared_ptr<SimpleCondition>& other) :
-    _ptr(other)
+    _ptr(other), _table(NULL), _id(-1)
 { }
 
 ConditionPtr::ConditionPtr(std::shared_ptr<SimpleCondition>&& other) :
-    _ptr(std::move(other))
+    _ptr(std::move(other)), _table(NULL), _id(-1)
+{ }
+
+ConditionPtr::ConditionPtr(const ConditionPtr& other,
+        const ConditionTable *table, int id) :
+    _ptr(other._ptr), _table(table), _id(id)
 { }
 
 ConditionPtr::ConditionPtr(const ConditionPtr& other) :
-    _ptr(other._ptr)
+    _ptr(other._ptr), _table(other._table), _id(other._id)
 { }
 
 ConditionPtr::ConditionPtr(ConditionPtr&& other) :
-    _ptr(std::move(other._ptr))
+    _ptr(std::move(other._ptr)), _table(other._table), _id(other._id)
 { }
 
 SimpleCondition* ConditionPtr::get() const {
     return _ptr.get();
 }
 
+const ConditionTable* ConditionPtr::get_table() const {
+    return _table;
+}
+
+int ConditionPtr::get_id() const {
+    return _id;
+}
+
+bool ConditionPtr::is_interned() const {
+    return _table != NULL;
+}
+
+bool ConditionPtr::is_same_table(const ConditionPtr& other) const {
+    return _table != NULL && _table == other._table;
+}
+
 ConditionPtr::operator SimpleCondition*() const {
     return get();
 }
@@ -199,11 +619,31 @@ bool ConditionPtr::operator >=(const ConditionPtr& other) const {
     return !less_than(other);
 }
 
+ConditionPtr& ConditionPtr::operator =(const ConditionPtr& other) {
+    _ptr = other._ptr;
+    _table = other._table;
+    _id = other._id;
+    return *this;
+}
+
+ConditionPtr& ConditionPtr::operator =(ConditionPtr&& other) {
+    _ptr = std::move(other._ptr);
+    _table = other._table;
+    _id = other._id;
+    return *this;
+}
+
 bool ConditionPtr::equals(const ConditionPtr& other) const {
+    if(is_same_table(other)) {
+        return _id == other._id;
+    }
     return is_same_condition(get(), other.get());
 }
 
 bool ConditionPtr::less_than(const ConditionPtr& other) const {
+    if(is_same_table(other)) {
+        return _id < other._id;
+    }
     return is_less_than_condition(get(), other.get());
 }
 
@@ -19,6 +19,9 @@
 #pragma once
 
 #include <set>
+#include <vector>
+#include <iterator>
+#include <cstddef>
 #include <memory>
 #include <iostream>
 #include "simple/condition.h"
@@ -28,16 +31,30 @@ namespace simple {
 
 using namespace simple::util;
 
+class ConditionTable;
+
+/*
+ * A ConditionPtr that is handed out by a ConditionTable carries the
+ * table and the dense ID the table assigned to it. Two conditions
+ * interned in the same table are compared by ID only, which is a lot
+ * cheaper than double dispatching on the condition types.
+ */
 class ConditionPtr {
   public:
     ConditionPtr(SimpleCondition *condition);
     ConditionPtr(const std::shared_ptr<SimpleCondition>& other);
     ConditionPtr(std::shared_ptr<SimpleCondition>&& other);
+    ConditionPtr(const ConditionPtr& other, 
+                 const ConditionTable *table, int id);
     ConditionPtr(const ConditionPtr& other);
     ConditionPtr(ConditionPtr&& other);
 
     SimpleCondition* get() const;
 
+    const ConditionTable* get_table() const;
+    int get_id() const;
+    bool is_interned() const;
+
     bool equals(const ConditionPtr& other) const ;
     bool less_than(const ConditionPtr& other) const ;
     bool less_than_eq(const ConditionPtr& other) const;
@@ -50,15 +67,84 @@ class ConditionPtr {
     bool operator >(const ConditionPtr& other) const;
     bool operator >=(const ConditionPtr& other) const;
 
+    ConditionPtr& operator =(const ConditionPtr& other);
+    ConditionPtr& operator =(ConditionPtr&& other);
+
     ~ConditionPtr();
 
   private:
+    bool is_same_table(const ConditionPtr& other) const;
+
     std::shared_ptr<SimpleCondition> _ptr;
+    const ConditionTable *_table;
+    int _id;
+};
+
+/*
+ * ConditionUniverse holds all conditions interned by one ConditionTable,
+ * indexed by their ID and sorted in the same order as ConditionPtr. 
+ * Dense ConditionSets keep a reference to it so that they can map
+ * their bits back to conditions.
+ */
+class ConditionUniverse {
+  public:
+    ConditionUniverse(const ConditionTable *table);
+
+    void add_condition(const ConditionPtr& condition);
+
+    const ConditionTable* get_table() const;
+    const ConditionPtr& get_condition(int id) const;
+    size_t get_size() const;
+
+    /*
+     * Find the ID of a condition that is equal to the given condition,
+     * which may be interned in another table or not interned at all.
+     * Returns -1 if there is no such condition in the universe.
+     */
+    int find_id(const ConditionPtr& condition) const;
+
+  private:
+    const ConditionTable        *_table;
+    std::vector<ConditionPtr>   _conditions;
 };
 
+typedef std::shared_ptr<const ConditionUniverse> ConditionUniversePtr;
+
+/*
+ * A ConditionSet is stored either as a sorted std::set of conditions
+ * or, when all of its conditions are interned in the same table and
+ * it holds a sizeable fraction of that table, as a bitset over the
+ * table's IDs. The representation is switched automatically, and
+ * both forms iterate in the same order.
+ */
 class ConditionSet {
   public:
-    typedef std::set<ConditionPtr>::const_iterator  iterator;
+    class iterator {
+      public:
+        typedef std::forward_iterator_tag   iterator_category;
+        typedef ConditionPtr                value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const ConditionPtr*         pointer;
+        typedef const ConditionPtr&         reference;
+
+        iterator();
+        iterator(std::set<ConditionPtr>::const_iterator it);
+        iterator(const ConditionSet *set, size_t index);
+
+        const ConditionPtr& operator *() const;
+        const ConditionPtr* operator ->() const;
+
+        iterator& operator ++();
+        iterator operator ++(int);
+
+        bool operator ==(const iterator& other) const;
+        bool operator !=(const iterator& other) const;
+
+      private:
+        const ConditionSet                      *_set;
+        size_t                                  _index;
+        std::set<ConditionPtr>::const_iterator  _it;
+    };
 
     ConditionSet();
     ConditionSet(const ConditionSet& other);
@@ -67,6 +153,14 @@ class ConditionSet {
     ConditionSet(ConditionPtr condition);
     ConditionSet(std::set<ConditionPtr>&& set);
 
+    /*
+     * Build a set from the IDs of conditions in a universe, given in
+     * any order. The set starts out dense and only turns sparse if it
+     * is too small for its universe.
+     */
+    ConditionSet(const ConditionUniversePtr& universe, 
+            const std::vector<int>& ids);
+
     void insert(ConditionPtr condition);
     void insert(SimpleCondition *condition);
     void union_with(const ConditionSet& other);
@@ -76,6 +170,7 @@ class ConditionSet {
     void clear();
 
     bool is_empty() const;
+    bool is_dense() const;
     bool equals(const ConditionSet& other) const;
     bool equals(const std::set<ConditionPtr>& other) const;
     bool has_element(const ConditionPtr& other) const;
@@ -85,6 +180,7 @@ class ConditionSet {
     bool operator !=(const ConditionSet& other) const;
 
     ConditionSet& operator =(const ConditionSet& other);
+    ConditionSet& operator =(ConditionSet&& other);
 
     iterator begin() const;
     iterator end() const;
@@ -92,7 +188,31 @@ class ConditionSet {
     ~ConditionSet();
 
   private:
-    std::set<ConditionPtr> _set;
+    typedef unsigned long long  Word;
+    static const size_t         WORD_BITS = 64;
+
+    /*
+     * A set turns dense once it holds at least one condition for every
+     * DENSE_RATIO conditions in the universe, and turns back sparse when
+     * it drops below a quarter of that, so that a set hovering around
+     * the threshold does not keep converting.
+     */
+    static const size_t         DENSE_RATIO = 64;
+    static const size_t         DENSE_MIN_SIZE = 32;
+
+    bool is_same_universe(const ConditionSet& other) const;
+    int find_id(const ConditionPtr& condition) const;
+    size_t next_index(size_t index) const;
+
+    bool try_make_dense();
+    void make_dense(const ConditionUniversePtr& universe);
+    void make_sparse();
+    void update_representation();
+
+    std::set<ConditionPtr>  _set;
+    ConditionUniversePtr    _universe;
+    std::vector<Word>       _bits;
+    size_t                  _dense_size;
 };
 
 struct ConditionPair {
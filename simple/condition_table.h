@@ -0,0 +1,69 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include "simple/ast.h"
+#include "simple/condition.h"
+#include "simple/condition_set.h"
+
+namespace simple {
+
+/*
+ * ConditionTable interns every condition that can be derived from a
+ * program, i.e. its statements, procedures, variables, constants and
+ * assignment patterns, and assigns each of them a dense integer ID.
+ *
+ * The IDs follow the ordering of is_less_than_condition(), so the
+ * conditions of each kind occupy one contiguous range of IDs and an
+ * interned condition can still be mixed with non-interned ones in a
+ * ConditionSet.
+ *
+ * Conditions that do not appear in the program, such as a variable
+ * name that is only mentioned in a query, are returned as fresh 
+ * non-interned conditions.
+ */
+class ConditionTable {
+  public:
+    virtual ConditionPtr get_statement_condition(StatementAst *statement) = 0;
+    virtual ConditionPtr get_proc_condition(ProcAst *proc) = 0;
+    virtual ConditionPtr get_variable_condition(SimpleVariable *var) = 0;
+    virtual ConditionPtr get_constant_condition(SimpleConstant *constant) = 0;
+    virtual ConditionPtr get_pattern_condition(ExprAst *expr) = 0;
+
+    /*
+     * Get the interned copy of an arbitrary condition.
+     */
+    virtual ConditionPtr intern(const ConditionPtr& condition) = 0;
+
+    virtual ConditionPtr get_condition(int id) = 0;
+    virtual int get_size() = 0;
+
+    /*
+     * Get all interned conditions indexed by ID. The universe stays
+     * valid for as long as any dense ConditionSet refers to it.
+     */
+    virtual ConditionUniversePtr get_universe() const = 0;
+
+    virtual ~ConditionTable() { }
+};
+
+typedef std::shared_ptr<ConditionTable> ConditionTablePtr;
+
+} // namespace simple
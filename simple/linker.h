@@ -25,6 +25,18 @@
 
 namespace simple {
 
+/*
+ * Decides whether a pair of conditions that a linker already holds
+ * is still linked.
+ */
+class LinkFilter {
+  public:
+    virtual bool is_linked(const ConditionPtr& condition1,
+            const ConditionPtr& condition2) = 0;
+
+    virtual ~LinkFilter() { }
+};
+
 /**
  * Since PQL is almost the same as logic programming in Prolog, there is 
  * one problem that we have when solving PQL queries especially with multiple 
@@ -99,6 +111,19 @@ class QueryLinker {
             const std::string& qvar2, 
             const std::vector<ConditionPair>& links) = 0;
 
+    /*
+     * If the two query variables are already linked, remove the linked
+     * pairs between them that the filter rejects and return true. This
+     * only visits the pairs the linker holds, instead of the product of
+     * both result sets. Returns false without changing anything if the
+     * query variables are not linked yet, in which case the links have
+     * to be supplied with update_links().
+     */
+    virtual bool filter_links(
+            const std::string& qvar1,
+            const std::string& qvar2,
+            LinkFilter *filter) = 0;
+
     /**
      * Update the result for a single query variable by intersecting 
      * the old results with the new results supplied in the parameter.
@@ -123,6 +148,13 @@ class QueryLinker {
     virtual TupleList make_tuples(
             const std::vector<std::string>& variables) = 0;
 
+    /*
+     * Streams the same tuples as make_tuples() to the visitor as they
+     * are enumerated, without collecting them first.
+     */
+    virtual void enumerate_tuples(const std::vector<std::string>& variables,
+            TupleVisitor *visitor) = 0;
+
     /*
      * Indicates whether the qvar links are in a valid state.
      * If one of the query variables yield empty set result,
@@ -145,6 +177,20 @@ class QueryLinker {
      */
     virtual ConditionSet get_conditions(const std::string& qvar,
             SimplePredicate *pred) = 0;
+
+    /*
+     * Initialize the qvar with the global set of pred unless it is
+     * already initialized.
+     */
+    virtual void ensure_initialized(const std::string& qvar,
+            SimplePredicate *pred) = 0;
+
+    /*
+     * Tells the linker that no remaining clause refers to the qvar and
+     * that it is not selected, so the linker may stop tracking it as
+     * long as the links it carried between other qvars are kept.
+     */
+    virtual void drop_qvar(const std::string& qvar) = 0;
 };
 
 
@@ -38,6 +38,28 @@ class QuerySolver : public QueryValidator {
     virtual ConditionSet solve_left(SimpleCondition *right_condition) = 0;
     virtual ConditionSet solve_right(SimpleCondition *left_condition) = 0;
 
+    /*
+     * Solvers that can only validate a given pair return false, so
+     * that clauses with two query variables test every pair instead.
+     */
+    virtual bool can_enumerate() {
+        return true;
+    }
+
+    /*
+     * The conditions that have at least one right partner (the domain)
+     * or at least one left partner (the range). Solvers that do not
+     * keep them return NULL, and the conditions are then solved one
+     * by one instead.
+     */
+    virtual const ConditionSet* get_domain() {
+        return NULL;
+    }
+
+    virtual const ConditionSet* get_range() {
+        return NULL;
+    }
+
    virtual ~QuerySolver() { }
 };
 
@@ -0,0 +1,76 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simple/symbol.h"
+
+namespace simple {
+
+SymbolTable::SymbolTable() : _mutex(), _symbols(), _empty(NULL) {
+    _symbols[""].reset(new Symbol("", 0));
+    _empty = _symbols[""].get();
+}
+
+SymbolTable& SymbolTable::instance() {
+    static SymbolTable table;
+    return table;
+}
+
+/*
+ * Every thread remembers the symbols it has interned, so that parsers
+ * running in parallel rarely wait for each other on the lock.
+ */
+const Symbol* SymbolTable::intern(const std::string& name) {
+    thread_local std::unordered_map<std::string, const Symbol*> seen;
+
+    std::unordered_map<std::string, const Symbol*>::iterator it = seen.find(name);
+    if(it != seen.end()) {
+        return it->second;
+    }
+
+    SymbolTable& table = instance();
+    std::lock_guard<std::mutex> lock(table._mutex);
+
+    std::unique_ptr<Symbol>& symbol = table._symbols[name];
+    if(!symbol) {
+        symbol.reset(new Symbol(name, table._symbols.size() - 1));
+    }
+
+    seen[name] = symbol.get();
+    return symbol.get();
+}
+
+const Symbol* SymbolTable::find(const std::string& name) {
+    SymbolTable& table = instance();
+    std::lock_guard<std::mutex> lock(table._mutex);
+
+    std::unordered_map<std::string, std::unique_ptr<Symbol> >::iterator it = 
+        table._symbols.find(name);
+    return it == table._symbols.end() ? NULL : it->second.get();
+}
+
+const Symbol* SymbolTable::empty() {
+    return instance()._empty;
+}
+
+size_t SymbolTable::size() {
+    SymbolTable& table = instance();
+    std::lock_guard<std::mutex> lock(table._mutex);
+    return table._symbols.size();
+}
+
+} // namespace simple
@@ -0,0 +1,88 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace simple {
+
+/*
+ * A Symbol is the single shared copy of a variable or procedure name.
+ * Symbols are numbered densely from 0 in the order they are interned,
+ * so tables keyed by name can be vectors indexed by symbol.
+ */
+class Symbol {
+  public:
+    const std::string& get_name() const {
+        return _name;
+    }
+
+    int get_id() const {
+        return _id;
+    }
+
+  private:
+    friend class SymbolTable;
+
+    Symbol(const std::string& name, int id) : _name(name), _id(id) { }
+
+    std::string _name;
+    int         _id;
+};
+
+/*
+ * The process wide dictionary of names. Symbols are never removed, so
+ * a symbol pointer stays valid and can be compared instead of the name.
+ * The parsers intern names as they read them, and interning is safe
+ * from any thread.
+ */
+class SymbolTable {
+  public:
+    static const Symbol* intern(const std::string& name);
+
+    /*
+     * Returns NULL if the name has never been interned.
+     */
+    static const Symbol* find(const std::string& name);
+
+    /*
+     * The symbol of the empty name, which is always 0.
+     */
+    static const Symbol* empty();
+
+    /*
+     * One more than the largest symbol interned so far.
+     */
+    static size_t size();
+
+  private:
+    SymbolTable();
+
+    static SymbolTable& instance();
+
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::unique_ptr<Symbol> > _symbols;
+    const Symbol *_empty;
+};
+
+} // namespace simple
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 #include "simple/condition.h"
 #include "simple/condition_set.h"
 
@@ -53,6 +54,17 @@ class ConditionTuplePtr : public std::shared_ptr<ConditionTuple> {
 
 typedef std::set<ConditionTuplePtr> TupleList;
 
+/*
+ * Receives the rows of a tuple enumeration one at a time. The row is
+ * reused between calls.
+ */
+class TupleVisitor {
+  public:
+    virtual void visit_tuple(const std::vector<ConditionPtr>& row) = 0;
+
+    virtual ~TupleVisitor() { }
+};
+
 ::std::ostream& operator<<(::std::ostream& os, const ConditionTuplePtr& tuple);
 ::std::ostream& operator<<(::std::ostream& os, const TupleList& tuple);
 
@@ -105,8 +105,8 @@ bool is_same_statement<AssignmentAst, AssignmentAst>(AssignmentAst *assign1, Ass
 
 template <>
 bool is_same_statement<CallAst, CallAst>(CallAst *call1, CallAst *call2) {
-    return call1->get_proc_called()->get_name() == 
-           call2->get_proc_called()->get_name();
+    return call1->get_proc_called()->get_symbol() == 
+           call2->get_proc_called()->get_symbol();
 }
 
 template <>
@@ -271,5 +271,72 @@ bool SecondSameExprVisitor<FirstExpr>::return_result() {
 template <typename FirstExpr>
 SecondSameExprVisitor<FirstExpr>::~SecondSameExprVisitor() { }
 
+/*
+ * Flattens an expression node into its kind and its own value, so that
+ * two expressions can be ordered without a full double dispatch.
+ */
+class ExprKeyVisitor : public ExprVisitor {
+  public:
+    ExprKeyVisitor(ExprAst *ast) :
+        rank(0), value(0), name(), bin(NULL)
+    {
+        ast->accept_expr_visitor(this);
+    }
+
+    void visit_const(ConstAst *ast) {
+        rank = 0;
+        value = ast->get_constant()->get_int();
+    }
+
+    void visit_variable(VariableAst *ast) {
+        rank = 1;
+        name = ast->get_variable()->get_name();
+    }
+
+    void visit_binary_op(BinaryOpAst *ast) {
+        rank = 2;
+        value = ast->get_op();
+        bin = ast;
+    }
+
+    int         rank;
+    int         value;
+    std::string name;
+    BinaryOpAst *bin;
+};
+
+template <>
+bool is_less_than_expr<ExprAst, ExprAst>(ExprAst *ast1, ExprAst *ast2) {
+    ExprKeyVisitor key1(ast1);
+    ExprKeyVisitor key2(ast2);
+
+    if(key1.rank != key2.rank) {
+        return key1.rank < key2.rank;
+    }
+
+    switch(key1.rank) {
+        case 0:
+            return key1.value < key2.value;
+        case 1:
+            return key1.name < key2.name;
+        default:
+            if(key1.value != key2.value) {
+                return key1.value < key2.value;
+            }
+            if(is_less_than_expr<ExprAst, ExprAst>(
+                    key1.bin->get_lhs(), key2.bin->get_lhs()))
+            {
+                return true;
+            }
+            if(is_less_than_expr<ExprAst, ExprAst>(
+                    key2.bin->get_lhs(), key1.bin->get_lhs()))
+            {
+                return false;
+            }
+            return is_less_than_expr<ExprAst, ExprAst>(
+                    key1.bin->get_rhs(), key2.bin->get_rhs());
+    }
+}
+
 } // namespace util 
 } // namespace simple
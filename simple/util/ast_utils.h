@@ -119,6 +119,16 @@ bool is_same_expr<ConstAst, ConstAst>(ConstAst *ast1, ConstAst *ast2);
 template <>
 bool is_same_expr<BinaryOpAst, BinaryOpAst>(BinaryOpAst *ast1, BinaryOpAst *ast2);
 
+/*
+ * Expression Ordering:
+ * BinaryOp > Variable > Const
+ *
+ * Expressions of the same kind are ordered by their value, name, or
+ * by operator followed by the left and right operands.
+ */
+template <>
+bool is_less_than_expr<ExprAst, ExprAst>(ExprAst *ast1, ExprAst *ast2);
+
 
 
 } // namespace util 
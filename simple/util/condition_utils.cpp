@@ -16,7 +16,6 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <sstream>
 #include "simple/util/condition_utils.h"
 #include "simple/util/condition_visitor_generator.h"
 #include "simple/util/ast_utils.h"
@@ -44,55 +43,77 @@ class LessThanConditionVisitorTraits {
     }
 };
 
+/*
+ * ConditionPrinter appends the text of a condition to a caller owned
+ * string, so that printing many conditions does not allocate a new
+ * string for each of them.
+ */
 class ConditionPrinter : public ConditionVisitor {
   public:
-    ConditionPrinter(SimpleCondition *condition) :
-        _result()
-    {
-        condition->accept_condition_visitor(this);
-    }
+    ConditionPrinter(std::string& out) :
+        _out(out)
+    { }
 
     void visit_proc_condition(ProcCondition *condition) {
-        _result = condition->get_proc_ast()->get_name();
+        _out += condition->get_proc_ast()->get_name();
     }
 
     void visit_statement_condition(StatementCondition *condition) {
-        std::stringstream out;
-        out << condition->get_statement_ast()->get_line();
-        _result = out.str();
+        append_int(condition->get_statement_ast()->get_line(), _out);
     }
 
     void visit_variable_condition(VariableCondition *condition) {
-        _result = "\"";
-        _result += condition->get_variable()->get_name();
-        _result += "\"";
+        _out += '"';
+        _out += condition->get_variable()->get_name();
+        _out += '"';
     }
 
     void visit_constant_condition(ConstantCondition *condition) {
-        std::stringstream out;
-        out << '"';
-        out << condition->get_constant()->get_int();
-        out << '"';
-        _result = out.str();
+        _out += '"';
+        append_int(condition->get_constant()->get_int(), _out);
+        _out += '"';
     }
 
     void visit_pattern_condition(PatternCondition *condition) {
-        _result = "(PatternCondition ";
-        _result += (long) condition->get_expr_ast();
-        _result += ")";
+        _out += "(PatternCondition ";
+        append_int((long) condition->get_expr_ast(), _out);
+        _out += ")";
     }
 
-    std::string return_result() {
-        return std::move(_result);
-    }
   private:
-    std::string _result;
+    std::string& _out;
 };
 
 
 std::string condition_to_string(SimpleCondition *condition) {
-    ConditionPrinter printer(condition);
-    return printer.return_result();
+    std::string result;
+    append_condition(condition, result);
+    return result;
+}
+
+void append_condition(SimpleCondition *condition, std::string& out) {
+    ConditionPrinter printer(out);
+    condition->accept_condition_visitor(&printer);
+}
+
+void append_int(long value, std::string& out) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *begin = end;
+
+    unsigned long magnitude = value < 0 ? 
+        -static_cast<unsigned long>(value) : value;
+
+    do {
+        *--begin = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude != 0);
+
+    if(value < 0) {
+        *--begin = '-';
+    }
+
+    out.append(begin, end);
 }
 
 
@@ -118,8 +139,7 @@ template <>
 bool is_same_condition<VariableCondition, VariableCondition>(
         VariableCondition *condition1, VariableCondition *condition2)
 {
-    return condition1->get_variable()->get_name() ==
-        condition2->get_variable()->get_name();
+    return condition1->get_variable()->equals(*condition2->get_variable());
 }
 
 template <>
@@ -129,6 +149,14 @@ bool is_same_condition<ProcCondition, ProcCondition>(
     return condition1->get_proc_ast() == condition2->get_proc_ast();
 }
 
+template <>
+bool is_same_condition<ConstantCondition, ConstantCondition>(
+        ConstantCondition *condition1, ConstantCondition *condition2)
+{
+    return condition1->get_constant()->get_int() == 
+        condition2->get_constant()->get_int();
+}
+
 template <>
 bool is_same_condition<PatternCondition, PatternCondition>(
         PatternCondition *condition1, PatternCondition *condition2)
@@ -169,6 +197,34 @@ bool is_less_than_condition<VariableCondition, ProcCondition>(
     return true;
 }
 
+template <>
+bool is_less_than_condition<ConstantCondition, VariableCondition>(
+        ConstantCondition *condition1, VariableCondition *condition2)
+{
+    return true;
+}
+
+template <>
+bool is_less_than_condition<ConstantCondition, StatementCondition>(
+        ConstantCondition *condition1, StatementCondition *condition2)
+{
+    return true;
+}
+
+template <>
+bool is_less_than_condition<ConstantCondition, ProcCondition>(
+        ConstantCondition *condition1, ProcCondition *condition2)
+{
+    return true;
+}
+
+template <>
+bool is_less_than_condition<PatternCondition, ConstantCondition>(
+        PatternCondition *condition1, ConstantCondition *condition2)
+{
+    return true;
+}
+
 template <>
 bool is_less_than_condition<PatternCondition, VariableCondition>(
         PatternCondition *condition1, VariableCondition *condition2)
@@ -196,22 +252,42 @@ template <>
 bool is_less_than_condition<StatementCondition, StatementCondition>(
         StatementCondition *condition1, StatementCondition *condition2)
 {
-    return condition1->get_statement_ast() < condition2->get_statement_ast();
+    StatementAst *statement1 = condition1->get_statement_ast();
+    StatementAst *statement2 = condition2->get_statement_ast();
+
+    // lines keep the order the same for every run over the same program
+    if(statement1->get_line() != statement2->get_line()) {
+        return statement1->get_line() < statement2->get_line();
+    }
+    return statement1 < statement2;
 }
 
 template <>
 bool is_less_than_condition<VariableCondition, VariableCondition>(
         VariableCondition *condition1, VariableCondition *condition2)
 {
-    return  condition1->get_variable()->get_name() < 
-            condition2->get_variable()->get_name();
+    return *condition1->get_variable() < *condition2->get_variable();
+}
+
+template <>
+bool is_less_than_condition<ConstantCondition, ConstantCondition>(
+        ConstantCondition *condition1, ConstantCondition *condition2)
+{
+    return condition1->get_constant()->get_int() < 
+        condition2->get_constant()->get_int();
 }
 
 template <>
 bool is_less_than_condition<ProcCondition, ProcCondition>(
         ProcCondition *condition1, ProcCondition *condition2)
 {
-    return condition1->get_proc_ast() < condition2->get_proc_ast();
+    ProcAst *proc1 = condition1->get_proc_ast();
+    ProcAst *proc2 = condition2->get_proc_ast();
+
+    if(proc1->get_name() != proc2->get_name()) {
+        return proc1->get_name() < proc2->get_name();
+    }
+    return proc1 < proc2;
 }
 
 template <>
@@ -27,6 +27,13 @@ namespace util {
 
 std::string condition_to_string(SimpleCondition *condition);
 
+/*
+ * Appends the text of the condition or the decimal digits of the value
+ * to out without any intermediate strings.
+ */
+void append_condition(SimpleCondition *condition, std::string& out);
+void append_int(long value, std::string& out);
+
 template <typename Condition1, typename Condition2>
 bool is_same_condition(Condition1 *condition1, Condition2 *condition2) {
     return false;
@@ -48,13 +55,20 @@ template <>
 bool is_same_condition<ProcCondition, ProcCondition>(
         ProcCondition *condition1, ProcCondition *condition2);
 
+template <>
+bool is_same_condition<ConstantCondition, ConstantCondition>(
+        ConstantCondition *condition1, ConstantCondition *condition2);
+
 template <>
 bool is_same_condition<PatternCondition, PatternCondition>(
         PatternCondition *condition1, PatternCondition *condition2);
 
 /*
  * Condition Ordering:
- * Proc > Statement > Variable > Pattern
+ * Proc > Statement > Variable > Constant > Pattern
+ *
+ * Statements are ordered by line and procs by name, and only the
+ * ones on the same line or with the same name by their address.
  */
 template <typename Condition1, typename Condition2>
 bool is_less_than_condition(
@@ -79,6 +93,22 @@ template <>
 bool is_less_than_condition<VariableCondition, ProcCondition>(
         VariableCondition *condition1, ProcCondition *condition2);
 
+template <>
+bool is_less_than_condition<ConstantCondition, VariableCondition>(
+        ConstantCondition *condition1, VariableCondition *condition2);
+
+template <>
+bool is_less_than_condition<ConstantCondition, StatementCondition>(
+        ConstantCondition *condition1, StatementCondition *condition2);
+
+template <>
+bool is_less_than_condition<ConstantCondition, ProcCondition>(
+        ConstantCondition *condition1, ProcCondition *condition2);
+
+template <>
+bool is_less_than_condition<PatternCondition, ConstantCondition>(
+        PatternCondition *condition1, ConstantCondition *condition2);
+
 template <>
 bool is_less_than_condition<PatternCondition, VariableCondition>(
         PatternCondition *condition1, VariableCondition *condition2);
@@ -99,6 +129,10 @@ template <>
 bool is_less_than_condition<VariableCondition, VariableCondition>(
         VariableCondition *condition1, VariableCondition *condition2);
 
+template <>
+bool is_less_than_condition<ConstantCondition, ConstantCondition>(
+        ConstantCondition *condition1, ConstantCondition *condition2);
+
 template <>
 bool is_less_than_condition<ProcCondition, ProcCondition>(
         ProcCondition *condition1, ProcCondition *condition2);
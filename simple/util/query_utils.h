@@ -32,6 +32,45 @@ bool is_same_term(PqlTerm *term1, PqlTerm *term2);
 
 bool is_same_clause(PqlClause *clause1, PqlClause *clause2);
 
+/*
+ * Records the kind of a term together with its condition or query
+ * variable, for code that looks at a term without double dispatching.
+ */
+class PqlTermInfo : public PqlTermVisitor {
+  public:
+    PqlTermInfo(PqlTerm *term) : 
+        _is_condition(false), _is_wildcard(false), _condition(NULL), _qvar()
+    {
+        term->accept_pql_term_visitor(this);
+    }
+
+    void visit_condition_term(PqlConditionTerm *term) {
+        _is_condition = true;
+        _condition = term->get_condition();
+    }
+
+    void visit_variable_term(PqlVariableTerm *term) {
+        _qvar = term->get_query_variable();
+    }
+
+    void visit_wildcard_term(PqlWildcardTerm *term) {
+        _is_wildcard = true;
+    }
+
+    bool is_condition() const { return _is_condition; }
+    bool is_wildcard() const { return _is_wildcard; }
+    bool is_qvar() const { return !_is_condition && !_is_wildcard; }
+
+    const ConditionPtr& get_condition() const { return _condition; }
+    const std::string& get_qvar() const { return _qvar; }
+
+  private:
+    bool            _is_condition;
+    bool            _is_wildcard;
+    ConditionPtr    _condition;
+    std::string     _qvar;
+};
+
 
 template <typename Visitor, typename VisitorTraits, typename FirstTerm>
 class SecondPqlTermDoubleDispatcher : public PqlTermVisitor {
@@ -34,10 +34,16 @@ void union_set(std::set<T>& set1, const std::set<T>& set2) {
         return;
     }
     
+    /*
+     * set2 is iterated in order, so each element is likely to belong 
+     * right after the previously inserted one.
+     */
+    typename std::set<T>::iterator hint = set1.begin();
     for(typename std::set<T>::const_iterator it = set2.begin();
             it != set2.end(); ++it)
     {
-        set1.insert(*it);
+        hint = set1.insert(hint, *it);
+        ++hint;
     }
 }
 
@@ -49,7 +55,7 @@ std::set<T> difference_set(const std::set<T>& set1, const std::set<T>& set2) {
         it != set1.end(); ++it)
     {
         if(set2.count(*it) == 0) {
-            result.insert(*it);
+            result.insert(result.end(), *it);
         }
     }
 
@@ -189,10 +189,22 @@ class SimpleSolverGenerator : public QuerySolver  {
     };
 
   public:
-    SimpleSolverGenerator(ConcreteSolver *solver) : _solver(solver) { }
+    SimpleSolverGenerator(ConcreteSolver *solver) : 
+        _solver(solver), _has_partners(false)
+    { }
     
     SimpleSolverGenerator(std::shared_ptr<ConcreteSolver> solver) : 
-        _solver(solver) 
+        _solver(solver), _has_partners(false)
+    { }
+
+    /*
+     * A solver over a precomputed relation also takes the relation's
+     * domain and range, so that clauses with a wildcard term do not
+     * have to solve every condition.
+     */
+    SimpleSolverGenerator(std::shared_ptr<ConcreteSolver> solver,
+            const ConditionSet& domain, const ConditionSet& range) : 
+        _solver(solver), _domain(domain), _range(range), _has_partners(true)
     { }
 
     virtual ConditionSet solve_left(SimpleCondition *right_condition) {
@@ -213,12 +225,23 @@ class SimpleSolverGenerator : public QuerySolver  {
         return visitor.return_result();
     }
 
+    virtual const ConditionSet* get_domain() {
+        return _has_partners ? &_domain : NULL;
+    }
+
+    virtual const ConditionSet* get_range() {
+        return _has_partners ? &_range : NULL;
+    }
+
     ConcreteSolver* get_solver() {
         return _solver.get();
     }
 
   private:
     std::shared_ptr<ConcreteSolver> _solver;
+    ConditionSet _domain;
+    ConditionSet _range;
+    bool _has_partners;
 
 };
     
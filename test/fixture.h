@@ -19,6 +19,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <iterator>
+#include "impl/frontend.h"
 
 namespace simple {
 namespace test {
@@ -35,5 +38,17 @@ struct PqlTestFixture {
     std::vector<PqlQueryFixture> queries;
 };
 
+/*
+ * Runs a query through the front end and returns what it printed.
+ */
+inline std::string run_query(impl::SimplePqlFrontEnd& frontend, 
+        const std::string& query) 
+{
+    std::string output;
+    frontend.process_query(query.begin(), query.end(), 
+            std::back_inserter(output));
+    return output;
+}
+
 }
 }
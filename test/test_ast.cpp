@@ -46,3 +46,24 @@ TEST(AstTest, BasicTest) {
 
     EXPECT_EQ(*root.begin(), proc);
 }
+
+TEST(AstTest, SymbolTest) {
+    SimpleVariable x1("x"), x2(std::string("x")), y("y"), empty;
+
+    EXPECT_EQ(x1.get_symbol(), x2.get_symbol());
+    EXPECT_NE(x1.get_symbol(), y.get_symbol());
+    EXPECT_EQ(0, empty.get_symbol());
+    EXPECT_EQ("x", x2.get_name());
+
+    EXPECT_TRUE(x1 == x2);
+    EXPECT_FALSE(x1 < x2);
+    EXPECT_TRUE(x1 < y);
+    EXPECT_TRUE(y > x1);
+
+    EXPECT_EQ(SymbolTable::find("y"), SymbolTable::intern("y"));
+    EXPECT_TRUE(SymbolTable::find("no_such_symbol_name") == NULL);
+    EXPECT_GT(SymbolTable::size(), static_cast<size_t>(y.get_symbol()));
+
+    SimpleProcAst proc("y");
+    EXPECT_EQ(y.get_symbol(), proc.get_symbol());
+}
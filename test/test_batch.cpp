@@ -0,0 +1,175 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include "gtest/gtest.h"
+#include "impl/batch.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+TEST(BatchTest, ReadQueriesTest) {
+    std::stringstream in(
+        "1 - follows of the first statement\r\n"
+        "stmt s;\r\n"
+        "Select s such that Follows(1, s)\r\n"
+        "2\r\n"
+        "5000\r\n"
+        "2 - no time limit\n"
+        "\n"
+        "Select BOOLEAN such that Follows(1, 2)\n"
+        "true\n");
+
+    std::vector<BatchQuery> queries = BatchQueryRunner::read_queries(in);
+    ASSERT_EQ(queries.size(), 2u);
+
+    EXPECT_EQ(queries[0].id, "1");
+    EXPECT_EQ(queries[0].comment, "follows of the first statement");
+    EXPECT_EQ(queries[0].declarations, "stmt s;");
+    EXPECT_EQ(queries[0].query, "Select s such that Follows(1, s)");
+    EXPECT_EQ(queries[0].expected, "2");
+    EXPECT_EQ(queries[0].timeout_ms, 5000);
+
+    EXPECT_EQ(queries[1].id, "2");
+    EXPECT_EQ(queries[1].declarations, "");
+    EXPECT_EQ(queries[1].expected, "true");
+    EXPECT_EQ(queries[1].timeout_ms, -1);
+}
+
+TEST(BatchTest, MatchAnswerTest) {
+    EXPECT_TRUE(BatchQueryRunner::match_answer("s = 2, 3", "3,2"));
+    EXPECT_TRUE(BatchQueryRunner::match_answer("v = \"b\", \"c\"", "b, c"));
+    EXPECT_TRUE(BatchQueryRunner::match_answer("true", "true"));
+    EXPECT_TRUE(BatchQueryRunner::match_answer("s = ", "none"));
+    EXPECT_TRUE(BatchQueryRunner::match_answer("s = ", ""));
+
+    EXPECT_FALSE(BatchQueryRunner::match_answer("s = 2", "2, 3"));
+    EXPECT_FALSE(BatchQueryRunner::match_answer("false", "true"));
+}
+
+TEST(BatchTest, RunTest) {
+    std::string source = 
+        "proc test { \n"
+        "   a = 1; \n"
+        "   b = 2; \n"
+        "   c = 3; } \n";
+
+    SimplePqlFrontEnd frontend(source.begin(), source.end());
+    BatchQueryRunner runner(frontend, 5000);
+
+    BatchQuery query;
+    query.id = "1";
+    query.declarations = "stmt s;";
+    query.query = "Select s such that Follows*(1, s)";
+    query.expected = "2, 3";
+
+    BatchResult result = runner.run(query);
+    EXPECT_EQ(result.status, QUERY_OK);
+    EXPECT_TRUE(result.passed);
+    EXPECT_GE(result.wall_ms, 0);
+
+    query.expected = "2";
+    result = runner.run(query);
+    EXPECT_EQ(result.status, QUERY_OK);
+    EXPECT_FALSE(result.passed);
+
+    /*
+     * A query with an expired budget is aborted before any clause is
+     * evaluated.
+     */
+    std::string text = "stmt s; Select s such that Follows*(1, s)";
+    std::string output;
+    EXPECT_EQ(frontend.process_query(text.begin(), text.end(), 
+                std::back_inserter(output), QueryBudgetPtr(new QueryBudget(0))),
+            QUERY_TIMEOUT);
+    EXPECT_EQ(output, "Timeout");
+
+    std::vector<BatchResult> results;
+    results.push_back(result);
+
+    std::stringstream summary;
+    BatchQueryRunner::write_summary(results, summary);
+    EXPECT_NE(summary.str().find("\"failed\": 1"), std::string::npos);
+    EXPECT_NE(summary.str().find("\"status\": \"fail\""), std::string::npos);
+}
+
+TEST(BatchTest, ParallelTest) {
+    std::string source = 
+        "proc test1 { \n"
+        "   a = 1; \n"
+        "   while i { \n"
+        "       call test2; \n"
+        "       if j { \n"
+        "           x = (x+y)*(3+z); } else { \n"
+        "           y = 2; } } \n"
+        "   b = 4; } \n"
+        "proc test2 { \n"
+        "   c = 3; } \n";
+
+    SimplePqlFrontEnd frontend(source.begin(), source.end());
+
+    const char *relations[] = { "Follows", "Follows*", "Parent", "Parent*", 
+        "Next", "Next*" };
+
+    std::vector<BatchQuery> queries;
+    for(int line = 1; line <= 8; ++line) {
+        for(int r = 0; r < 6; ++r) {
+            std::stringstream text;
+            text << "Select s such that " << relations[r] << "(" << line << ", s)";
+
+            BatchQuery query;
+            query.id = text.str();
+            query.declarations = "stmt s;";
+            query.query = text.str();
+            queries.push_back(query);
+        }
+    }
+
+    std::stringstream serial_log;
+    std::vector<BatchResult> serial = BatchQueryRunner(frontend, 0).run_all(
+            queries, serial_log);
+
+    std::stringstream parallel_log;
+    std::vector<BatchResult> parallel = BatchQueryRunner(frontend, 0, 8).run_all(
+            queries, parallel_log);
+
+    ASSERT_EQ(serial.size(), queries.size());
+    ASSERT_EQ(parallel.size(), queries.size());
+
+    for(size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(parallel[i].id, queries[i].id);
+        EXPECT_EQ(parallel[i].output, serial[i].output);
+        EXPECT_EQ(parallel[i].status, QUERY_OK);
+    }
+
+    std::string line;
+    size_t count = 0;
+    while(getline(parallel_log, line)) {
+        if(line.compare(0, 7, "Select ") == 0) {
+            EXPECT_EQ(line.substr(0, queries[count].id.size()), queries[count].id);
+            ++count;
+        }
+    }
+    EXPECT_EQ(count, queries.size());
+}
+
+}
+}
@@ -0,0 +1,220 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "impl/ast.h"
+#include "impl/condition.h"
+#include "impl/cfg.h"
+#include "impl/condition_table.h"
+#include "simple/util/ast_utils.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::util;
+using namespace simple::impl;
+
+TEST(CfgTest, ComponentTest) {
+    /*
+     * proc test {
+     *   a = 1;
+     *   while i {
+     *     if j {
+     *       b = 2;
+     *     } else {
+     *       c = 3;
+     *     }
+     *   }
+     *   d = 4;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+
+    SimpleAssignmentAst *stat1 = new SimpleAssignmentAst();
+    stat1->set_variable(SimpleVariable("a"));
+    stat1->set_expr(new SimpleConstAst(1));
+    set_proc(stat1, proc);
+
+    SimpleWhileAst *stat2 = new SimpleWhileAst();
+    stat2->set_variable(SimpleVariable("i"));
+    set_next(stat1, stat2);
+
+    SimpleConditionalAst *stat3 = new SimpleConditionalAst();
+    stat3->set_variable(SimpleVariable("j"));
+    set_while_body(stat3, stat2);
+
+    SimpleAssignmentAst *stat4 = new SimpleAssignmentAst();
+    stat4->set_variable(SimpleVariable("b"));
+    stat4->set_expr(new SimpleConstAst(2));
+    set_then_branch(stat4, stat3);
+
+    SimpleAssignmentAst *stat5 = new SimpleAssignmentAst();
+    stat5->set_variable(SimpleVariable("c"));
+    stat5->set_expr(new SimpleConstAst(3));
+    set_else_branch(stat5, stat3);
+
+    SimpleAssignmentAst *stat6 = new SimpleAssignmentAst();
+    stat6->set_variable(SimpleVariable("d"));
+    stat6->set_expr(new SimpleConstAst(4));
+    set_next(stat2, stat6);
+
+    SimpleRoot root(proc);
+    ConditionTablePtr table(new SimpleConditionTable(root));
+    SimpleCfg cfg(root, table);
+
+    int id1 = table->get_statement_condition(stat1).get_id();
+    int id2 = table->get_statement_condition(stat2).get_id();
+    int id4 = table->get_statement_condition(stat4).get_id();
+    int id5 = table->get_statement_condition(stat5).get_id();
+    int id6 = table->get_statement_condition(stat6).get_id();
+
+    /*
+     * The loop collapses into a single component.
+     */
+    EXPECT_EQ(cfg.get_component_count(), (size_t) 3);
+
+    EXPECT_TRUE(cfg.get_next().validate(id4, id2));
+    EXPECT_TRUE(cfg.get_next().validate(id5, id2));
+    EXPECT_TRUE(cfg.get_next().validate(id2, id6));
+    EXPECT_FALSE(cfg.get_next().validate(id4, id6));
+
+    EXPECT_TRUE(cfg.validate_inext(id4, id5));
+    EXPECT_TRUE(cfg.validate_inext(id2, id2));
+    EXPECT_TRUE(cfg.validate_inext(id1, id6));
+    EXPECT_FALSE(cfg.validate_inext(id1, id1));
+    EXPECT_FALSE(cfg.validate_inext(id6, id2));
+
+    ConditionSet loop;
+    loop.insert(new SimpleStatementCondition(stat2));
+    loop.insert(new SimpleStatementCondition(stat3));
+    loop.insert(new SimpleStatementCondition(stat4));
+    loop.insert(new SimpleStatementCondition(stat5));
+
+    ConditionSet loop_next(loop);
+    loop_next.insert(new SimpleStatementCondition(stat6));
+    EXPECT_EQ(cfg.solve_inext_right(id4), loop_next);
+
+    ConditionSet loop_prev(loop);
+    loop_prev.insert(new SimpleStatementCondition(stat1));
+    EXPECT_EQ(cfg.solve_inext_left(id5), loop_prev);
+
+    EXPECT_TRUE(cfg.solve_inext_right(id6).is_empty());
+    EXPECT_TRUE(cfg.solve_inext_left(id1).is_empty());
+    EXPECT_FALSE(cfg.has_inext_right(id6));
+    EXPECT_TRUE(cfg.has_inext_left(id6));
+}
+
+TEST(CfgTest, LargeProcTest) {
+    /*
+     * proc test {
+     *   x = 0;
+     *   ...
+     *   x = 2499;
+     *   while i {
+     *     y = 1;
+     *     y = 2;
+     *   }
+     *   x = 2500;
+     *   ...
+     *   x = 4999;
+     * }
+     */
+    const int half = 2500;
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> before, after;
+
+    for(int i = 0; i < 2 * half; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i));
+
+        if(i == 0) {
+            set_proc(statement, proc);
+        } else if(i < half) {
+            set_next(before.back(), statement);
+        } else if(i > half) {
+            set_next(after.back(), statement);
+        }
+        (i < half ? before : after).push_back(statement);
+    }
+
+    SimpleWhileAst *loop = new SimpleWhileAst();
+    loop->set_variable(SimpleVariable("i"));
+
+    SimpleAssignmentAst *body1 = new SimpleAssignmentAst();
+    body1->set_variable(SimpleVariable("y"));
+    body1->set_expr(new SimpleConstAst(1));
+    set_while_body(body1, loop);
+
+    SimpleAssignmentAst *body2 = new SimpleAssignmentAst();
+    body2->set_variable(SimpleVariable("y"));
+    body2->set_expr(new SimpleConstAst(2));
+    set_next(body1, body2);
+
+    // splice the loop in between the two halves
+    set_next(before.back(), loop);
+    set_next(loop, after.front());
+
+    SimpleRoot root(proc);
+    ConditionTablePtr table(new SimpleConditionTable(root));
+    SimpleCfg cfg(root, table);
+
+    ASSERT_TRUE(2 * half + 3 > (int) SimpleCfg::REACH_LIMIT);
+
+    int first = table->get_statement_condition(before.front()).get_id();
+    int middle = table->get_statement_condition(before[10]).get_id();
+    int last = table->get_statement_condition(after.back()).get_id();
+    int loop_id = table->get_statement_condition(loop).get_id();
+    int body_id = table->get_statement_condition(body2).get_id();
+
+    EXPECT_EQ(cfg.get_component_count(), (size_t) 2 * half + 1);
+
+    EXPECT_TRUE(cfg.validate_inext(first, last));
+    EXPECT_TRUE(cfg.validate_inext(middle, body_id));
+    EXPECT_TRUE(cfg.validate_inext(body_id, body_id));
+    EXPECT_TRUE(cfg.validate_inext(body_id, loop_id));
+    EXPECT_FALSE(cfg.validate_inext(middle, first));
+    EXPECT_FALSE(cfg.validate_inext(first, first));
+    EXPECT_FALSE(cfg.validate_inext(last, body_id));
+
+    EXPECT_EQ(cfg.solve_inext_right(first).get_size(), (size_t) 2 * half + 2);
+    EXPECT_EQ(cfg.solve_inext_right(body_id).get_size(), (size_t) half + 3);
+    EXPECT_EQ(cfg.solve_inext_left(body_id).get_size(), (size_t) half + 3);
+    EXPECT_EQ(cfg.solve_inext_left(last).get_size(), (size_t) 2 * half + 2);
+    EXPECT_TRUE(cfg.solve_inext_right(last).is_empty());
+    EXPECT_TRUE(cfg.solve_inext_left(first).is_empty());
+
+    EXPECT_TRUE(cfg.solve_inext_left(body_id).has_element(
+                table->get_statement_condition(before[half - 1])));
+    EXPECT_FALSE(cfg.solve_inext_right(body_id).has_element(
+                table->get_statement_condition(before[half - 1])));
+
+    /*
+     * The estimate is exact for a program without if statements.
+     */
+    size_t size = 0;
+    for(size_t k = 0; k < (size_t) half; ++k) {
+        size += k + (k + 3 + half);
+    }
+    size += 3 * (3 + half);
+    EXPECT_EQ(cfg.get_inext_size(), size);
+}
+
+}
+}
@@ -22,6 +22,8 @@
 #include "impl/condition.h"
 #include "simple/condition_set.h"
 #include "simple/util/condition_utils.h"
+#include "simple/util/ast_utils.h"
+#include "impl/condition_table.h"
 
 namespace simple {
 namespace test {
@@ -161,5 +163,166 @@ TEST(ConditionTest, ConditionSetTest) {
     EXPECT_EQ(set3.get_size(), (size_t) 1);
 }
 
+TEST(ConditionTest, DenseConditionSetTest) {
+    /*
+     * proc test {
+     *   x = 0;
+     *   x = 1;
+     *   ...
+     *   x = 199;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> statements;
+
+    for(int i = 0; i < 200; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i));
+
+        if(i == 0) {
+            set_proc(statement, proc);
+        } else {
+            set_next(statements.back(), statement);
+        }
+        statements.push_back(statement);
+    }
+
+    SimpleRoot root(proc);
+    SimpleConditionTable table(root);
+
+    ConditionSet all, even, sparse_all;
+    for(int i = 0; i < 200; ++i) {
+        all.insert(table.get_statement_condition(statements[i]));
+        sparse_all.insert(new SimpleStatementCondition(statements[i]));
+        if(i % 2 == 0) {
+            even.insert(table.get_statement_condition(statements[i]));
+        }
+    }
+
+    EXPECT_TRUE(all.is_dense());
+    EXPECT_TRUE(even.is_dense());
+    EXPECT_FALSE(sparse_all.is_dense());
+
+    EXPECT_EQ(all.get_size(), (size_t) 200);
+    EXPECT_EQ(even.get_size(), (size_t) 100);
+    EXPECT_EQ(all, sparse_all);
+    EXPECT_TRUE(all.has_element(new SimpleStatementCondition(statements[3])));
+    EXPECT_FALSE(even.has_element(table.get_statement_condition(statements[3])));
+    EXPECT_FALSE(all.has_element(new SimpleVariableCondition(SimpleVariable("y"))));
+
+    ConditionSet odd = all.difference_with(even);
+    EXPECT_EQ(odd.get_size(), (size_t) 100);
+    EXPECT_TRUE(odd.has_element(table.get_statement_condition(statements[3])));
+    EXPECT_FALSE(odd.has_element(table.get_statement_condition(statements[4])));
+
+    ConditionSet none(odd);
+    none.intersect_with(even);
+    EXPECT_TRUE(none.is_empty());
+
+    odd.union_with(even);
+    EXPECT_EQ(odd, all);
+
+    /*
+     * Dense sets iterate in the same order as sparse sets.
+     */
+    ConditionSet::iterator dit = all.begin();
+    for(ConditionSet::iterator sit = sparse_all.begin(); 
+            sit != sparse_all.end(); ++sit, ++dit)
+    {
+        EXPECT_EQ(*sit, *dit);
+    }
+    EXPECT_TRUE(dit == all.end());
+
+    /*
+     * Shrinking a dense set far enough turns it back into a sparse set.
+     */
+    ConditionSet small(all);
+    small.intersect_with(ConditionSet(table.get_statement_condition(statements[7])));
+    EXPECT_FALSE(small.is_dense());
+    EXPECT_EQ(small.get_size(), (size_t) 1);
+
+    /*
+     * Inserting a condition outside of the table also turns the set sparse.
+     */
+    ConditionSet mixed(all);
+    mixed.insert(new SimpleVariableCondition(SimpleVariable("y")));
+    EXPECT_FALSE(mixed.is_dense());
+    EXPECT_EQ(mixed.get_size(), (size_t) 201);
+
+    sparse_all.intersect_with(even);
+    EXPECT_EQ(sparse_all, even);
+
+    /*
+     * Sets built from IDs in any order, with duplicates.
+     */
+    std::vector<int> ids;
+    for(int i = 198; i >= 0; i -= 2) {
+        ids.push_back(table.get_statement_condition(statements[i]).get_id());
+        ids.push_back(table.get_statement_condition(statements[i]).get_id());
+    }
+    ConditionSet even_ids(table.get_universe(), ids);
+    EXPECT_TRUE(even_ids.is_dense());
+    EXPECT_EQ(even_ids.get_size(), (size_t) 100);
+    EXPECT_EQ(even_ids, even);
+
+    ConditionSet small_ids(table.get_universe(), std::vector<int>(1,
+                table.get_statement_condition(statements[7]).get_id()));
+    EXPECT_FALSE(small_ids.is_dense());
+    EXPECT_EQ(small_ids, small);
+
+    EXPECT_TRUE(ConditionSet(table.get_universe(), std::vector<int>()).is_empty());
+}
+
+TEST(ConditionTest, SmallConditionSetStaysSparseTest) {
+    /*
+     * proc test {
+     *   x = 0;
+     *   x = 1;
+     *   ...
+     *   x = 3999;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> statements;
+
+    for(int i = 0; i < 4000; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i));
+
+        if(i == 0) {
+            set_proc(statement, proc);
+        } else {
+            set_next(statements.back(), statement);
+        }
+        statements.push_back(statement);
+    }
+
+    SimpleRoot root(proc);
+    SimpleConditionTable table(root);
+
+    /*
+     * A set that reaches the size check with only a tiny fraction of
+     * the universe must not be turned into a universe-wide bitset.
+     */
+    ConditionSet small;
+    for(int i = 0; i < 64; ++i) {
+        small.insert(table.get_statement_condition(statements[i]));
+        EXPECT_FALSE(small.is_dense());
+    }
+    EXPECT_EQ(small.get_size(), (size_t) 64);
+
+    ConditionSet large(small);
+    for(int i = 64; i < 4000; ++i) {
+        large.insert(table.get_statement_condition(statements[i]));
+    }
+    EXPECT_TRUE(large.is_dense());
+    EXPECT_EQ(large.get_size(), (size_t) 4000);
+
+    large.intersect_with(small);
+    EXPECT_EQ(large, small);
+}
+
 }
 }
@@ -0,0 +1,135 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include "gtest/gtest.h"
+#include "impl/flat_ast.h"
+#include "impl/parser/parser.h"
+#include "impl/parser/iterator_tokenizer.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+using namespace simple::parser;
+
+namespace {
+
+const std::string SOURCE =
+    "proc alpha { \n"
+    "   a = b + 2 * c; \n"
+    "   while a { \n"
+    "       if b { \n"
+    "           call beta; } \n"
+    "       else { \n"
+    "           c = a; } \n"
+    "       b = 1; } \n"
+    "   d = c; } \n"
+    "proc beta { \n"
+    "   e = 3; } \n";
+
+SimpleRoot parse(const std::string& source) {
+    SimpleParser parser(
+        new IteratorTokenizer<std::string::const_iterator>(
+            source.begin(), source.end()));
+    return parser.parse_program();
+}
+
+} // anonymous namespace
+
+TEST(FlatAstTest, StatementLayoutTest) {
+    SimpleRoot ast = parse(SOURCE);
+    FlatAst flat(ast);
+
+    ASSERT_EQ(8, flat.get_statement_count());
+    ASSERT_EQ(2, flat.get_proc_count());
+
+    EXPECT_EQ(ast.get_proc("alpha"), flat.get_proc_ast(0));
+    EXPECT_EQ(ast.get_proc("beta"), flat.get_proc_ast(1));
+    EXPECT_EQ(0, flat.get_proc_begin(0));
+    EXPECT_EQ(7, flat.get_proc_end(0));
+    EXPECT_EQ(7, flat.get_proc_begin(1));
+    EXPECT_EQ(8, flat.get_proc_end(1));
+    EXPECT_EQ(0, flat.get_proc(6));
+    EXPECT_EQ(1, flat.get_proc(7));
+
+    FlatStatementType types[] = { 
+        FLAT_ASSIGNMENT, FLAT_WHILE, FLAT_CONDITIONAL, FLAT_CALL, 
+        FLAT_ASSIGNMENT, FLAT_ASSIGNMENT, FLAT_ASSIGNMENT, FLAT_ASSIGNMENT
+    };
+    for(int i = 0; i < 8; ++i) {
+        EXPECT_EQ(types[i], flat.get_type(i));
+        EXPECT_EQ(flat.get_statement_ast(i)->get_line(), flat.get_line(i));
+    }
+
+    EXPECT_EQ(-1, flat.get_parent(0));
+    EXPECT_EQ(1, flat.get_next(0));
+    EXPECT_EQ(6, flat.get_next(1));
+    EXPECT_EQ(1, flat.get_prev(6));
+    EXPECT_EQ(-1, flat.get_prev(0));
+    EXPECT_EQ(-1, flat.get_next(5));
+
+    EXPECT_EQ(2, flat.get_first_child(1));
+    EXPECT_EQ(-1, flat.get_else_child(1));
+    EXPECT_EQ(3, flat.get_first_child(2));
+    EXPECT_EQ(4, flat.get_else_child(2));
+    EXPECT_EQ(2, flat.get_parent(3));
+    EXPECT_EQ(2, flat.get_parent(4));
+    EXPECT_EQ(1, flat.get_parent(2));
+    EXPECT_EQ(1, flat.get_parent(5));
+    EXPECT_EQ(5, flat.get_next(2));
+    EXPECT_EQ(-1, flat.get_next(3));
+
+    EXPECT_EQ(1, flat.get_callee(3));
+    EXPECT_EQ(-1, flat.get_callee(0));
+}
+
+TEST(FlatAstTest, ExprPoolTest) {
+    SimpleRoot ast = parse(SOURCE);
+    FlatAst flat(ast);
+
+    // a = b + 2 * c is stored as b 2 c * +
+    int begin = flat.get_expr_begin(0);
+    ASSERT_EQ(5, flat.get_expr_end(0) - begin);
+
+    EXPECT_EQ(FLAT_VARIABLE, flat.get_expr_type(begin));
+    EXPECT_EQ(flat.find_variable("b"), flat.get_expr_value(begin));
+    EXPECT_EQ(FLAT_CONSTANT, flat.get_expr_type(begin + 1));
+    EXPECT_EQ(2, flat.get_expr_value(begin + 1));
+    EXPECT_EQ(FLAT_VARIABLE, flat.get_expr_type(begin + 2));
+    EXPECT_EQ(flat.find_variable("c"), flat.get_expr_value(begin + 2));
+    EXPECT_EQ(FLAT_BINARY_OP, flat.get_expr_type(begin + 3));
+    EXPECT_EQ('*', flat.get_expr_value(begin + 3));
+    EXPECT_EQ(FLAT_BINARY_OP, flat.get_expr_type(begin + 4));
+    EXPECT_EQ('+', flat.get_expr_value(begin + 4));
+
+    // containers and calls have no expression
+    EXPECT_EQ(flat.get_expr_begin(1), flat.get_expr_end(1));
+    EXPECT_EQ(flat.get_expr_begin(3), flat.get_expr_end(3));
+
+    EXPECT_EQ(flat.find_variable("a"), flat.get_variable(0));
+    EXPECT_EQ(flat.find_variable("a"), flat.get_variable(1));
+    EXPECT_EQ(flat.find_variable("b"), flat.get_variable(2));
+    EXPECT_EQ(5, flat.get_variable_count());
+    EXPECT_EQ(-1, flat.find_variable("z"));
+    EXPECT_EQ("e", flat.get_variable_ast(flat.find_variable("e"))->get_name());
+}
+
+} // namespace test
+} // namespace simple
@@ -62,6 +62,80 @@ TEST(FrontEndTest, IntegratedTest) {
     EXPECT_EQ(result2, "v = \"b\", \"c\"");
 }
 
+TEST(FrontEndTest, TupleTest) {
+    std::string source = 
+        "proc test1 { \n"
+        "   a = 1; \n"
+        "   while i { \n"
+        "       call test2; \n"
+        "       if j { \n"
+        "           x = (x+y)*(3+z); } else { \n"
+        "           y = 2; } } \n"
+        "   b = 4; } \n"
+        "proc test2 { \n"
+        "   c = 3; } \n";
+
+    SimplePqlFrontEnd frontend(source.begin(), source.end());
+
+    const char *queries[][2] = {
+        { "stmt s1, s2; Select <s1, s2> such that Follows(s1, s2)", 
+            "<s1, s2> = 1 2, 2 7, 3 4" },
+        { "stmt s1, s2, s3; Select <s3, s1> such that Follows(s1, s2) "
+            "and Follows(s2, s3)", "<s3, s1> = 7 1" },
+        { "stmt s; variable v; Select <v, s> such that Modifies(s, v) "
+            "and Follows(s, 7)", "<v, s> = \"c\" 2, \"x\" 2, \"y\" 2" },
+        { "procedure p; call c; Select <p, c> such that Call(p, \"test2\")", 
+            "<p, c> = test1 3" },
+        { "stmt s; Select <s, s> such that Follows(s, 2)", "<s, s> = 1 1" },
+        { "stmt s; assign a; Select <s, a> such that Follows(s, 1)", 
+            "<s, a> = " }
+    };
+
+    LinkerMode modes[] = { LINKER_COLUMNAR, LINKER_SIMPLE };
+
+    for(size_t k = 0; k < 2; ++k) {
+        frontend.set_linker_mode(modes[k]);
+
+        for(size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i) {
+            std::string query(queries[i][0]);
+            std::string result;
+            frontend.process_query(query.begin(), query.end(), 
+                    std::back_inserter(result));
+            EXPECT_EQ(result, queries[i][1]) << query << " " << k;
+        }
+    }
+}
+
+TEST(FrontEndTest, ResultWriterTest) {
+    SimpleAssignmentAst stat1(1);
+    SimpleAssignmentAst stat2(23);
+    SimpleVariable var("x");
+
+    ConditionSet conditions;
+    conditions.insert(new SimpleStatementCondition(&stat1));
+    conditions.insert(new SimpleStatementCondition(&stat2));
+
+    std::string result;
+    std::back_insert_iterator<std::string> out(result);
+
+    {
+        // a small chunk size flushes after every write
+        ResultWriter< std::back_insert_iterator<std::string> > writer(out, 4);
+        writer.write("s = ");
+        EXPECT_EQ(result, "s = ");
+
+        writer.write_elements(conditions);
+        writer.write_element(ConditionPtr(new SimpleVariableCondition(var)).get());
+        writer.write_int(-405);
+        writer.write_int(0);
+    }
+    EXPECT_EQ(result, "s = 1, 23, \"x\"-4050");
+
+    std::string text;
+    append_int(-9223372036854775807L - 1, text);
+    EXPECT_EQ(text, "-9223372036854775808");
+}
+
 class FrontEndFixtureTest : public testing::TestWithParam<PqlTestFixture> {
 
 };
@@ -79,6 +153,20 @@ TEST_P(FrontEndFixtureTest, BasicTest) {
     }
 }
 
+TEST_P(FrontEndFixtureTest, SimpleLinkerTest) {
+    PqlTestFixture fixture = GetParam();
+    SimplePqlFrontEnd frontend(fixture.source.begin(), fixture.source.end());
+    frontend.set_linker_mode(LINKER_SIMPLE);
+
+    for(std::vector<PqlQueryFixture>::iterator it = fixture.queries.begin();
+            it != fixture.queries.end(); ++it)
+    {
+        std::string result;
+        frontend.process_query(it->query.begin(), it->query.end(), std::back_inserter(result));
+        EXPECT_EQ(result, it->expected) << it->query;
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(BasicFixtures, FrontEndFixtureTest,
         testing::ValuesIn(get_basic_test_fixtures()));
 
@@ -0,0 +1,259 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include "gtest/gtest.h"
+#include "impl/frontend.h"
+#include "test/fixture.h"
+#include "impl/incremental.h"
+#include "impl/node_pool.h"
+#include "simple/util/ast_utils.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+namespace {
+
+const char *FIRST_VERSION =
+    "proc alpha { \n"
+    "   a = 1; \n"
+    "   call beta; \n"
+    "   b = a; } \n"
+    "proc beta { \n"
+    "   while c { \n"
+    "       c = c - 1; } } \n"
+    "proc gamma { \n"
+    "   if d { \n"
+    "       e = d; } \n"
+    "   else { \n"
+    "       e = 2; } \n"
+    "   while e { \n"
+    "       e = e - 1; \n"
+    "       f = e; } } \n";
+
+/*
+ * beta gains a statement, which moves every line of gamma.
+ */
+const char *SECOND_VERSION =
+    "proc alpha { \n"
+    "   a = 1; \n"
+    "   call beta; \n"
+    "   b = a; } \n"
+    "proc beta { \n"
+    "   while c { \n"
+    "       c = c - 1; \n"
+    "       g = a; } } \n"
+    "proc gamma { \n"
+    "   if d { \n"
+    "       e = d; } \n"
+    "   else { \n"
+    "       e = 2; } \n"
+    "   while e { \n"
+    "       e = e - 1; \n"
+    "       f = e; } } \n";
+
+const char *INCREMENTAL_QUERIES[] = {
+    "stmt s; Select s such that Follows*(1, s)",
+    "stmt s; Select s such that Parent*(s, 12)",
+    "stmt s; Select s such that Next*(12, s)",
+    "stmt s; Select s such that Next(s, 8)",
+    "var v; Select v such that Modifies(\"alpha\", v)",
+    "var v; Select v such that Uses(2, v)",
+    "var v; Select v such that Modifies(12, v)",
+    "var v; Select v such that Uses(\"gamma\", v)",
+    "assign a; while w; Select a such that Parent*(w, a)"
+};
+
+/*
+ * A program with the given number of procedures, all of which differ
+ * from the program of the previous version.
+ */
+std::string make_version(int procs, int version) {
+    std::ostringstream source;
+    for(int i = 0; i < procs; ++i) {
+        source << "proc p" << i << " { \n";
+        for(int j = 0; j < 20; ++j) {
+            source << "   x" << j << " = x" << (j + 1) << " + " << version << "; \n";
+        }
+        source << "   while y { \n";
+        source << "       y = y - " << version << "; } } \n";
+    }
+    return source.str();
+}
+
+} // anonymous namespace
+
+TEST(IncrementalTest, UpdateTest) {
+    IncrementalProgram program;
+    ProgramUpdate first = program.update(FIRST_VERSION);
+    EXPECT_EQ(first.changed.size(), 3u);
+    EXPECT_TRUE(first.reused.empty());
+
+    ProcAst *gamma = first.ast.get_proc("gamma");
+    ProgramUpdate second = program.update(SECOND_VERSION);
+
+    std::set<std::string> changed;
+    changed.insert("beta");
+    EXPECT_EQ(second.changed, changed);
+
+    // alpha calls beta, so only gamma is kept
+    ASSERT_EQ(second.reused.size(), 1u);
+    EXPECT_EQ(*second.reused.begin(), gamma);
+    EXPECT_EQ(second.ast.get_proc("gamma"), gamma);
+    EXPECT_EQ(gamma->get_statement()->get_line(), 7);
+    EXPECT_EQ(second.line_table[7], gamma->get_statement());
+    EXPECT_EQ(second.line_table.size(), 12u);
+}
+
+TEST(IncrementalTest, FrontEndTest) {
+    SimplePqlFrontEnd frontend((std::string(FIRST_VERSION)));
+    frontend.update_source(SECOND_VERSION);
+
+    std::string source(SECOND_VERSION);
+    SimplePqlFrontEnd parsed(source.begin(), source.end());
+
+    for(size_t i = 0; i < sizeof(INCREMENTAL_QUERIES) / sizeof(char*); ++i) {
+        EXPECT_EQ(run_query(frontend, INCREMENTAL_QUERIES[i]), 
+                run_query(parsed, INCREMENTAL_QUERIES[i]));
+    }
+
+    // going back only reparses beta again
+    frontend.update_source(FIRST_VERSION);
+    source = FIRST_VERSION;
+    SimplePqlFrontEnd first(source.begin(), source.end());
+
+    for(size_t i = 0; i < sizeof(INCREMENTAL_QUERIES) / sizeof(char*); ++i) {
+        EXPECT_EQ(run_query(frontend, INCREMENTAL_QUERIES[i]), 
+                run_query(first, INCREMENTAL_QUERIES[i]));
+    }
+}
+
+TEST(IncrementalTest, ErrorTest) {
+    SimplePqlFrontEnd frontend((std::string(FIRST_VERSION)));
+    std::string query = "stmt s; Select s such that Follows*(1, s)";
+    std::string expected = run_query(frontend, query);
+
+    // syntax error
+    std::string broken(SECOND_VERSION);
+    broken.replace(broken.find("g = a;"), 6, "g = ;");
+    EXPECT_THROW(frontend.update_source(broken), ParserError);
+    EXPECT_EQ(run_query(frontend, query), expected);
+
+    // alpha still calls the removed beta
+    std::string removed(FIRST_VERSION);
+    removed.erase(removed.find("proc beta"), 
+            removed.find("proc gamma") - removed.find("proc beta"));
+    EXPECT_THROW(frontend.update_source(removed), ParserError);
+    EXPECT_EQ(run_query(frontend, query), expected);
+
+    frontend.update_source(SECOND_VERSION);
+    EXPECT_EQ(run_query(frontend, query), expected);
+}
+
+/*
+ * Procedure names may contain underscores, as in any other identifier.
+ */
+TEST(IncrementalTest, UnderscoreNameTest) {
+    std::string source(
+        "proc my_main { \n"
+        "   a_1 = 1; \n"
+        "   call other_p; \n"
+        "   b = a_1; } \n"
+        "proc other_p { \n"
+        "   c = 2; } \n");
+
+    IncrementalProgram program;
+    ProgramUpdate update = program.update(source);
+    EXPECT_TRUE(update.ast.get_proc("my_main") != NULL);
+    EXPECT_TRUE(update.ast.get_proc("other_p") != NULL);
+    EXPECT_EQ(update.line_table.size(), 4u);
+
+    SimplePqlFrontEnd frontend(source);
+    SimplePqlFrontEnd parsed(source.begin(), source.end());
+    std::string query = "stmt s; Select s such that Follows(s, _)";
+    EXPECT_EQ(run_query(frontend, query), run_query(parsed, query));
+
+    source.replace(source.find("c = 2;"), 6, "c = 3;");
+    ProgramUpdate second = program.update(source);
+    std::set<std::string> changed;
+    changed.insert("other_p");
+    EXPECT_EQ(second.changed, changed);
+}
+
+/*
+ * Parsing and indexing on several threads builds the same program as
+ * on one thread, and a parse error on any thread is reported.
+ */
+TEST(IncrementalTest, ParallelTest) {
+    IncrementalProgram serial(1);
+    IncrementalProgram parallel(4);
+
+    ProgramUpdate expected = serial.update(FIRST_VERSION);
+    ProgramUpdate result = parallel.update(FIRST_VERSION);
+
+    ASSERT_EQ(result.line_table.size(), expected.line_table.size());
+    for(LineTable::iterator it = expected.line_table.begin(); 
+            it != expected.line_table.end(); ++it)
+    {
+        EXPECT_TRUE(util::is_same_statement(it->second, result.line_table[it->first]));
+    }
+
+    SimpleConditionTable serial_table(expected.ast, 1);
+    SimpleConditionTable parallel_table(expected.ast, 4);
+
+    ASSERT_EQ(parallel_table.get_size(), serial_table.get_size());
+    for(int i = 0; i < serial_table.get_size(); ++i) {
+        EXPECT_TRUE(serial_table.get_condition(i) == parallel_table.get_condition(i));
+    }
+
+    std::string broken(SECOND_VERSION);
+    broken.replace(broken.find("f = e;"), 6, "f = ;");
+    broken.replace(broken.find("g = a;"), 6, "g = ;");
+    EXPECT_THROW(parallel.update(broken), ParserError);
+
+    ProgramUpdate second = parallel.update(SECOND_VERSION);
+    EXPECT_EQ(second.line_table.size(), 12u);
+}
+
+/*
+ * Procedures parsed on worker threads are deleted on the calling
+ * thread, and the worker threads exit after each update. The AST
+ * nodes of later updates must reuse the blocks freed by earlier ones
+ * instead of taking new chunks every time.
+ */
+TEST(IncrementalTest, ParallelMemoryTest) {
+    IncrementalProgram program(8);
+
+    for(int version = 0; version < 20; ++version) {
+        program.update(make_version(16, version));
+    }
+
+    size_t chunks = NodePool::get_chunk_count();
+    for(int version = 20; version < 200; ++version) {
+        ProgramUpdate update = program.update(make_version(16, version));
+        EXPECT_EQ(update.changed.size(), 16u);
+    }
+
+    EXPECT_LE(NodePool::get_chunk_count(), chunks + 8);
+}
+
+} // namespace test
+} // namespace simple
@@ -16,6 +16,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sstream>
 #include "gtest/gtest.h"
 #include "impl/ast.h"
 #include "impl/condition.h"
@@ -449,11 +450,6 @@ TEST(LinkerTest, ThreeWayTest) {
     
     EXPECT_EQ(linker.make_tuples(make_string_list("x", "z")), tuples_xz1);
 
-    /*
-     * TODO: Fix the combination algorithms that involves both direct and 
-     * indirect links. It seems that the whole linker needs to be rewritten
-     * to solve this bug.
-     *
     TupleList tuples_yzx1;
     tuples_yzx1.insert(make_tuples(condition22, condition35, condition11));
     tuples_yzx1.insert(make_tuples(condition23, condition33, condition11));
@@ -470,10 +466,85 @@ TEST(LinkerTest, ThreeWayTest) {
     tuples_zxy1.insert(make_tuples(condition34, condition12, condition24));
     tuples_zxy1.insert(make_tuples(condition33, condition12, condition24));
     
-    EXPECT_EQ(linker.make_tuples(make_string_list("z", "x", "y")), tuples_zxy1);*/
+    EXPECT_EQ(linker.make_tuples(make_string_list("z", "x", "y")), tuples_zxy1);
 
 }
 
+TEST(LinkerTest, CyclicLinks) {
+    SimpleAssignmentAst stat11(11);
+    SimpleAssignmentAst stat12(12);
+
+    ConditionPtr condition1(new SimpleStatementCondition(&stat11));
+    ConditionPtr condition2(new SimpleStatementCondition(&stat12));
+
+    ConditionSet both;
+    both.insert(condition1);
+    both.insert(condition2);
+
+    std::vector<ConditionPair> same;
+    same.push_back(ConditionPair(condition1, condition1));
+    same.push_back(ConditionPair(condition2, condition2));
+
+    std::vector<ConditionPair> swapped;
+    swapped.push_back(ConditionPair(condition1, condition2));
+    swapped.push_back(ConditionPair(condition2, condition1));
+
+    /*
+     * x - y - w is linked by same conditions, and x - z - u - w
+     * swaps the conditions on the last link:
+     *
+     * <X, W> = <1, 1>, <2, 2> through Y
+     * <X, W> = <1, 2>, <2, 1> through Z and U
+     *
+     * Every condition keeps a linked condition on every link, yet no
+     * tuple satisfies both paths.
+     */
+    SimpleQueryLinker linker;
+    linker.update_results("x", both);
+    linker.update_results("y", both);
+    linker.update_results("z", both);
+    linker.update_results("u", both);
+    linker.update_results("w", both);
+
+    linker.update_links("x", "y", same);
+    linker.update_links("y", "w", same);
+    linker.update_links("x", "z", same);
+    linker.update_links("z", "u", same);
+    linker.update_links("u", "w", swapped);
+
+    EXPECT_TRUE(linker.is_valid_state());
+    EXPECT_EQ(linker.get_conditions("w"), both);
+
+    // only the shortest path through y is composed
+    EXPECT_EQ(linker.get_indirect_links("x", "w", condition1), 
+            ConditionSet(condition1));
+    EXPECT_EQ(linker.get_indirect_links("x", "u", condition1), 
+            ConditionSet(condition1));
+
+    EXPECT_TRUE(linker.make_tuples(make_string_list("x", "w")).empty());
+    EXPECT_TRUE(linker.make_tuples(make_string_list("y", "u")).empty());
+    EXPECT_TRUE(linker.make_tuples(make_string_list("x", "y")).empty());
+
+    /*
+     * With the same conditions on all links, the tuples follow them.
+     */
+    SimpleQueryLinker linker2;
+    linker2.update_results("x", both);
+    linker2.update_results("y", both);
+    linker2.update_results("z", both);
+    linker2.update_results("w", both);
+
+    linker2.update_links("x", "y", same);
+    linker2.update_links("y", "w", same);
+    linker2.update_links("x", "z", same);
+    linker2.update_links("z", "w", same);
+
+    TupleList tuples_xw;
+    tuples_xw.insert(make_tuples(condition1, condition1));
+    tuples_xw.insert(make_tuples(condition2, condition2));
+    EXPECT_EQ(linker2.make_tuples(make_string_list("x", "w")), tuples_xw);
+}
+
 TEST(LinkerTest, UnlinkedPermutations) {
 
 }
@@ -482,6 +553,62 @@ TEST(LinkerTest, IndirectLinks) {
 
 }
 
+TEST(LinkerTest, LongPropagation) {
+    SimpleAssignmentAst stat1(1);
+    SimpleAssignmentAst stat2(2);
+
+    ConditionPtr condition1(new SimpleStatementCondition(&stat1));
+    ConditionPtr condition2(new SimpleStatementCondition(&stat2));
+
+    ConditionSet both;
+    both.insert(condition1);
+    both.insert(condition2);
+
+    std::vector<ConditionPair> links;
+    links.push_back(ConditionPair(condition1, condition1));
+    links.push_back(ConditionPair(condition2, condition2));
+
+    /*
+     * A chain of qvars q0 - q1 - ... where each condition is only
+     * linked to itself in the neighbouring qvars, so that a removal
+     * at one end cascades through the whole chain.
+     */
+    const int chain_size = 20000;
+    std::vector<std::string> qvars;
+    for(int i = 0; i < chain_size; ++i) {
+        std::ostringstream name;
+        name << "q" << i;
+        qvars.push_back(name.str());
+    }
+
+    SimpleQueryLinker linker;
+    linker.update_results(qvars[0], both);
+    for(int i = 1; i < chain_size; ++i) {
+        linker.update_results(qvars[i], both);
+        linker.update_links(qvars[i - 1], qvars[i], links);
+    }
+
+    linker.update_results(qvars[0], ConditionSet(condition2));
+    EXPECT_EQ(linker.get_conditions(qvars[chain_size - 1]), 
+            ConditionSet(condition2));
+    EXPECT_TRUE(linker.is_valid_state());
+
+    EXPECT_TRUE(linker.validate(qvars[1], qvars[2], condition2, condition2));
+    EXPECT_TRUE(linker.get_linked_conditions(
+                qvars[1], qvars[2], condition1).is_empty());
+
+    EXPECT_EQ(linker.get_indirect_links(qvars[0], qvars[chain_size - 1], 
+                condition2), ConditionSet(condition2));
+    EXPECT_TRUE(linker.get_indirect_links(qvars[0], qvars[chain_size - 1], 
+                condition1).is_empty());
+
+    linker.remove_condition(qvars[chain_size - 1], condition2);
+    EXPECT_TRUE(linker.get_conditions(qvars[0]).is_empty());
+    EXPECT_TRUE(linker.get_indirect_links(qvars[0], qvars[chain_size - 1], 
+                condition2).is_empty());
+    EXPECT_FALSE(linker.is_valid_state());
+}
+
 
 }
 }
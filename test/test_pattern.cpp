@@ -0,0 +1,110 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iterator>
+#include "gtest/gtest.h"
+#include "impl/frontend.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+TEST(PatternTest, ExprIndexTest) {
+    std::string source = 
+        "proc test { \n"
+        "   a = x + y * 2; \n"
+        "   b = (x + y) * 2; \n"
+        "   c = (x + y) * (x + y); } \n";
+
+    SimpleParser parser(new BufferTokenizer(
+                source.data(), source.data() + source.size()));
+    SimpleRoot ast = parser.parse_program();
+
+    FlatAst flat(ast);
+    ExprIndex index(flat);
+
+    SimpleBinaryOpAst x_plus_y('+', new SimpleVariableAst("x"), 
+            new SimpleVariableAst("y"));
+    ExprPattern pattern;
+    EXPECT_TRUE(index.make_pattern(&x_plus_y, pattern));
+
+    std::vector<int> statements = index.find_subexpr(pattern);
+    ASSERT_EQ(statements.size(), 2u);
+    EXPECT_EQ(flat.get_line(statements[0]), 2);
+    EXPECT_EQ(flat.get_line(statements[1]), 3);
+    EXPECT_TRUE(index.find_exact(pattern).empty());
+
+    SimpleBinaryOpAst y_plus_x('+', new SimpleVariableAst("y"), 
+            new SimpleVariableAst("x"));
+    ExprPattern reversed;
+    EXPECT_TRUE(index.make_pattern(&y_plus_x, reversed));
+    EXPECT_TRUE(index.find_subexpr(reversed).empty());
+
+    SimpleBinaryOpAst y_times_two('*', new SimpleVariableAst("y"), 
+            new SimpleConstAst(2));
+    ExprPattern product;
+    EXPECT_TRUE(index.make_pattern(&y_times_two, product));
+    statements = index.find_subexpr(product);
+    ASSERT_EQ(statements.size(), 1u);
+    EXPECT_EQ(flat.get_line(statements[0]), 1);
+
+    SimpleVariableAst unknown("pattern_test_unknown");
+    ExprPattern missing;
+    EXPECT_FALSE(index.make_pattern(&unknown, missing));
+}
+
+TEST(PatternTest, QueryTest) {
+    std::string source = 
+        "proc test { \n"
+        "   a = x + y * 2; \n"
+        "   b = (x + y) * 2; \n"
+        "   while i { \n"
+        "       x = x + y; \n"
+        "       c = a; } \n"
+        "   y = 2 * y + x + y; } \n";
+
+    SimplePqlFrontEnd frontend(source.begin(), source.end());
+
+    const char *queries[][2] = {
+        { "assign a; Select a pattern a(_, _\"x + y\"_)", "a = 2, 4" },
+        { "assign a; Select a pattern a(_, _\"y * 2\"_)", "a = 1" },
+        { "assign a; Select a pattern a(\"x\", \"x+y\")", "a = 4" },
+        { "assign a; Select a pattern a(_, \"y * 2\")", "a = " },
+        { "assign a; Select a pattern a(\"c\", _)", "a = 5" },
+        { "assign a; var v; Select v pattern a(v, _\"2\"_)", 
+            "v = \"a\", \"b\", \"y\"" },
+        { "assign a; Select a such that Parent(3, a) pattern a(_, _\"y\"_)", 
+            "a = 4" },
+        { "assign a, a1; Select a pattern a(_, _\"x\"_) and a1(\"c\", _) "
+            "such that Follows(a, a1)", "a = 4" },
+        { "assign a; Select a pattern a(_, _\"zzz\"_)", "a = " }
+    };
+
+    for(size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i) {
+        std::string query(queries[i][0]);
+        std::string result;
+        frontend.process_query(query.begin(), query.end(), 
+                std::back_inserter(result));
+        EXPECT_EQ(result, queries[i][1]) << query;
+    }
+}
+
+} // namespace test
+} // namespace simple
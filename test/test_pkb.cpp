@@ -0,0 +1,364 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "impl/ast.h"
+#include "impl/condition.h"
+#include "impl/pkb.h"
+#include "impl/parser/parser.h"
+#include "impl/parser/buffer_tokenizer.h"
+#include "simple/util/ast_utils.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::util;
+using namespace simple::impl;
+using namespace simple::parser;
+
+TEST(PkbTest, RelationTest) {
+    /*
+     * proc test1 {
+     *   a = b;
+     *   while i {
+     *     call test2;
+     *     c = a + d;
+     *   }
+     *   e = 1;
+     * }
+     *
+     * proc test2 {
+     *   f = g;
+     * }
+     */
+    SimpleProcAst *proc1 = new SimpleProcAst("test1");
+    SimpleProcAst *proc2 = new SimpleProcAst("test2");
+
+    SimpleVariable var_a("a"), var_b("b"), var_c("c"), var_d("d"), 
+                   var_e("e"), var_f("f"), var_g("g"), var_i("i");
+
+    SimpleAssignmentAst *stat1 = new SimpleAssignmentAst();
+    stat1->set_variable(var_a);
+    stat1->set_expr(new SimpleVariableAst(var_b));
+    set_proc(stat1, proc1);
+
+    SimpleWhileAst *stat2 = new SimpleWhileAst();
+    stat2->set_variable(var_i);
+    set_next(stat1, stat2);
+
+    SimpleCallAst *stat3 = new SimpleCallAst(proc2);
+    set_while_body(stat3, stat2);
+
+    SimpleAssignmentAst *stat4 = new SimpleAssignmentAst();
+    stat4->set_variable(var_c);
+    stat4->set_expr(new SimpleBinaryOpAst('+', 
+                new SimpleVariableAst(var_a), new SimpleVariableAst(var_d)));
+    set_next(stat3, stat4);
+
+    SimpleAssignmentAst *stat5 = new SimpleAssignmentAst();
+    stat5->set_variable(var_e);
+    stat5->set_expr(new SimpleConstAst(1));
+    set_next(stat2, stat5);
+
+    SimpleAssignmentAst *stat6 = new SimpleAssignmentAst();
+    stat6->set_variable(var_f);
+    stat6->set_expr(new SimpleVariableAst(var_g));
+    set_proc(stat6, proc2);
+
+    std::vector<ProcAst*> procs;
+    procs.push_back(proc1);
+    procs.push_back(proc2);
+    SimpleRoot root(procs.begin(), procs.end());
+
+    SimplePkb pkb(root, ConditionTablePtr(new SimpleConditionTable(root)));
+
+    int id1 = pkb.get_statement_id(stat1);
+    int id2 = pkb.get_statement_id(stat2);
+    int id3 = pkb.get_statement_id(stat3);
+    int id4 = pkb.get_statement_id(stat4);
+    int id5 = pkb.get_statement_id(stat5);
+    int id6 = pkb.get_statement_id(stat6);
+    int proc_id1 = pkb.get_proc_id(proc1);
+    int proc_id2 = pkb.get_proc_id(proc2);
+
+    SimpleVariable var_x("x");
+    EXPECT_EQ(pkb.get_variable_id(&var_x), -1);
+
+    /*
+     * Follows
+     */
+    EXPECT_TRUE(pkb.get_follows().validate(id1, id2));
+    EXPECT_TRUE(pkb.get_follows().validate(id2, id5));
+    EXPECT_TRUE(pkb.get_follows().validate(id3, id4));
+    EXPECT_FALSE(pkb.get_follows().validate(id1, id5));
+    EXPECT_FALSE(pkb.get_follows().validate(id2, id3));
+    EXPECT_FALSE(pkb.get_follows().has_right(id5));
+    EXPECT_FALSE(pkb.get_follows().has_left(id6));
+    EXPECT_EQ(pkb.get_follows().get_size(), (size_t) 3);
+
+    ConditionSet follows_domain;
+    follows_domain.insert(new SimpleStatementCondition(stat1));
+    follows_domain.insert(new SimpleStatementCondition(stat2));
+    follows_domain.insert(new SimpleStatementCondition(stat3));
+    EXPECT_EQ(pkb.get_follows().get_domain(), follows_domain);
+
+    ConditionSet follows_range;
+    follows_range.insert(new SimpleStatementCondition(stat2));
+    follows_range.insert(new SimpleStatementCondition(stat4));
+    follows_range.insert(new SimpleStatementCondition(stat5));
+    EXPECT_EQ(pkb.get_follows().get_range(), follows_range);
+
+    /*
+     * Parent
+     */
+    ConditionSet children;
+    children.insert(new SimpleStatementCondition(stat3));
+    children.insert(new SimpleStatementCondition(stat4));
+    EXPECT_EQ(pkb.get_parent().solve_right(id2), children);
+    EXPECT_EQ(pkb.get_parent().solve_left(id4), 
+            ConditionSet(new SimpleStatementCondition(stat2)));
+    EXPECT_TRUE(pkb.get_parent().solve_left(id1).is_empty());
+
+    /*
+     * Calls
+     */
+    EXPECT_TRUE(pkb.get_calls().validate(proc_id1, proc_id2));
+    EXPECT_FALSE(pkb.get_calls().validate(proc_id2, proc_id1));
+
+    /*
+     * Modifies
+     */
+    ConditionSet while_modifies;
+    while_modifies.insert(new SimpleVariableCondition(var_c));
+    while_modifies.insert(new SimpleVariableCondition(var_f));
+    EXPECT_EQ(pkb.get_modifies().solve_right(id2), while_modifies);
+
+    ConditionSet proc_modifies(while_modifies);
+    proc_modifies.insert(new SimpleVariableCondition(var_a));
+    proc_modifies.insert(new SimpleVariableCondition(var_e));
+    EXPECT_EQ(pkb.get_modifies().solve_right(proc_id1), proc_modifies);
+
+    ConditionSet modifies_f;
+    modifies_f.insert(new SimpleStatementCondition(stat2));
+    modifies_f.insert(new SimpleStatementCondition(stat3));
+    modifies_f.insert(new SimpleStatementCondition(stat6));
+    modifies_f.insert(new SimpleProcCondition(proc1));
+    modifies_f.insert(new SimpleProcCondition(proc2));
+    EXPECT_EQ(pkb.get_modifies().solve_left(pkb.get_variable_id(&var_f)), modifies_f);
+
+    /*
+     * Uses
+     */
+    ConditionSet while_uses;
+    while_uses.insert(new SimpleVariableCondition(var_i));
+    while_uses.insert(new SimpleVariableCondition(var_a));
+    while_uses.insert(new SimpleVariableCondition(var_d));
+    while_uses.insert(new SimpleVariableCondition(var_g));
+    EXPECT_EQ(pkb.get_uses().solve_right(id2), while_uses);
+
+    EXPECT_TRUE(pkb.get_uses().validate(proc_id1, pkb.get_variable_id(&var_b)));
+    EXPECT_FALSE(pkb.get_uses().validate(id5, pkb.get_variable_id(&var_e)));
+    EXPECT_TRUE(pkb.get_uses().solve_right(id5).is_empty());
+}
+
+TEST(PkbTest, ClosureTest) {
+    /*
+     * proc test1 {
+     *   while i {
+     *     while j {
+     *       a = 1;
+     *     }
+     *     b = 2;
+     *   }
+     *   c = 3;
+     *   call test2;
+     * }
+     *
+     * proc test2 {
+     *   call test1;
+     * }
+     */
+    SimpleProcAst *proc1 = new SimpleProcAst("test1");
+    SimpleProcAst *proc2 = new SimpleProcAst("test2");
+
+    SimpleWhileAst *stat1 = new SimpleWhileAst();
+    stat1->set_variable(SimpleVariable("i"));
+    set_proc(stat1, proc1);
+
+    SimpleWhileAst *stat2 = new SimpleWhileAst();
+    stat2->set_variable(SimpleVariable("j"));
+    set_while_body(stat2, stat1);
+
+    SimpleAssignmentAst *stat3 = new SimpleAssignmentAst();
+    stat3->set_variable(SimpleVariable("a"));
+    stat3->set_expr(new SimpleConstAst(1));
+    set_while_body(stat3, stat2);
+
+    SimpleAssignmentAst *stat4 = new SimpleAssignmentAst();
+    stat4->set_variable(SimpleVariable("b"));
+    stat4->set_expr(new SimpleConstAst(2));
+    set_next(stat2, stat4);
+
+    SimpleAssignmentAst *stat5 = new SimpleAssignmentAst();
+    stat5->set_variable(SimpleVariable("c"));
+    stat5->set_expr(new SimpleConstAst(3));
+    set_next(stat1, stat5);
+
+    SimpleCallAst *stat6 = new SimpleCallAst(proc2);
+    set_next(stat5, stat6);
+
+    SimpleCallAst *stat7 = new SimpleCallAst(proc1);
+    set_proc(stat7, proc2);
+
+    std::vector<ProcAst*> procs;
+    procs.push_back(proc1);
+    procs.push_back(proc2);
+    SimpleRoot root(procs.begin(), procs.end());
+
+    ConditionTablePtr table(new SimpleConditionTable(root));
+    SimplePkb matrix_pkb(root, table, CLOSURE_MATRIX);
+    SimplePkb interval_pkb(root, table, CLOSURE_INTERVAL);
+
+    EXPECT_FALSE(matrix_pkb.get_iparent().is_interval());
+    EXPECT_TRUE(interval_pkb.get_iparent().is_interval());
+    EXPECT_TRUE(interval_pkb.get_ifollows().is_interval());
+
+    StatementAst *statements[] = { stat1, stat2, stat3, stat4, stat5, stat6, stat7 };
+
+    ConditionSet descendants;
+    descendants.insert(new SimpleStatementCondition(stat2));
+    descendants.insert(new SimpleStatementCondition(stat3));
+    descendants.insert(new SimpleStatementCondition(stat4));
+
+    ConditionSet ancestors;
+    ancestors.insert(new SimpleStatementCondition(stat1));
+    ancestors.insert(new SimpleStatementCondition(stat2));
+
+    ConditionSet followers;
+    followers.insert(new SimpleStatementCondition(stat5));
+    followers.insert(new SimpleStatementCondition(stat6));
+
+    ConditionSet preceders;
+    preceders.insert(new SimpleStatementCondition(stat1));
+    preceders.insert(new SimpleStatementCondition(stat5));
+
+    SimplePkb *pkbs[] = { &matrix_pkb, &interval_pkb };
+    for(int k = 0; k < 2; ++k) {
+        SimplePkb& pkb = *pkbs[k];
+        int id1 = pkb.get_statement_id(stat1);
+
+        EXPECT_EQ(pkb.get_iparent().solve_right(id1), descendants);
+        EXPECT_EQ(pkb.get_iparent().solve_left(pkb.get_statement_id(stat3)), ancestors);
+        EXPECT_EQ(pkb.get_ifollows().solve_right(id1), followers);
+        EXPECT_EQ(pkb.get_ifollows().solve_left(pkb.get_statement_id(stat6)),
+                preceders);
+
+        EXPECT_TRUE(pkb.get_iparent().has_right(id1));
+        EXPECT_FALSE(pkb.get_iparent().has_left(id1));
+        EXPECT_FALSE(pkb.get_ifollows().has_right(pkb.get_statement_id(stat6)));
+        EXPECT_TRUE(pkb.get_ifollows().has_left(pkb.get_statement_id(stat4)));
+
+        for(int i = 0; i < 7; ++i) {
+            for(int j = 0; j < 7; ++j) {
+                int left = pkb.get_statement_id(statements[i]);
+                int right = pkb.get_statement_id(statements[j]);
+
+                EXPECT_EQ(pkb.get_iparent().validate(left, right), 
+                        pkb.get_parent().validate(left, right) || 
+                        (i == 0 && j == 2));
+                EXPECT_EQ(pkb.get_ifollows().validate(left, right), 
+                        pkb.get_follows().validate(left, right) || 
+                        (i == 0 && j == 5));
+            }
+        }
+    }
+
+    /*
+     * Recursive calls form a cycle, so each procedure calls itself
+     * transitively.
+     */
+    int proc_id1 = matrix_pkb.get_proc_id(proc1);
+    int proc_id2 = matrix_pkb.get_proc_id(proc2);
+    EXPECT_TRUE(matrix_pkb.get_icalls().validate(proc_id1, proc_id1));
+    EXPECT_TRUE(matrix_pkb.get_icalls().validate(proc_id1, proc_id2));
+    EXPECT_TRUE(matrix_pkb.get_icalls().validate(proc_id2, proc_id1));
+    EXPECT_TRUE(matrix_pkb.get_icalls().validate(proc_id2, proc_id2));
+}
+
+TEST(PkbTest, RecursiveSummaryTest) {
+    /*
+     * a and b call each other, so both modify and use everything
+     * either of them does.
+     */
+    std::string source =
+        "proc a { \n"
+        "   x = 1; \n"
+        "   call b; } \n"
+        "proc b { \n"
+        "   if c { \n"
+        "       call a; } \n"
+        "   else { \n"
+        "       y = z; } } \n"
+        "proc d { \n"
+        "   call b; \n"
+        "   w = 2; } \n";
+
+    SimpleParser parser(new BufferTokenizer(
+                source.data(), source.data() + source.size()));
+    SimpleRoot root = parser.parse_program();
+    LineTable lines = parser.get_line_table();
+
+    ConditionTablePtr table(new SimpleConditionTable(root));
+    SimplePkb pkb(root, table);
+
+    SimpleVariable var_c("c"), var_w("w"), var_x("x"), var_y("y"), var_z("z");
+    int x = pkb.get_variable_id(&var_x);
+    int y = pkb.get_variable_id(&var_y);
+    int c = pkb.get_variable_id(&var_c);
+    int z = pkb.get_variable_id(&var_z);
+    int w = pkb.get_variable_id(&var_w);
+
+    const char *names[] = { "a", "b", "d" };
+    for(int i = 0; i < 3; ++i) {
+        int proc = pkb.get_proc_id(root.get_proc(names[i]));
+        EXPECT_TRUE(pkb.get_modifies().validate(proc, x));
+        EXPECT_TRUE(pkb.get_modifies().validate(proc, y));
+        EXPECT_TRUE(pkb.get_uses().validate(proc, c));
+        EXPECT_TRUE(pkb.get_uses().validate(proc, z));
+    }
+
+    int a = pkb.get_proc_id(root.get_proc("a"));
+    EXPECT_FALSE(pkb.get_modifies().validate(a, w));
+    EXPECT_TRUE(pkb.get_calls().validate(a, pkb.get_proc_id(root.get_proc("b"))));
+
+    // the call statements and the if statement, the else line counts
+    int lines_with_x[] = { 2, 3, 4, 7 };
+    for(int i = 0; i < 4; ++i) {
+        int statement = pkb.get_statement_id(lines[lines_with_x[i]]);
+        EXPECT_TRUE(pkb.get_modifies().validate(statement, x));
+        EXPECT_TRUE(pkb.get_modifies().validate(statement, y));
+        EXPECT_TRUE(pkb.get_uses().validate(statement, z));
+    }
+
+    EXPECT_FALSE(pkb.get_modifies().validate(
+                pkb.get_statement_id(lines[6]), x));
+}
+
+}
+}
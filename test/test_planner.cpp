@@ -0,0 +1,123 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "simple/solver.h"
+#include "simple/query.h"
+#include "test/mock.h"
+#include "impl/condition.h"
+#include "impl/query.h"
+#include "impl/planner.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+TEST(QueryPlannerTest, OrderingTest) {
+    std::shared_ptr<QuerySolver> small_solver(new MockSolver());
+    std::shared_ptr<QuerySolver> large_solver(new MockSolver());
+
+    RelationStatistics statistics;
+    statistics[small_solver.get()] = 10;
+    statistics[large_solver.get()] = 10000;
+
+    ConditionPtr cond_x(new SimpleVariableCondition(SimpleVariable("x")));
+
+    /*
+     * large(a, b), large(b, c), small(c, d), large(e, _), small(x, _)
+     */
+    ClausePtr clause1(new SimplePqlClause(large_solver,
+                new SimplePqlVariableTerm("a"),
+                new SimplePqlVariableTerm("b")));
+    ClausePtr clause2(new SimplePqlClause(large_solver,
+                new SimplePqlVariableTerm("b"),
+                new SimplePqlVariableTerm("c")));
+    ClausePtr clause3(new SimplePqlClause(small_solver,
+                new SimplePqlVariableTerm("c"),
+                new SimplePqlVariableTerm("d")));
+    ClausePtr clause4(new SimplePqlClause(large_solver,
+                new SimplePqlVariableTerm("e"),
+                new SimplePqlWildcardTerm()));
+    ClausePtr clause5(new SimplePqlClause(small_solver,
+                new SimplePqlConditionTerm(cond_x),
+                new SimplePqlWildcardTerm()));
+
+    ClauseSet clauses;
+    clauses.insert(clause1);
+    clauses.insert(clause2);
+    clauses.insert(clause3);
+    clauses.insert(clause4);
+    clauses.insert(clause5);
+
+    SimpleQueryPlanner planner(statistics);
+    QueryPlan plan = planner.plan(clauses);
+
+    ASSERT_EQ(plan.size(), (size_t) 3);
+
+    /*
+     * Clauses without query variables run first.
+     */
+    ASSERT_EQ(plan[0].clauses.size(), (size_t) 1);
+    EXPECT_EQ(plan[0].clauses[0].get(), clause5.get());
+    EXPECT_TRUE(plan[0].qvars.empty());
+
+    /*
+     * The small relation runs first, followed by the clauses connected
+     * to the query variables it narrowed down.
+     */
+    ASSERT_EQ(plan[1].clauses.size(), (size_t) 3);
+    EXPECT_EQ(plan[1].clauses[0].get(), clause3.get());
+    EXPECT_EQ(plan[1].clauses[1].get(), clause2.get());
+    EXPECT_EQ(plan[1].clauses[2].get(), clause1.get());
+    EXPECT_EQ(plan[1].qvars.size(), (size_t) 4);
+
+    ASSERT_EQ(plan[2].clauses.size(), (size_t) 1);
+    EXPECT_EQ(plan[2].clauses[0].get(), clause4.get());
+    EXPECT_EQ(plan[2].qvars.count("e"), (size_t) 1);
+}
+
+TEST(QueryPlannerTest, CostTest) {
+    std::shared_ptr<QuerySolver> solver(new MockSolver());
+
+    RelationStatistics statistics;
+    statistics[solver.get()] = 100;
+    SimpleQueryPlanner planner(statistics);
+
+    ConditionPtr cond_x(new SimpleVariableCondition(SimpleVariable("x")));
+
+    SimplePqlClause bound_clause(solver,
+            new SimplePqlConditionTerm(cond_x),
+            new SimplePqlVariableTerm("s"));
+    SimplePqlClause free_clause(solver,
+            new SimplePqlVariableTerm("s"),
+            new SimplePqlVariableTerm("t"));
+
+    std::set<std::string> none;
+    std::set<std::string> bound_s;
+    bound_s.insert("s");
+
+    EXPECT_LT(planner.estimate_cost(&bound_clause, none),
+            planner.estimate_cost(&free_clause, none));
+    EXPECT_LT(planner.estimate_cost(&free_clause, bound_s),
+            planner.estimate_cost(&free_clause, none));
+}
+
+}
+}
@@ -48,6 +48,7 @@ TEST(PqlParserTest, ComponentTest) {
     proc->set_first_statement(assign);
 
     SimpleRoot ast(proc);
+    PkbPtr pkb(new SimplePkb(ast, ConditionTablePtr(new SimpleConditionTable(ast))));
 
     LineTable line_table;
     line_table[1] = assign;
@@ -77,7 +78,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer1->insert(new SemiColonToken());
     tokenizer1->insert(new EOFToken());
 
-    SimplePqlParser parser1(tokenizer1, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser1(tokenizer1, ast, line_table, solver_table, pred_table,
+            pkb);
     
     parser1.parse_predicate();
 
@@ -93,7 +95,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer2->insert(new SemiColonToken());
     tokenizer2->insert(new EOFToken());
 
-    SimplePqlParser parser2(tokenizer2, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser2(tokenizer2, ast, line_table, solver_table, pred_table,
+            pkb);
 
     parser2.parse_predicate();
     EXPECT_EQ(parser2.get_query_set().predicates["x"], variable_pred);
@@ -112,7 +115,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer3->insert(new CloseBracketToken());
     tokenizer3->insert(new EOFToken());
 
-    SimplePqlParser parser3(tokenizer3, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser3(tokenizer3, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlClause> clause1 = parser3.parse_clause();
 
@@ -136,7 +140,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer4->insert(new CloseBracketToken());
     tokenizer4->insert(new EOFToken());
 
-    SimplePqlParser parser4(tokenizer4, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser4(tokenizer4, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlClause> clause2 = parser4.parse_clause();
     SimplePqlClause expected_clause2(follows_solver,
@@ -160,7 +165,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer5->insert(new CloseBracketToken());
     tokenizer5->insert(new EOFToken());
 
-    SimplePqlParser parser5(tokenizer5, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser5(tokenizer5, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlClause> clause3 = parser5.parse_clause();
     SimplePqlClause expected_clause3(imodifies_solver,
@@ -184,7 +190,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer6->insert(new CloseBracketToken());
     tokenizer6->insert(new EOFToken());
 
-    SimplePqlParser parser6(tokenizer6, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser6(tokenizer6, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlClause> clause4 = parser6.parse_clause();
     SimplePqlClause expected_clause4(ifollows_solver, 
@@ -202,7 +209,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer7->insert(new IdentifierToken("my_qvar"));
     tokenizer7->insert(new EOFToken());
     
-    SimplePqlParser parser7(tokenizer7, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser7(tokenizer7, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlSelector> selector1 = parser7.parse_selector();
     EXPECT_TRUE(is_selector<PqlSingleVarSelector>(selector1.get()));
@@ -221,7 +229,8 @@ TEST(PqlParserTest, ComponentTest) {
     tokenizer8->insert(new IdentifierToken("BOOLEAN"));
     tokenizer8->insert(new EOFToken());
     
-    SimplePqlParser parser8(tokenizer8, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser8(tokenizer8, ast, line_table, solver_table, pred_table,
+            pkb);
 
     std::shared_ptr<PqlSelector> selector2 = parser8.parse_selector();
     
@@ -246,6 +255,7 @@ TEST(PqlParserTest, FullQueryTest) {
     proc->set_first_statement(assign);
 
     SimpleRoot ast(proc);
+    PkbPtr pkb(new SimplePkb(ast, ConditionTablePtr(new SimpleConditionTable(ast))));
 
     LineTable line_table;
     line_table[1] = assign;
@@ -290,7 +300,8 @@ TEST(PqlParserTest, FullQueryTest) {
     tokenizer1->insert(new SemiColonToken());
     tokenizer1->insert(new EOFToken());
 
-    SimplePqlParser parser1(tokenizer1, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser1(tokenizer1, ast, line_table, solver_table, pred_table,
+            pkb);
 
     PqlQuerySet result1 = parser1.parse_query();
 
@@ -344,7 +355,8 @@ TEST(PqlParserTest, FullQueryTest) {
     tokenizer2->insert(new SemiColonToken());
     tokenizer2->insert(new EOFToken());
 
-    SimplePqlParser parser2(tokenizer2, ast, line_table, solver_table, pred_table);
+    SimplePqlParser parser2(tokenizer2, ast, line_table, solver_table, pred_table,
+            pkb);
 
     PqlQuerySet result2 = parser2.parse_query();
 
@@ -23,9 +23,17 @@
 #include "simple/util/solver_generator.h"
 #include "impl/ast.h"
 #include "impl/linker.h"
+#include "impl/result_table.h"
 #include "impl/parser/pql_parser.h"
 #include "impl/solvers/follows.h"
+#include "impl/solvers/ifollows.h"
 #include "impl/solvers/modifies.h"
+#include "impl/solvers/uses.h"
+#include "impl/solvers/call.h"
+#include "impl/solvers/next.h"
+#include "impl/solvers/inext.h"
+#include "impl/parser/parser.h"
+#include "impl/parser/buffer_tokenizer.h"
 #include "impl/predicate.h"
 #include "impl/processor.h"
 
@@ -35,6 +43,7 @@ namespace test {
 using namespace simple;
 using namespace simple::impl;
 using namespace simple::util;
+using namespace simple::parser;
 
 TEST(QueryProcessorTest, IntegratedTest) {
     /*
@@ -122,6 +131,440 @@ TEST(QueryProcessorTest, IntegratedTest) {
 }
 
 
+/*
+ * Forwards to another solver but only allows validating pairs.
+ */
+class ValidateOnlySolver : public QuerySolver {
+  public:
+    ValidateOnlySolver(std::shared_ptr<QuerySolver> solver) : 
+        _solver(solver) 
+    { }
+
+    ConditionSet solve_left(SimpleCondition *right) {
+        return ConditionSet();
+    }
+
+    ConditionSet solve_right(SimpleCondition *left) {
+        return ConditionSet();
+    }
+
+    bool validate(SimpleCondition *left, SimpleCondition *right) {
+        return _solver->validate(left, right);
+    }
+
+    bool can_enumerate() {
+        return false;
+    }
+
+  private:
+    std::shared_ptr<QuerySolver> _solver;
+};
+
+TEST(QueryProcessorTest, JoinTest) {
+    /*
+     * proc test {
+     *   x = 1;
+     *   ...
+     *   x = 8;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> statements;
+
+    for(int i = 0; i < 8; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i + 1));
+        statement->set_line(i + 1);
+
+        if(statements.empty()) {
+            set_proc(statement, proc);
+        } else {
+            set_next(statements.back(), statement);
+        }
+        statements.push_back(statement);
+    }
+
+    SimpleRoot ast(proc);
+
+    std::shared_ptr<QuerySolver> ifollows_solver(
+            new SimpleSolverGenerator<IFollowSolver>(new IFollowSolver(ast)));
+    std::shared_ptr<QuerySolver> validate_solver(
+            new ValidateOnlySolver(ifollows_solver));
+
+    std::shared_ptr<SimplePredicate> wildcard_pred(new SimpleWildCardPredicate(ast));
+    std::shared_ptr<SimplePredicate> statement_pred(new SimpleStatementPredicate(ast));
+
+    PredicateTable pred_table;
+    pred_table["s1"] = statement_pred;
+    pred_table["s2"] = statement_pred;
+    pred_table["s3"] = statement_pred;
+
+    std::shared_ptr<QuerySolver> solvers[] = { ifollows_solver, validate_solver };
+
+    for(int k = 0; k < 2; ++k) {
+        std::shared_ptr<SimpleQueryLinker> linker(new SimpleQueryLinker());
+        QueryProcessor processor(linker, pred_table, wildcard_pred);
+
+        /*
+         * Follows*(s1, s2) enumerates the smaller left set, while
+         * Follows*(s3, s2) enumerates the smaller right set.
+         */
+        ConditionSet s1;
+        s1.insert(new SimpleStatementCondition(statements[5]));
+        s1.insert(new SimpleStatementCondition(statements[6]));
+        processor.set_qvar("s1", s1);
+
+        ClausePtr clause1(new SimplePqlClause(solvers[k],
+                    new SimplePqlVariableTerm("s1"),
+                    new SimplePqlVariableTerm("s2")));
+        processor.solve_clause(clause1.get());
+
+        ClausePtr clause2(new SimplePqlClause(solvers[k],
+                    new SimplePqlVariableTerm("s3"),
+                    new SimplePqlVariableTerm("s2")));
+        processor.solve_clause(clause2.get());
+
+        ConditionSet expected_s2;
+        expected_s2.insert(new SimpleStatementCondition(statements[6]));
+        expected_s2.insert(new SimpleStatementCondition(statements[7]));
+
+        ConditionSet expected_s3;
+        for(int i = 0; i < 7; ++i) {
+            expected_s3.insert(new SimpleStatementCondition(statements[i]));
+        }
+
+        EXPECT_TRUE(linker->is_valid_state());
+        EXPECT_EQ(linker->get_conditions("s1"), s1);
+        EXPECT_EQ(linker->get_conditions("s2"), expected_s2);
+        EXPECT_EQ(linker->get_conditions("s3"), expected_s3);
+        EXPECT_EQ(linker->get_linked_conditions("s1", "s2", 
+                    new SimpleStatementCondition(statements[6])), 
+                ConditionSet(new SimpleStatementCondition(statements[7])));
+    }
+}
+
+/*
+ * Forwards to another solver and counts the calls it gets.
+ */
+class CountingSolver : public QuerySolver {
+  public:
+    CountingSolver(std::shared_ptr<QuerySolver> solver) : 
+        validated(0), solved(0), _solver(solver)
+    { }
+
+    ConditionSet solve_left(SimpleCondition *right) {
+        ++solved;
+        return _solver->solve_left(right);
+    }
+
+    ConditionSet solve_right(SimpleCondition *left) {
+        ++solved;
+        return _solver->solve_right(left);
+    }
+
+    bool validate(SimpleCondition *left, SimpleCondition *right) {
+        ++validated;
+        return _solver->validate(left, right);
+    }
+
+    const ConditionSet* get_domain() {
+        return _solver->get_domain();
+    }
+
+    const ConditionSet* get_range() {
+        return _solver->get_range();
+    }
+
+    int validated;
+    int solved;
+
+  private:
+    std::shared_ptr<QuerySolver> _solver;
+};
+
+/*
+ * A clause on two query variables that an earlier clause joined
+ * only validates the pairs the linker holds.
+ */
+TEST(QueryProcessorTest, JoinedFilterTest) {
+    /*
+     * proc test {
+     *   x = 1;
+     *   ...
+     *   x = 8;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> statements;
+
+    for(int i = 0; i < 8; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i + 1));
+        statement->set_line(i + 1);
+
+        if(statements.empty()) {
+            set_proc(statement, proc);
+        } else {
+            set_next(statements.back(), statement);
+        }
+        statements.push_back(statement);
+    }
+
+    SimpleRoot ast(proc);
+
+    std::shared_ptr<QuerySolver> ifollows_solver(
+            new SimpleSolverGenerator<IFollowSolver>(new IFollowSolver(ast)));
+    std::shared_ptr<QuerySolver> follows_solver(
+            new SimpleSolverGenerator<FollowSolver>(new FollowSolver(ast)));
+
+    std::shared_ptr<SimplePredicate> wildcard_pred(new SimpleWildCardPredicate(ast));
+    std::shared_ptr<SimplePredicate> statement_pred(new SimpleStatementPredicate(ast));
+
+    PredicateTable pred_table;
+    pred_table["s1"] = statement_pred;
+    pred_table["s2"] = statement_pred;
+
+    std::shared_ptr<QueryLinker> linkers[] = { 
+        std::shared_ptr<QueryLinker>(new SimpleQueryLinker()),
+        std::shared_ptr<QueryLinker>(new ColumnarQueryLinker())
+    };
+
+    for(int k = 0; k < 2; ++k) {
+        std::shared_ptr<QueryLinker> linker = linkers[k];
+        QueryProcessor processor(linker, pred_table, wildcard_pred);
+
+        ClausePtr clause1(new SimplePqlClause(ifollows_solver,
+                    new SimplePqlVariableTerm("s1"),
+                    new SimplePqlVariableTerm("s2")));
+        processor.solve_clause(clause1.get());
+
+        /*
+         * Follows*(s1, s2) holds for 28 pairs, each of which is
+         * validated once for Follows(s1, s2).
+         */
+        std::shared_ptr<CountingSolver> counting(new CountingSolver(follows_solver));
+        ClausePtr clause2(new SimplePqlClause(counting,
+                    new SimplePqlVariableTerm("s1"),
+                    new SimplePqlVariableTerm("s2")));
+        processor.solve_clause(clause2.get());
+
+        EXPECT_EQ(counting->validated, 28) << k;
+        EXPECT_EQ(counting->solved, 0);
+
+        ConditionSet expected_s1;
+        ConditionSet expected_s2;
+        for(int i = 0; i < 7; ++i) {
+            expected_s1.insert(new SimpleStatementCondition(statements[i]));
+            expected_s2.insert(new SimpleStatementCondition(statements[i + 1]));
+        }
+
+        EXPECT_TRUE(linker->is_valid_state());
+        EXPECT_EQ(linker->get_conditions("s1", statement_pred.get()), expected_s1);
+        EXPECT_EQ(linker->get_conditions("s2", statement_pred.get()), expected_s2);
+
+        std::vector<std::string> qvars;
+        qvars.push_back("s1");
+        qvars.push_back("s2");
+        EXPECT_EQ(linker->make_tuples(qvars).size(), (size_t) 7);
+    }
+}
+
+/*
+ * Solvers over a relation of the PKB answer a wildcard term from the
+ * domain or range of the relation, without solving any condition.
+ */
+TEST(QueryProcessorTest, WildcardDomainTest) {
+    std::string source =
+        "proc a { \n"
+        "   x = y; \n"
+        "   while i { \n"
+        "       z = 1; } \n"
+        "   v = x; } \n"
+        "proc b { \n"
+        "   w = 2; } \n";
+
+    SimpleParser parser(new BufferTokenizer(
+                source.data(), source.data() + source.size()));
+    SimpleRoot ast = parser.parse_program();
+    LineTable lines = parser.get_line_table();
+
+    ConditionTablePtr table(new SimpleConditionTable(ast));
+    PkbPtr pkb(new SimplePkb(ast, table));
+
+    std::shared_ptr<QuerySolver> uses_solver(
+            new SimpleSolverGenerator<UsesSolver>(
+                std::shared_ptr<UsesSolver>(new UsesSolver(ast, pkb)),
+                pkb->get_uses().get_domain(), pkb->get_uses().get_range()));
+    std::shared_ptr<QuerySolver> modifies_solver(
+            new SimpleSolverGenerator<ModifiesSolver>(
+                std::shared_ptr<ModifiesSolver>(new ModifiesSolver(ast, pkb)),
+                pkb->get_modifies().get_domain(), pkb->get_modifies().get_range()));
+    std::shared_ptr<QuerySolver> call_solver(
+            new SimpleSolverGenerator<CallSolver>(
+                std::shared_ptr<CallSolver>(new CallSolver(ast, pkb)),
+                pkb->get_calls().get_domain(), pkb->get_calls().get_range()));
+
+    const RelationTable& next = pkb->get_cfg().get_next();
+    std::shared_ptr<INextSolver> inext(new INextSolver(ast, 
+                std::shared_ptr<NextSolver>(new NextSolver(ast, pkb))));
+    std::shared_ptr<QuerySolver> inext_solver(
+            new SimpleSolverGenerator<INextSolver>(inext,
+                next.get_domain(), next.get_range()));
+
+    std::shared_ptr<SimplePredicate> wildcard_pred(
+            new SimpleWildCardPredicate(ast, table));
+
+    PredicateTable pred_table;
+    pred_table["v"] = PredicatePtr(new SimpleVariablePredicate(ast, table));
+    pred_table["p"] = PredicatePtr(new SimpleProcPredicate(ast, table));
+    pred_table["s"] = PredicatePtr(new SimpleStatementPredicate(ast, table));
+
+    std::shared_ptr<SimpleQueryLinker> linker(new SimpleQueryLinker());
+    QueryProcessor processor(linker, pred_table, wildcard_pred);
+
+    std::shared_ptr<CountingSolver> counting_uses(new CountingSolver(uses_solver));
+    std::shared_ptr<CountingSolver> counting_modifies(new CountingSolver(modifies_solver));
+    std::shared_ptr<CountingSolver> counting_inext(new CountingSolver(inext_solver));
+
+    // Uses(_, v)
+    ClausePtr clause1(new SimplePqlClause(counting_uses,
+                new SimplePqlWildcardTerm(),
+                new SimplePqlVariableTerm("v")));
+    processor.solve_clause(clause1.get());
+
+    // Modifies(p, _)
+    ClausePtr clause2(new SimplePqlClause(counting_modifies,
+                new SimplePqlVariableTerm("p"),
+                new SimplePqlWildcardTerm()));
+    processor.solve_clause(clause2.get());
+
+    // Next*(_, s)
+    ClausePtr clause3(new SimplePqlClause(counting_inext,
+                new SimplePqlWildcardTerm(),
+                new SimplePqlVariableTerm("s")));
+    processor.solve_clause(clause3.get());
+
+    SimpleVariable var_x("x"), var_y("y"), var_i("i");
+    ConditionSet expected_v;
+    expected_v.insert(table->get_variable_condition(&var_x));
+    expected_v.insert(table->get_variable_condition(&var_y));
+    expected_v.insert(table->get_variable_condition(&var_i));
+
+    ConditionSet expected_p;
+    expected_p.insert(table->get_proc_condition(ast.get_proc("a")));
+    expected_p.insert(table->get_proc_condition(ast.get_proc("b")));
+
+    ConditionSet expected_s;
+    for(int line = 2; line <= 4; ++line) {
+        expected_s.insert(table->get_statement_condition(lines[line]));
+    }
+
+    EXPECT_TRUE(linker->is_valid_state());
+    EXPECT_EQ(linker->get_conditions("v"), expected_v);
+    EXPECT_EQ(linker->get_conditions("p"), expected_p);
+    EXPECT_EQ(linker->get_conditions("s"), expected_s);
+
+    CountingSolver *counters[] = { 
+        counting_uses.get(), counting_modifies.get(), counting_inext.get() 
+    };
+    for(int k = 0; k < 3; ++k) {
+        EXPECT_EQ(counters[k]->solved, 0) << k;
+        EXPECT_EQ(counters[k]->validated, 0) << k;
+    }
+
+    // Uses(_, _) holds, and the program has no call for Calls(_, _)
+    ClausePtr clause4(new SimplePqlClause(uses_solver,
+                new SimplePqlWildcardTerm(),
+                new SimplePqlWildcardTerm()));
+    processor.solve_clause(clause4.get());
+    EXPECT_TRUE(linker->is_valid_state());
+
+    ClausePtr clause5(new SimplePqlClause(call_solver,
+                new SimplePqlWildcardTerm(),
+                new SimplePqlWildcardTerm()));
+    processor.solve_clause(clause5.get());
+    EXPECT_FALSE(linker->is_valid_state());
+}
+
+TEST(QueryProcessorTest, SolutionTest) {
+    /*
+     * proc test {
+     *   x = 1;
+     *   x = 2;
+     *   x = 3;
+     * }
+     */
+    SimpleProcAst *proc = new SimpleProcAst("test");
+    std::vector<SimpleAssignmentAst*> statements;
+
+    for(int i = 0; i < 3; ++i) {
+        SimpleAssignmentAst *statement = new SimpleAssignmentAst();
+        statement->set_variable(SimpleVariable("x"));
+        statement->set_expr(new SimpleConstAst(i + 1));
+        statement->set_line(i + 1);
+
+        if(statements.empty()) {
+            set_proc(statement, proc);
+        } else {
+            set_next(statements.back(), statement);
+        }
+        statements.push_back(statement);
+    }
+
+    SimpleRoot ast(proc);
+
+    std::shared_ptr<QuerySolver> follows_solver(
+            new SimpleSolverGenerator<FollowSolver>(new FollowSolver(ast)));
+
+    std::shared_ptr<SimplePredicate> wildcard_pred(new SimpleWildCardPredicate(ast));
+    std::shared_ptr<SimplePredicate> statement_pred(new SimpleStatementPredicate(ast));
+
+    PredicateTable pred_table;
+    pred_table["s1"] = statement_pred;
+    pred_table["s2"] = statement_pred;
+    pred_table["s3"] = statement_pred;
+
+    std::shared_ptr<SimpleQueryLinker> linker(new SimpleQueryLinker());
+    QueryProcessor processor(linker, pred_table, wildcard_pred);
+
+    /*
+     * Follows(s1, s2) and Follows(s2, s3) only hold for 1, 2, 3
+     */
+    std::vector<ClausePtr> clauses;
+    clauses.push_back(ClausePtr(new SimplePqlClause(follows_solver,
+                new SimplePqlVariableTerm("s1"),
+                new SimplePqlVariableTerm("s2"))));
+    clauses.push_back(ClausePtr(new SimplePqlClause(follows_solver,
+                new SimplePqlVariableTerm("s2"),
+                new SimplePqlVariableTerm("s3"))));
+
+    EXPECT_TRUE(processor.has_solution(clauses));
+
+    /*
+     * Follows(s3, _) cannot hold once s3 has to be the last statement
+     */
+    clauses.push_back(ClausePtr(new SimplePqlClause(follows_solver,
+                new SimplePqlVariableTerm("s3"),
+                new SimplePqlWildcardTerm())));
+
+    EXPECT_FALSE(processor.has_solution(clauses));
+
+    std::vector<ClausePtr> constant_clauses;
+    constant_clauses.push_back(ClausePtr(new SimplePqlClause(follows_solver,
+                new SimplePqlConditionTerm(ConditionPtr(
+                    new SimpleStatementCondition(statements[1]))),
+                new SimplePqlVariableTerm("s1"))));
+
+    EXPECT_TRUE(processor.has_solution(constant_clauses));
+
+    /*
+     * The search does not touch the linker.
+     */
+    EXPECT_TRUE(linker->is_valid_state());
+    EXPECT_FALSE(linker->is_initialized("s1"));
+}
 
 }
 }
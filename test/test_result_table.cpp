@@ -0,0 +1,267 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "impl/ast.h"
+#include "impl/condition.h"
+#include "impl/result_table.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+ConditionTuplePtr make_tuples(ConditionPtr condition1, ConditionPtr condition2);
+
+ConditionTuplePtr make_tuples(ConditionPtr condition1, 
+        ConditionPtr condition2, ConditionPtr condition3);
+
+std::vector<std::string> make_string_list(std::string str1, std::string str2);
+
+std::vector<std::string> make_string_list(
+        std::string str1, std::string str2, std::string str3);
+
+TEST(ResultTableTest, OperatorTest) {
+    ResultTable::Column xs;
+    xs.push_back(1);
+    xs.push_back(2);
+    xs.push_back(3);
+
+    ResultTable::Column ys;
+    ys.push_back(4);
+    ys.push_back(5);
+
+    ResultTable x("x", xs);
+    ResultTable y("y", ys);
+
+    ResultTable::LinkMap links;
+    links[1].push_back(4);
+    links[1].push_back(5);
+    links[3].push_back(5);
+    links[3].push_back(6);
+
+    ResultTable xy = ResultTable::hash_join(x, 0, y, 0, links);
+    EXPECT_EQ(xy.get_row_count(), 3u);
+    EXPECT_EQ(xy.find_column("x"), 0);
+    EXPECT_EQ(xy.find_column("y"), 1);
+    EXPECT_EQ(xy.find_column("z"), -1);
+
+    ResultTable::ValueSet values;
+    values.insert(5);
+    xy.semi_join(1, values);
+    EXPECT_EQ(xy.get_row_count(), 2u);
+
+    ResultTable::PairSet pairs;
+    pairs.insert(ResultTable::make_pair_key(3, 5));
+    pairs.insert(ResultTable::make_pair_key(2, 5));
+    xy.semi_join(0, 1, pairs);
+    ASSERT_EQ(xy.get_row_count(), 1u);
+    EXPECT_EQ(xy.get_column(0)[0], 3);
+    EXPECT_EQ(xy.get_column(1)[0], 5);
+
+    ResultTable both = ResultTable::hash_join(x, 0, y, 0, links);
+    both.drop_column(0);
+    EXPECT_EQ(both.get_row_count(), 2u);
+
+    std::vector<size_t> columns(1, 1);
+    EXPECT_EQ(ResultTable::hash_join(x, 0, y, 0, links).project(columns)
+            .get_row_count(), 2u);
+}
+
+TEST(ResultTableTest, LinkerTest) {
+    SimpleAssignmentAst stat11(11);
+    SimpleAssignmentAst stat12(12);
+    SimpleAssignmentAst stat13(13);
+
+    SimpleAssignmentAst stat21(21);
+    SimpleAssignmentAst stat23(23);
+    SimpleAssignmentAst stat24(24);
+    SimpleAssignmentAst stat25(25);
+
+    ConditionPtr condition11(new SimpleStatementCondition(&stat11));
+    ConditionPtr condition12(new SimpleStatementCondition(&stat12));
+    ConditionPtr condition13(new SimpleStatementCondition(&stat13));
+
+    ConditionPtr condition21(new SimpleStatementCondition(&stat21));
+    ConditionPtr condition23(new SimpleStatementCondition(&stat23));
+    ConditionPtr condition24(new SimpleStatementCondition(&stat24));
+    ConditionPtr condition25(new SimpleStatementCondition(&stat25));
+
+    ColumnarQueryLinker linker;
+
+    ConditionSet x1;
+    x1.insert(condition11);
+    x1.insert(condition12);
+    x1.insert(condition13);
+
+    ConditionSet y1;
+    y1.insert(condition23);
+    y1.insert(condition24);
+    y1.insert(condition25);
+
+    linker.update_results("x", x1);
+    linker.update_results("y", y1);
+
+    EXPECT_EQ(linker.get_conditions("x"), x1);
+    EXPECT_EQ(linker.get_conditions("y"), y1);
+
+    /*
+     * Links with conditions outside of the query variables are ignored.
+     */
+    std::vector<ConditionPair> links;
+    links.push_back(ConditionPair(condition11, condition23));
+    links.push_back(ConditionPair(condition13, condition25));
+    links.push_back(ConditionPair(condition11, condition21));
+
+    linker.update_links("x", "y", links);
+
+    ConditionSet new_x1;
+    new_x1.insert(condition11);
+    new_x1.insert(condition13);
+
+    ConditionSet new_y1;
+    new_y1.insert(condition23);
+    new_y1.insert(condition25);
+
+    EXPECT_EQ(linker.get_conditions("x"), new_x1);
+    EXPECT_EQ(linker.get_conditions("y"), new_y1);
+
+    TupleList tuples_yx;
+    tuples_yx.insert(make_tuples(condition23, condition11));
+    tuples_yx.insert(make_tuples(condition25, condition13));
+    EXPECT_EQ(linker.make_tuples(make_string_list("y", "x")), tuples_yx);
+
+    /*
+     * Removing 25 from y removes the rows linking it to 13 in x.
+     */
+    ConditionSet y2;
+    y2.insert(condition21);
+    y2.insert(condition23);
+    linker.update_results("y", y2);
+
+    ConditionSet new_x2;
+    new_x2.insert(condition11);
+    EXPECT_EQ(linker.get_conditions("x"), new_x2);
+
+    /*
+     * Unlinked variables are combined as a cross product.
+     */
+    ConditionSet z;
+    z.insert(condition12);
+    z.insert(condition24);
+    linker.update_results("z", z);
+
+    TupleList tuples_xzx;
+    tuples_xzx.insert(make_tuples(condition11, condition12, condition11));
+    tuples_xzx.insert(make_tuples(condition11, condition24, condition11));
+    EXPECT_EQ(linker.make_tuples(make_string_list("x", "z", "x")), tuples_xzx);
+
+    linker.drop_qvar("y");
+    EXPECT_FALSE(linker.is_initialized("y"));
+    EXPECT_EQ(linker.get_conditions("x"), new_x2);
+    EXPECT_TRUE(linker.is_valid_state());
+
+    ConditionSet empty;
+    linker.update_results("z", empty);
+    EXPECT_FALSE(linker.is_valid_state());
+}
+
+/*
+ * A cycle of links only keeps the rows that satisfy all of them at
+ * once. Each pair of variables alone has a partner for every
+ * condition, but no assignment of x, y and z closes the cycle.
+ */
+TEST(ResultTableTest, CycleTest) {
+    SimpleAssignmentAst stat1(1);
+    SimpleAssignmentAst stat2(2);
+
+    ConditionPtr condition1(new SimpleStatementCondition(&stat1));
+    ConditionPtr condition2(new SimpleStatementCondition(&stat2));
+
+    ConditionSet all;
+    all.insert(condition1);
+    all.insert(condition2);
+
+    std::vector<ConditionPair> different;
+    different.push_back(ConditionPair(condition1, condition2));
+    different.push_back(ConditionPair(condition2, condition1));
+
+    ColumnarQueryLinker linker;
+    linker.update_results("x", all);
+    linker.update_results("y", all);
+    linker.update_results("z", all);
+
+    linker.update_links("x", "y", different);
+    linker.update_links("y", "z", different);
+    EXPECT_TRUE(linker.is_valid_state());
+
+    linker.update_links("z", "x", different);
+    EXPECT_FALSE(linker.is_valid_state());
+}
+
+class TupleCounter : public TupleVisitor {
+  public:
+    TupleCounter() : count(0) { }
+
+    void visit_tuple(const std::vector<ConditionPtr>& row) {
+        EXPECT_EQ(row.size(), 2u);
+        ++count;
+    }
+
+    int count;
+};
+
+TEST(ResultTableTest, EnumerateTest) {
+    SimpleAssignmentAst stat1(1);
+    SimpleAssignmentAst stat2(2);
+    SimpleAssignmentAst stat3(3);
+
+    ConditionPtr condition1(new SimpleStatementCondition(&stat1));
+    ConditionPtr condition2(new SimpleStatementCondition(&stat2));
+    ConditionPtr condition3(new SimpleStatementCondition(&stat3));
+
+    ConditionSet all;
+    all.insert(condition1);
+    all.insert(condition2);
+    all.insert(condition3);
+
+    std::vector<ConditionPair> less;
+    less.push_back(ConditionPair(condition1, condition2));
+    less.push_back(ConditionPair(condition1, condition3));
+    less.push_back(ConditionPair(condition2, condition3));
+
+    ColumnarQueryLinker linker;
+    linker.update_results("x", all);
+    linker.update_results("y", all);
+    linker.update_results("z", all);
+    linker.update_links("x", "y", less);
+
+    TupleCounter linked;
+    linker.enumerate_tuples(make_string_list("x", "y"), &linked);
+    EXPECT_EQ(linked.count, 3);
+
+    TupleCounter unlinked;
+    linker.enumerate_tuples(make_string_list("x", "z"), &unlinked);
+    EXPECT_EQ(unlinked.count, 6);
+
+    EXPECT_EQ(linker.make_tuples(make_string_list("x", "z")).size(), 6u);
+}
+
+}
+}
@@ -0,0 +1,146 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "impl/frontend.h"
+#include "test/fixture.h"
+#include "impl/program_snapshot.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+namespace {
+
+const char *SNAPSHOT_SOURCE =
+    "proc first { \n"
+    "   x = 1; \n"
+    "   while i { \n"
+    "       y = x + 2 * z; \n"
+    "       if y { \n"
+    "           call second; } \n"
+    "       else { \n"
+    "           z = y - 1; } } \n"
+    "   call third; } \n"
+    "proc second { \n"
+    "   z = x * (y + 3); \n"
+    "   call third; } \n"
+    "proc third { \n"
+    "   w = z; } \n";
+
+const char *SNAPSHOT_QUERIES[] = {
+    "stmt s; Select s such that Follows*(1, s)",
+    "stmt s; Select s such that Parent*(2, s)",
+    "var v; Select v such that Uses(\"second\", v)",
+    "var v; Select v such that Modifies(\"first\", v)",
+    "var v; Select v such that Uses(4, v)",
+    "stmt s; Select s such that Next*(7, s)",
+    "assign a; while w; Select a such that Parent*(w, a)",
+    "stmt s; Select BOOLEAN such that Follows(s, 9)"
+};
+
+} // anonymous namespace
+
+TEST(SnapshotTest, RoundTripTest) {
+    std::string source(SNAPSHOT_SOURCE);
+    uint64_t checksum = snapshot_checksum(source.data(), source.size());
+    std::string path = "snapshot_round_trip.tmp";
+
+    SimplePqlFrontEnd parsed(source.begin(), source.end());
+    parsed.save_snapshot(path, checksum);
+
+    ProgramSnapshot snapshot(path, checksum);
+    SimplePqlFrontEnd loaded(snapshot);
+
+    for(size_t i = 0; i < sizeof(SNAPSHOT_QUERIES) / sizeof(char*); ++i) {
+        std::string expected = run_query(parsed, SNAPSHOT_QUERIES[i]);
+        EXPECT_EQ(run_query(loaded, SNAPSHOT_QUERIES[i]), expected);
+        EXPECT_EQ(expected.find("error"), std::string::npos);
+    }
+
+    remove(path.c_str());
+}
+
+TEST(SnapshotTest, RejectTest) {
+    std::string source(SNAPSHOT_SOURCE);
+    uint64_t checksum = snapshot_checksum(source.data(), source.size());
+    std::string path = "snapshot_reject.tmp";
+
+    EXPECT_THROW(ProgramSnapshot(path, checksum), SnapshotError);
+
+    SimplePqlFrontEnd parsed(source.begin(), source.end());
+    parsed.save_snapshot(path, checksum);
+
+    // stale source
+    EXPECT_THROW(ProgramSnapshot(path, checksum + 1), SnapshotError);
+
+    std::string data;
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+    }
+
+    // truncated file
+    {
+        std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size() - 8);
+    }
+    EXPECT_THROW(ProgramSnapshot(path, checksum), SnapshotError);
+
+    // corrupted payload
+    data[data.size() / 2] ^= 0x5a;
+    {
+        std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+    }
+    EXPECT_THROW(ProgramSnapshot(path, checksum), SnapshotError);
+
+    remove(path.c_str());
+}
+
+TEST(SnapshotTest, ReaderTest) {
+    SnapshotWriter writer;
+    writer.write_u8(7);
+    writer.write_int(-42);
+    writer.write_string("abc");
+
+    std::vector<int> values;
+    values.push_back(1);
+    values.push_back(2);
+    writer.write_array(values);
+
+    const std::string& data = writer.get_data();
+    SnapshotReader reader(data.data(), data.size());
+    EXPECT_EQ(reader.read_u8(), 7);
+    EXPECT_EQ(reader.read_int(), -42);
+    EXPECT_EQ(reader.read_string(), "abc");
+
+    std::vector<int> result;
+    reader.read_array(result);
+    EXPECT_EQ(result, values);
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_THROW(reader.read_int(), SnapshotError);
+}
+
+} // namespace test
+} // namespace simple
@@ -23,6 +23,7 @@
 #include "impl/solvers/modifies.h"
 #include "impl/solvers/next.h"
 #include "simple/util/solver_generator.h"
+#include "simple/util/ast_utils.h"
 
 namespace simple {
 namespace test {
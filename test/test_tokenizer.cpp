@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "impl/parser/iterator_tokenizer.h"
+#include "impl/parser/buffer_tokenizer.h"
 
 namespace simple {
 namespace test {
@@ -61,5 +62,57 @@ TEST(TokenizerTest, ComplexTokenTest) {
     tokenizer.next_token_as<EOFToken>();
 }
 
+TEST(TokenizerTest, BufferTokenTest) {
+    std::string source = 
+        "{ } ( ) \n \r\n ; = + - * , _ \"literal value\"\r"
+        "a_very_long_identifier_name_1234                    x"
+        "1234567890 0 b2(c)";
+    BufferTokenizer tokenizer(source.data(), source.data() + source.size());
+
+    tokenizer.next_token_as<OpenBraceToken>();
+    tokenizer.next_token_as<CloseBraceToken>();
+    tokenizer.next_token_as<OpenBracketToken>();
+    tokenizer.next_token_as<CloseBracketToken>();
+    tokenizer.next_token_as<NewLineToken>();
+    tokenizer.next_token_as<NewLineToken>();
+    tokenizer.next_token_as<SemiColonToken>();
+    tokenizer.next_token_as<EqualToken>();
+
+    EXPECT_EQ(tokenizer.next_token_as<OperatorToken>()->get_op(), '+');
+    EXPECT_EQ(tokenizer.next_token_as<OperatorToken>()->get_op(), '-');
+    EXPECT_EQ(tokenizer.next_token_as<OperatorToken>()->get_op(), '*');
+
+    tokenizer.next_token_as<CommaToken>();
+    tokenizer.next_token_as<WildCardToken>();
+    EXPECT_EQ(tokenizer.next_token_as<LiteralToken>()->get_content(), "literal value");
+    tokenizer.next_token_as<NewLineToken>();
+
+    EXPECT_EQ(tokenizer.next_token_as<IdentifierToken>()->get_content(), 
+            "a_very_long_identifier_name_1234");
+    EXPECT_EQ(tokenizer.next_token_as<IdentifierToken>()->get_content(), 
+            "x1234567890");
+    EXPECT_EQ(tokenizer.next_token_as<IntegerToken>()->get_value(), 0);
+    EXPECT_EQ(tokenizer.next_token_as<IdentifierToken>()->get_content(), "b2");
+    tokenizer.next_token_as<OpenBracketToken>();
+    EXPECT_EQ(tokenizer.next_token_as<IdentifierToken>()->get_content(), "c");
+    tokenizer.next_token_as<CloseBracketToken>();
+
+    tokenizer.next_token_as<EOFToken>();
+    tokenizer.next_token_as<EOFToken>();
+}
+
+TEST(TokenizerTest, BufferInvalidTokenTest) {
+    std::string source = "a # b";
+    BufferTokenizer tokenizer(source.data(), source.data() + source.size());
+
+    tokenizer.next_token_as<IdentifierToken>();
+    EXPECT_THROW(tokenizer.next_token(), InvalidTokenError);
+
+    std::string unterminated = "\"abc";
+    BufferTokenizer literal(unterminated.data(), 
+            unterminated.data() + unterminated.size());
+    EXPECT_THROW(literal.next_token(), InvalidTokenError);
+}
+
 }
 }
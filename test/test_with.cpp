@@ -0,0 +1,77 @@
+/*
+ * CS3201 Simple Static Analyzer
+ * Copyright (C) 2011 Soares Chen Ruo Fei
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iterator>
+#include "gtest/gtest.h"
+#include "impl/frontend.h"
+
+namespace simple {
+namespace test {
+
+using namespace simple;
+using namespace simple::impl;
+
+TEST(WithTest, QueryTest) {
+    std::string source = 
+        "proc test1 { \n"
+        "   a = 1; \n"
+        "   while i { \n"
+        "       call test2; \n"
+        "       if j { \n"
+        "           x = (x+y)*(3+z); } else { \n"
+        "           y = 2; } } \n"
+        "   b = 4; } \n"
+        "proc test2 { \n"
+        "   c = test2 + 3; } \n";
+
+    SimplePqlFrontEnd frontend(source.begin(), source.end());
+
+    const char *queries[][2] = {
+        { "procedure p; Select p with p.procName = \"test2\"", "p = test2" },
+        { "call c; Select c with c.procName = \"test2\"", "c = 3" },
+        { "call c; Select c with \"test1\" = c.procName", "c = " },
+        { "stmt s; Select s with s.stmt# = 5", "s = 5" },
+        { "prog_line n; Select n with n = 7", "n = 7" },
+        { "stmt s; constant c; Select s with s.stmt# = c.value", 
+            "s = 1, 2, 3, 4" },
+        { "variable v; procedure p; Select v with v.varName = p.procName", 
+            "v = \"test2\"" },
+        { "assign a; constant c; Select c such that Modifies(a, \"b\") "
+            "with a.stmt# = c.value", "c = " },
+        { "assign a; constant c; Select c such that Modifies(a, \"a\") "
+            "with a.stmt# = c.value and c.value = 1", "c = \"1\"" },
+        { "Select BOOLEAN with 3 = 3", "true" },
+        { "Select BOOLEAN with \"x\" = \"y\"", "false" }
+    };
+
+    for(size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i) {
+        std::string query(queries[i][0]);
+        std::string result;
+        frontend.process_query(query.begin(), query.end(), 
+                std::back_inserter(result));
+        EXPECT_EQ(result, queries[i][1]) << query;
+    }
+
+    std::string invalid("variable v; Select v with v.varName = 1");
+    std::string result;
+    EXPECT_EQ(frontend.process_query(invalid.begin(), invalid.end(),
+                std::back_inserter(result)), QUERY_ERROR);
+}
+
+} // namespace test
+} // namespace simple